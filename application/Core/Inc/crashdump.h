@@ -0,0 +1,76 @@
+/*
+ * crashdump.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_CRASHDUMP_H_
+#define INC_CRASHDUMP_H_
+
+#include "stm32f4xx_hal.h"
+#include "sections.h"
+
+/**
+ * Crash dumps that survive the reset. A fault handler or Error_Handler()
+ * stores the exception frame, the fault status registers and the top of
+ * the stack in .noinit RAM and resets at once. The next boot prints the
+ * dump on the console with crashdump_check() and clears it, so a field
+ * unit is back up in milliseconds with the evidence kept.
+ */
+/* Marks a valid dump, the checksum covers the rest. */
+#define CRASHDUMP_MAGIC        0xDEADC0DEu
+/* Words of the faulting stack kept, starting at the exception frame. */
+#define CRASHDUMP_STACK_WORDS  32u
+/* Stack the fault handlers switch to, the faulting one may be gone. */
+#define CRASHDUMP_STACK_SIZE   512u
+
+/* What ended the previous run. */
+typedef enum {
+  CRASHDUMP_HARDFAULT  = 0x01u,
+  CRASHDUMP_MEMMANAGE  = 0x02u,
+  CRASHDUMP_BUSFAULT   = 0x03u,
+  CRASHDUMP_USAGEFAULT = 0x04u,
+  CRASHDUMP_ERROR      = 0x05u  /**< Error_Handler(), pc is its caller. */
+} crashdump_reason;
+
+/* The dump, all registers as read in the handler. */
+typedef struct {
+  uint32_t magic;
+  uint32_t reason;
+  uint32_t crashes;     /**< Dumps since power-up, counts on across resets. */
+  uint32_t r0;
+  uint32_t r1;
+  uint32_t r2;
+  uint32_t r3;
+  uint32_t r12;
+  uint32_t lr;
+  uint32_t pc;
+  uint32_t xpsr;
+  uint32_t sp;          /**< Where the exception frame was pushed. */
+  uint32_t exc_return;
+  uint32_t cfsr;
+  uint32_t hfsr;
+  uint32_t mmfar;
+  uint32_t bfar;
+  uint32_t stack_words; /**< Valid words of stack[]. */
+  uint32_t stack[CRASHDUMP_STACK_WORDS];
+  uint32_t check;       /**< Complement of the sum of the words above. */
+} crashdump_record;
+
+/* Top of the fault handler stack, loaded by the naked handlers. */
+extern uint32_t *const crashdump_stack_top;
+
+/* enables the MemManage, BusFault and UsageFault handlers */
+void crashdump_init(void);
+
+/* prints and clears the dump of the previous run, its reason or 0 if there was none */
+uint32_t crashdump_check(void);
+
+/* stores a dump for an exception frame and resets */
+void crashdump_fault(const uint32_t *frame, uint32_t exc_return, crashdump_reason reason) __attribute__((noreturn));
+
+/* stores a dump for Error_Handler() and resets, pc is where it was called from */
+void crashdump_error(uint32_t pc) __attribute__((noreturn));
+
+#endif /* INC_CRASHDUMP_H_ */
@@ -0,0 +1,44 @@
+/*
+ * cycles.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_CYCLES_H_
+#define INC_CYCLES_H_
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * @brief   Starts the DWT cycle counter. Safe to call more than once.
+ * @param   void
+ * @return  void
+ */
+static inline void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief   Reads the free running core cycle counter.
+ * @param   void
+ * @return  Current CYCCNT value, wraps every 2^32 cycles.
+ */
+static inline uint32_t cycles_now(void)
+{
+  return DWT->CYCCNT;
+}
+
+/**
+ * @brief   Converts a cycle count to microseconds at the current core clock.
+ * @param   cycles: Number of core cycles.
+ * @return  Duration in microseconds.
+ */
+static inline uint32_t cycles_to_us(uint32_t cycles)
+{
+  return cycles / (SystemCoreClock / 1000000u);
+}
+
+#endif /* INC_CYCLES_H_ */
@@ -0,0 +1,66 @@
+/*
+ * epoch.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_EPOCH_H_
+#define INC_EPOCH_H_
+
+#include <stdint.h>
+
+/**
+ * Conversions between Unix time and the civil calendar, for time
+ * arithmetic without newlib mktime()/gmtime().
+ *
+ * Days are counted from 1970-01-01. The year start and month start tables
+ * are computed by the compiler, so converting a date is a few table reads,
+ * one multiply-free year estimate and two branch-free corrections. Only
+ * 32-bit arithmetic is used.
+ *
+ * epoch_t is unsigned, every value from 1970-01-01 00:00:00 to
+ * 2106-02-07 06:28:15 UTC is valid, which covers the DS1307 range.
+ * Dates are proleptic Gregorian: month 1 to 12, date 1 to 31, weekday 0
+ * (Sunday) to 6.
+ */
+
+/* Seconds since 1970-01-01 00:00:00 UTC. */
+typedef uint32_t epoch_t;
+
+#define EPOCH_BASE_YEAR      1970u
+#define EPOCH_SECS_PER_DAY   86400u
+
+/* Broken-down time, as produced by epoch_to_civil(). */
+typedef struct {
+  uint16_t year;
+  uint8_t month;
+  uint8_t date;
+  uint8_t hours;
+  uint8_t minutes;
+  uint8_t seconds;
+  uint8_t weekday;
+} epoch_civil;
+
+/* 1 if year is a leap year, 0 otherwise */
+uint8_t epoch_is_leap(uint16_t year);
+
+/* days from 1970-01-01 to a date, year 1970 to 2106 */
+uint32_t epoch_days_from_civil(uint16_t year, uint8_t month, uint8_t date);
+
+/* date of a day number */
+void epoch_civil_from_days(uint32_t days, uint16_t *year, uint8_t *month, uint8_t *date);
+
+/* weekday of a day number, 0 is Sunday */
+uint8_t epoch_weekday(uint32_t days);
+
+/* Unix time of a broken-down time, the weekday is ignored */
+epoch_t epoch_from_civil(const epoch_civil *civil);
+
+/* broken-down time of a Unix time, weekday included */
+void epoch_to_civil(epoch_t t, epoch_civil *civil);
+
+/* offset of a time zone in seconds, hour signed, minutes taken with the sign of hour */
+int32_t epoch_tz_offset(int8_t hour, uint8_t minute);
+
+#endif /* INC_EPOCH_H_ */
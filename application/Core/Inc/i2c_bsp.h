@@ -24,6 +24,16 @@
 /* Public defines ----------------------------------------------------- */
 #define I2C_SUCCESS		1
 #define I2C_ERROR		0
+#define I2C_PENDING		2
+
+/* Number of I2C peripherals the asynchronous engine can drive */
+#define BSP_I2C_MAX_BUSES	3
+/* Transfers shorter than this use interrupts instead of DMA */
+#define BSP_I2C_DMA_MIN		2
+/* Allowance on top of the wire time of a transfer: HAL tick granularity and clock stretching */
+#define BSP_I2C_TIMEOUT_SLACK_MS	2
+/* SCL pulses sent to free a slave holding SDA low, enough to finish any byte */
+#define BSP_I2C_RECOVERY_PULSES	9
 
 /* Public enumerate/structure ----------------------------------------- */
 /**
@@ -33,6 +43,52 @@ typedef struct{
 	uint8_t *data;
 	uint16_t length;
 }packet;
+
+/**
+ * @brief kind of asynchronous transaction
+ */
+typedef enum{
+	BSP_I2C_OP_WRITE,		/* tx only */
+	BSP_I2C_OP_READ,		/* rx only */
+	BSP_I2C_OP_WRITE_READ	/* tx, repeated start, rx */
+}bsp_i2c_op;
+
+typedef struct bsp_i2c_xfer bsp_i2c_xfer;
+
+/**
+ * @brief completion callback, runs in interrupt context
+ */
+typedef void (*bsp_i2c_callback)(bsp_i2c_xfer *xfer);
+
+/**
+ * @brief transaction descriptor, owned by the caller until it completes
+ */
+struct bsp_i2c_xfer{
+	uint16_t address;			/* HAL slave address, 7-bit address << 1 */
+	bsp_i2c_op op;
+	packet tx;
+	packet rx;
+	bsp_i2c_callback callback;	/* may be NULL */
+	void *context;				/* free for the caller */
+	volatile uint8_t status;	/* I2C_PENDING, then I2C_SUCCESS or I2C_ERROR */
+	uint8_t phase;				/* engine private */
+	uint32_t deadline;			/* engine private, HAL tick after which the bus is recovered */
+	bsp_i2c_xfer *next;			/* engine private */
+};
+
+/**
+ * @brief asynchronous engine state of one I2C peripheral
+ */
+typedef struct{
+	I2C_HandleTypeDef *hi2c;
+	bsp_i2c_xfer *head;			/* transaction on the bus */
+	bsp_i2c_xfer *tail;
+	GPIO_TypeDef *scl_port;		/* lines driven by bus recovery, NULL to only reinitialise */
+	uint16_t scl_pin;
+	GPIO_TypeDef *sda_port;
+	uint16_t sda_pin;
+	uint32_t recoveries;		/* transfers that timed out and were recovered */
+}bsp_i2c_bus;
 /* Public macros ------------------------------------------------------ */
 /* Public variables --------------------------------------------------- */
 
@@ -45,7 +101,7 @@ typedef struct{
  * @param[in]	  <data>  		<packet data to transmit>
  *
  */
-uint8_t bsp_i2c_transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, packet data);
+uint8_t bsp_i2c_transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, const packet *data);
 
 /**
  * @brief  <bsp receive via i2c>
@@ -55,7 +111,93 @@ uint8_t bsp_i2c_transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, packet da
  * @param[in]  	  <data> 		<packet data receive>
  *
  */
-uint8_t bsp_i2c_receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, packet data);
+uint8_t bsp_i2c_receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, const packet *data);
+
+/**
+ * @brief  <attach the asynchronous engine to an initialized I2C handle>
+ *
+ * @param[in]     <bus>  		<engine state, owned by the caller>
+ * @param[in]     <hi2c>  		<I2C_HandleTypeDef>
+ *
+ */
+uint8_t bsp_i2c_bus_init(bsp_i2c_bus *bus, I2C_HandleTypeDef *hi2c);
+
+/**
+ * @brief  <queue a transaction, returns at once>
+ *
+ * The transaction starts as soon as the ones queued before it are done, so
+ * the next one can be queued while the current one is still on the bus.
+ * Completion is signalled through xfer->status and xfer->callback.
+ *
+ * @param[in]     <bus>  		<engine the transaction goes to>
+ * @param[in]     <xfer>  		<transaction descriptor>
+ *
+ */
+uint8_t bsp_i2c_submit(bsp_i2c_bus *bus, bsp_i2c_xfer *xfer);
+
+/**
+ * @brief  <tell whether transactions are queued or running>
+ *
+ * @param[in]     <bus>  		<engine to check>
+ *
+ */
+uint8_t bsp_i2c_busy(const bsp_i2c_bus *bus);
+
+/**
+ * @brief  <block until a submitted transaction completes>
+ *
+ * @param[in]     <xfer>  		<transaction descriptor>
+ *
+ */
+uint8_t bsp_i2c_wait(const bsp_i2c_xfer *xfer);
+
+/**
+ * @brief  <give the GPIO lines of a bus, used to clock a stuck slave free>
+ *
+ * @param[in]     <bus>  		<engine of the bus>
+ * @param[in]     <scl_port>  	<SCL port>
+ * @param[in]     <scl_pin>  	<SCL pin>
+ * @param[in]     <sda_port>  	<SDA port>
+ * @param[in]     <sda_pin>  	<SDA pin>
+ *
+ */
+void bsp_i2c_set_recovery_pins(bsp_i2c_bus *bus, GPIO_TypeDef *scl_port, uint16_t scl_pin, GPIO_TypeDef *sda_port, uint16_t sda_pin);
+
+/**
+ * @brief  <time a transfer may take before it is treated as stuck>
+ *
+ * Wire time of the bytes, two address bytes and the START, repeated START
+ * and STOP conditions at the configured bus speed, plus
+ * BSP_I2C_TIMEOUT_SLACK_MS. A caller blocked on a transfer waits at most
+ * this plus one HAL tick and one recovery. A bus already held low when the
+ * transfer starts adds the HAL busy wait, I2C_TIMEOUT_BUSY_FLAG (25 ms).
+ *
+ * @param[in]     <hi2c>  		<I2C_HandleTypeDef>
+ * @param[in]     <length>  	<data bytes, both directions>
+ *
+ */
+uint32_t bsp_i2c_timeout_ms(const I2C_HandleTypeDef *hi2c, uint32_t length);
+
+/**
+ * @brief  <free the bus and restart the peripheral>
+ *
+ * Clocks BSP_I2C_RECOVERY_PULSES pulses on SCL, sends a STOP and
+ * reinitialises the peripheral, about 12 bit times plus the HAL init.
+ * Thread context, with no transfer running on the bus.
+ *
+ * @param[in]     <hi2c>  		<I2C_HandleTypeDef>
+ *
+ */
+void bsp_i2c_recover(I2C_HandleTypeDef *hi2c);
+
+/**
+ * @brief  <fail and recover transfers that overran their deadline>
+ *
+ * Called by the wait functions while they block, and from the main loop
+ * for transfers nobody waits on. Thread context.
+ *
+ */
+void bsp_i2c_poll(void);
 #endif /* INC_I2C_BSP_H_ */
 
 /* End of file -------------------------------------------------------- */
@@ -0,0 +1,127 @@
+/*
+ * i2c_bus.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_I2C_BUS_H_
+#define INC_I2C_BUS_H_
+
+#include "i2c_bsp.h"
+
+/**
+ * Bus manager on top of the i2c_bsp engine. It owns one I2C peripheral and
+ * arbitrates between the device drivers attached to it:
+ *
+ *  - requests are served by priority (0 is the most urgent), then by the
+ *    earliest deadline;
+ *  - when the device that just finished has more requests of the same
+ *    priority waiting, they go out back to back, up to I2C_BUS_BATCH_MAX in
+ *    a row, unless another request is due within I2C_BUS_URGENT_MS;
+ *  - submit-to-completion latency, errors and deadline misses are counted
+ *    per device.
+ *
+ * The engine holds the request on the bus plus the next one picked, so it
+ * goes straight on to that one from the completion interrupt. The order is
+ * decided one request ahead, not when the request is submitted.
+ */
+
+/* Priority used by the blocking helpers. */
+#define I2C_BUS_PRIO_DEFAULT  1u
+/* Requests to one device that may go out in a row while others wait. */
+#define I2C_BUS_BATCH_MAX     4u
+/* A request due within this many ms is never held back by batching. */
+#define I2C_BUS_URGENT_MS     2u
+/* Pass as deadline_ms for requests that have none. */
+#define I2C_BUS_NO_DEADLINE   0u
+
+/* Status report for the functions. */
+typedef enum {
+  I2C_BUS_OK           = 0x00u, /**< The action was successful. */
+  I2C_BUS_PENDING      = 0x01u, /**< The request is queued or on the bus. */
+  I2C_BUS_ERROR_XFER   = 0x02u, /**< The transfer failed on the bus (NACK, bus or DMA error). */
+  I2C_BUS_ERROR_PARAM  = 0x03u, /**< The request has no data or no device. */
+  I2C_BUS_ERROR        = 0xFFu  /**< Generic error. */
+} i2c_bus_status;
+
+typedef struct i2c_bus i2c_bus;
+typedef struct i2c_device i2c_device;
+typedef struct i2c_request i2c_request;
+
+/* Completion callback, runs in interrupt context. */
+typedef void (*i2c_request_callback)(i2c_request *req);
+
+/* Per-device statistics, latencies in core cycles. */
+typedef struct {
+  uint32_t transfers;
+  uint32_t errors;
+  uint32_t deadline_misses;
+  uint32_t max_latency_cycles;
+  uint64_t total_latency_cycles;
+} i2c_device_stats;
+
+/* One slave on a bus, owned by its driver. */
+struct i2c_device {
+  i2c_bus *bus;
+  const char *name;
+  uint16_t address;          /**< 7-bit slave address. */
+  i2c_device_stats stats;
+  i2c_device *next;          /**< Manager private. */
+};
+
+/* One transaction, owned by the caller until it completes. */
+struct i2c_request {
+  bsp_i2c_xfer xfer;         /**< Manager private. */
+  i2c_device *dev;
+  i2c_request_callback callback; /**< May be NULL. */
+  void *context;             /**< Free for the caller. */
+  volatile uint8_t status;   /**< i2c_bus_status, I2C_BUS_PENDING until done. */
+  uint8_t prio;
+  uint8_t has_deadline;
+  uint32_t deadline;         /**< Absolute HAL tick. */
+  uint32_t stamp;            /**< Submit time in core cycles. */
+  i2c_request *next;         /**< Manager private. */
+};
+
+/* Manager state of one I2C peripheral, owned by the application. */
+struct i2c_bus {
+  bsp_i2c_bus engine;
+  i2c_request *pending;      /**< Unordered, picked when the bus frees up. */
+  i2c_request *active;       /**< On the bus. */
+  i2c_request *queued;       /**< In the engine behind active. */
+  i2c_device *devices;
+  i2c_device *last;          /**< Device of the last request put on the bus. */
+  uint8_t batch;             /**< Requests in a row to last. */
+};
+
+/* takes ownership of an initialized I2C handle */
+i2c_bus_status i2c_bus_init(i2c_bus *bus, I2C_HandleTypeDef *hi2c);
+
+/* attaches a device to a bus, address is the 7-bit slave address */
+void i2c_device_init(i2c_device *dev, i2c_bus *bus, const char *name, uint16_t address);
+
+/* fills a request: tx only writes, rx only reads, both write then read with a repeated start */
+void i2c_request_setup(i2c_request *req, i2c_device *dev, uint8_t *tx, uint16_t tx_len,
+                       uint8_t *rx, uint16_t rx_len);
+
+/* queues a request, returns at once; callable from any context */
+i2c_bus_status i2c_bus_submit(i2c_request *req, uint8_t prio, uint32_t deadline_ms);
+
+/* blocks until a submitted request completes, bounded by bsp_i2c_timeout_ms(); thread context */
+i2c_bus_status i2c_bus_wait(const i2c_request *req);
+
+/* blocking write at the default priority */
+i2c_bus_status i2c_dev_write(i2c_device *dev, const uint8_t *data, uint16_t len);
+
+/* write at the default priority from a pool block, returns at once; thread context */
+i2c_bus_status i2c_dev_post_write(i2c_device *dev, const uint8_t *data, uint16_t len);
+
+/* blocking write then read with a repeated start, at the default priority */
+i2c_bus_status i2c_dev_write_read(i2c_device *dev, const uint8_t *tx, uint16_t tx_len,
+                                  uint8_t *rx, uint16_t rx_len);
+
+/* prints the statistics of every device on a bus */
+void i2c_bus_report(const i2c_bus *bus);
+
+#endif /* INC_I2C_BUS_H_ */
@@ -0,0 +1,81 @@
+/*
+ * kernel.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_KERNEL_H_
+#define INC_KERNEL_H_
+
+#include "stm32f4xx_hal.h"
+
+/* Number of priority levels, one thread per level. 0 is the highest. */
+#define KERNEL_PRIO_LEVELS     32u
+/* Priority of the idle thread, not available to the application. */
+#define KERNEL_PRIO_IDLE       (KERNEL_PRIO_LEVELS - 1u)
+/* Smallest stack a thread can be created with, in bytes. */
+#define KERNEL_STACK_MIN       256u
+/* 1: the lowest 32-byte aligned block of the running thread's stack is an
+ * MPU guard, see mpu_guard_thread(). 32-byte aligned stacks lose 32 bytes. */
+#ifndef KERNEL_STACK_GUARD
+#define KERNEL_STACK_GUARD     1
+#endif
+
+/* Status report for the functions. */
+typedef enum {
+  KERNEL_OK             = 0x00u, /**< The action was successful. */
+  KERNEL_ERROR_PRIO     = 0x01u, /**< The priority is out of range or already taken. */
+  KERNEL_ERROR_STACK    = 0x02u, /**< The stack is missing or too small. */
+  KERNEL_ERROR          = 0xFFu  /**< Generic error. */
+} kernel_status;
+
+typedef void (*kernel_entry)(void *arg);
+
+/* Thread control block, owned by the caller. Do not touch the fields directly. */
+typedef struct {
+  uint32_t *sp;              /**< Saved PSP, must stay first (used by PendSV). */
+  const char *name;
+  uint32_t *stack;
+  uint32_t stack_size;
+  uint32_t delay;            /**< Ticks left while delayed. */
+  uint32_t switches;         /**< Times the thread was switched in. */
+  uint8_t prio;
+} kernel_thread;
+
+/* Context switch cost measured inside PendSV, in core cycles. */
+typedef struct {
+  uint32_t count;
+  uint32_t last_cycles;
+  uint32_t max_cycles;
+} kernel_switch_stats;
+
+/* initializes the kernel and its idle thread */
+void kernel_init(void);
+
+/* creates a thread, ready to run once the kernel is started */
+kernel_status kernel_thread_create(kernel_thread *thread, const char *name, kernel_entry entry, void *arg,
+                                   uint8_t prio, uint32_t *stack, uint32_t stack_size);
+
+/* starts the highest priority thread, never returns */
+void kernel_start(void) __attribute__((noreturn));
+
+/* blocks the calling thread for a number of ticks */
+void kernel_delay(uint32_t ticks);
+
+/* thread running right now */
+kernel_thread *kernel_self(void);
+
+/* runs at the start of every PendSV, weak, overridden by the work queue */
+void kernel_pendsv_hook(void);
+
+/* advances the delays, called from SysTick_Handler */
+void kernel_tick_isr(void);
+
+/* reads the context switch cost */
+void kernel_get_switch_stats(kernel_switch_stats *stats);
+
+/* prints every thread and the context switch cost */
+void kernel_report(void);
+
+#endif /* INC_KERNEL_H_ */
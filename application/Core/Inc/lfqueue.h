@@ -0,0 +1,336 @@
+/*
+ * lfqueue.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_LFQUEUE_H_
+#define INC_LFQUEUE_H_
+
+#include <stdint.h>
+
+/**
+ * Lock-free queues for handing data from interrupts to thread context
+ * without masking interrupts.
+ *
+ * SPSC: one producer, one consumer, both wait-free. Typical use is one ISR
+ * feeding the main loop.
+ * MPSC: any number of producers (ISRs of different priorities that preempt
+ * each other, or threads), one consumer. Producers claim a slot with
+ * LDREX/STREX and publish it through a per-slot sequence number, the
+ * consumer is wait-free.
+ *
+ * Both are bounded, the capacity must be a power of two. In C a typed queue
+ * is generated with a macro:
+ *
+ *   LFQ_SPSC_DEFINE(rx_queue, uint8_t, 64)
+ *   static rx_queue rx;
+ *   rx_queue_init(&rx);
+ *   rx_queue_push(&rx, &byte);   (producer)
+ *   rx_queue_pop(&rx, &byte);    (consumer)
+ *
+ * C++ callers use lfq::Spsc<T, N> and lfq::Mpsc<T, N> instead.
+ */
+
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+#include "cmsis_compiler.h"
+
+/* Orders the payload and index accesses as seen by other contexts. */
+static inline void lfq_barrier(void)
+{
+  __DMB();
+}
+
+/* Atomically replaces *ptr by desired if it still holds expected. */
+static inline uint8_t lfq_cas(volatile uint32_t *ptr, uint32_t expected, uint32_t desired)
+{
+  do
+  {
+    if (__LDREXW(ptr) != expected)
+    {
+      __CLREX();
+      return 0u;
+    }
+    /* STREX fails if an exception came in after LDREX, then just retry. */
+  } while (0u != __STREXW(desired, ptr));
+
+  return 1u;
+}
+#else
+/* Host build, used to stress the algorithms with real threads. */
+static inline void lfq_barrier(void)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline uint8_t lfq_cas(volatile uint32_t *ptr, uint32_t expected, uint32_t desired)
+{
+  return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? 1u : 0u;
+}
+#endif
+
+/* Atomically adds delta to a counter shared with interrupts, returns the new value. */
+static inline uint32_t lfq_add(volatile uint32_t *ptr, uint32_t delta)
+{
+  uint32_t value;
+
+  do
+  {
+    value = *ptr;
+  } while (0u == lfq_cas(ptr, value, value + delta));
+
+  return value + delta;
+}
+
+#define LFQ_IS_POW2(n) ((0u != (n)) && (0u == ((n) & ((n) - 1u))))
+
+/**
+ * Defines type `name` and the functions name_init/push/pop/count for a
+ * single-producer single-consumer queue of `capacity` elements of `type`.
+ * push and pop return 1 on success, 0 if the queue is full or empty.
+ */
+#define LFQ_SPSC_DEFINE(name, type, capacity)                                           \
+  _Static_assert(LFQ_IS_POW2(capacity), #name ": capacity must be a power of two");     \
+  typedef struct {                                                                      \
+    volatile uint32_t head; /* written by the producer only */                          \
+    volatile uint32_t tail; /* written by the consumer only */                          \
+    type buf[capacity];                                                                 \
+  } name;                                                                               \
+                                                                                        \
+  static inline void name##_init(name *q)                                               \
+  {                                                                                     \
+    q->head = 0u;                                                                       \
+    q->tail = 0u;                                                                       \
+  }                                                                                     \
+                                                                                        \
+  static inline uint8_t name##_push(name *q, const type *value)                         \
+  {                                                                                     \
+    uint32_t head = q->head;                                                            \
+    if ((head - q->tail) >= (capacity))                                                 \
+    {                                                                                   \
+      return 0u;                                                                        \
+    }                                                                                   \
+    q->buf[head & ((capacity) - 1u)] = *value;                                          \
+    /* The element must be visible before the consumer sees the new head. */            \
+    lfq_barrier();                                                                      \
+    q->head = head + 1u;                                                                \
+    return 1u;                                                                          \
+  }                                                                                     \
+                                                                                        \
+  static inline uint8_t name##_pop(name *q, type *value)                                \
+  {                                                                                     \
+    uint32_t tail = q->tail;                                                            \
+    if (tail == q->head)                                                                \
+    {                                                                                   \
+      return 0u;                                                                        \
+    }                                                                                   \
+    lfq_barrier();                                                                      \
+    *value = q->buf[tail & ((capacity) - 1u)];                                          \
+    /* The element must be read before the producer may overwrite it. */               \
+    lfq_barrier();                                                                      \
+    q->tail = tail + 1u;                                                                \
+    return 1u;                                                                          \
+  }                                                                                     \
+                                                                                        \
+  static inline uint32_t name##_count(const name *q)                                    \
+  {                                                                                     \
+    return q->head - q->tail;                                                           \
+  }
+
+/**
+ * Defines type `name` and the functions name_init/push/pop/count for a
+ * multi-producer single-consumer queue of `capacity` elements of `type`.
+ * push may be called from any context, pop from one consumer only.
+ */
+#define LFQ_MPSC_DEFINE(name, type, capacity)                                           \
+  _Static_assert(LFQ_IS_POW2(capacity), #name ": capacity must be a power of two");     \
+  typedef struct {                                                                      \
+    volatile uint32_t head; /* next position to claim, shared by producers */           \
+    uint32_t tail;          /* next position to read, consumer only */                  \
+    struct {                                                                            \
+      volatile uint32_t seq; /* pos: free for pos, pos + 1: holds pos */                \
+      type value;                                                                       \
+    } slot[capacity];                                                                   \
+  } name;                                                                               \
+                                                                                        \
+  static inline void name##_init(name *q)                                               \
+  {                                                                                     \
+    q->head = 0u;                                                                       \
+    q->tail = 0u;                                                                       \
+    for (uint32_t i = 0u; i < (capacity); i++)                                          \
+    {                                                                                   \
+      q->slot[i].seq = i;                                                               \
+    }                                                                                   \
+  }                                                                                     \
+                                                                                        \
+  static inline uint8_t name##_push(name *q, const type *value)                         \
+  {                                                                                     \
+    uint32_t pos;                                                                       \
+    for (;;)                                                                            \
+    {                                                                                   \
+      pos = q->head;                                                                    \
+      int32_t diff = (int32_t)(q->slot[pos & ((capacity) - 1u)].seq - pos);             \
+      if (0 == diff)                                                                    \
+      {                                                                                 \
+        if (0u != lfq_cas(&q->head, pos, pos + 1u))                                     \
+        {                                                                               \
+          break;                                                                        \
+        }                                                                               \
+      }                                                                                 \
+      else if (diff < 0)                                                                \
+      {                                                                                 \
+        return 0u; /* the consumer has not freed this slot yet: full */                 \
+      }                                                                                 \
+      /* else another producer claimed pos first, try the next one */                   \
+    }                                                                                   \
+    q->slot[pos & ((capacity) - 1u)].value = *value;                                    \
+    lfq_barrier();                                                                      \
+    q->slot[pos & ((capacity) - 1u)].seq = pos + 1u;                                    \
+    return 1u;                                                                          \
+  }                                                                                     \
+                                                                                        \
+  static inline uint8_t name##_pop(name *q, type *value)                                \
+  {                                                                                     \
+    uint32_t pos = q->tail;                                                             \
+    if (q->slot[pos & ((capacity) - 1u)].seq != (pos + 1u))                             \
+    {                                                                                   \
+      return 0u; /* empty, or the producer is still writing it */                       \
+    }                                                                                   \
+    lfq_barrier();                                                                      \
+    *value = q->slot[pos & ((capacity) - 1u)].value;                                    \
+    lfq_barrier();                                                                      \
+    /* Free the slot for the producer that claims it one lap later. */                  \
+    q->slot[pos & ((capacity) - 1u)].seq = pos + (capacity);                            \
+    q->tail = pos + 1u;                                                                 \
+    return 1u;                                                                          \
+  }                                                                                     \
+                                                                                        \
+  static inline uint32_t name##_count(const name *q)                                    \
+  {                                                                                     \
+    return q->head - q->tail;                                                           \
+  }
+
+/* runs the on-target cycles-per-operation benchmark, see lfqueue_bench.c */
+void lfqueue_bench(void);
+
+#ifdef __cplusplus
+
+namespace lfq
+{
+
+/* Single-producer single-consumer queue, same algorithm as LFQ_SPSC_DEFINE. */
+template <typename T, uint32_t N>
+class Spsc
+{
+  static_assert(LFQ_IS_POW2(N), "capacity must be a power of two");
+
+public:
+  Spsc() : head_(0u), tail_(0u) {}
+
+  bool push(const T &value)
+  {
+    uint32_t head = head_;
+    if ((head - tail_) >= N)
+    {
+      return false;
+    }
+    buf_[head & (N - 1u)] = value;
+    lfq_barrier();
+    head_ = head + 1u;
+    return true;
+  }
+
+  bool pop(T &value)
+  {
+    uint32_t tail = tail_;
+    if (tail == head_)
+    {
+      return false;
+    }
+    lfq_barrier();
+    value = buf_[tail & (N - 1u)];
+    lfq_barrier();
+    tail_ = tail + 1u;
+    return true;
+  }
+
+  uint32_t count() const { return head_ - tail_; }
+
+private:
+  volatile uint32_t head_;
+  volatile uint32_t tail_;
+  T buf_[N];
+};
+
+/* Multi-producer single-consumer queue, same algorithm as LFQ_MPSC_DEFINE. */
+template <typename T, uint32_t N>
+class Mpsc
+{
+  static_assert(LFQ_IS_POW2(N), "capacity must be a power of two");
+
+public:
+  Mpsc() : head_(0u), tail_(0u)
+  {
+    for (uint32_t i = 0u; i < N; i++)
+    {
+      slot_[i].seq = i;
+    }
+  }
+
+  bool push(const T &value)
+  {
+    uint32_t pos;
+    for (;;)
+    {
+      pos = head_;
+      int32_t diff = (int32_t)(slot_[pos & (N - 1u)].seq - pos);
+      if ((0 == diff) && (0u != lfq_cas(&head_, pos, pos + 1u)))
+      {
+        break;
+      }
+      if (diff < 0)
+      {
+        return false;
+      }
+    }
+    slot_[pos & (N - 1u)].value = value;
+    lfq_barrier();
+    slot_[pos & (N - 1u)].seq = pos + 1u;
+    return true;
+  }
+
+  bool pop(T &value)
+  {
+    uint32_t pos = tail_;
+    if (slot_[pos & (N - 1u)].seq != (pos + 1u))
+    {
+      return false;
+    }
+    lfq_barrier();
+    value = slot_[pos & (N - 1u)].value;
+    lfq_barrier();
+    slot_[pos & (N - 1u)].seq = pos + N;
+    tail_ = pos + 1u;
+    return true;
+  }
+
+  uint32_t count() const { return head_ - tail_; }
+
+private:
+  struct Slot
+  {
+    volatile uint32_t seq;
+    T value;
+  };
+
+  volatile uint32_t head_;
+  uint32_t tail_;
+  Slot slot_[N];
+};
+
+} /* namespace lfq */
+
+#endif /* __cplusplus */
+
+#endif /* INC_LFQUEUE_H_ */
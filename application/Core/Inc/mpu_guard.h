@@ -0,0 +1,50 @@
+/*
+ * mpu_guard.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_MPU_GUARD_H_
+#define INC_MPU_GUARD_H_
+
+#include "stm32f4xx_hal.h"
+#include "sections.h"
+
+/* Bytes below address 0 that fault on any access, catches NULL dereferences. */
+#define MPU_GUARD_NULL_SIZE     1024u
+/* Bytes of a stack guard, the smallest MPU region. */
+#define MPU_GUARD_SIZE          32u
+/* UART the fault report is written to, by register, without the HAL. */
+#define MPU_GUARD_UART          USART1
+
+/* MPU regions, a higher number wins where regions overlap. */
+#define MPU_GUARD_REGION_NULL   0u
+#define MPU_GUARD_REGION_MSP    1u
+#define MPU_GUARD_REGION_THREAD 2u
+
+/* Guard below a stack whose lowest usable address is limit. */
+#define MPU_GUARD_BELOW(limit)  ((((uint32_t)(limit)) - MPU_GUARD_SIZE) & ~(MPU_GUARD_SIZE - 1u))
+/* Guard inside a thread stack, its lowest aligned block. */
+#define MPU_GUARD_INSIDE(stack) ((((uint32_t)(stack)) + MPU_GUARD_SIZE - 1u) & ~(MPU_GUARD_SIZE - 1u))
+
+/* What the last guard fault found, left in RAM for a debugger. */
+typedef struct {
+  uint32_t cfsr;       /**< MemManage status bits of SCB->CFSR. */
+  uint32_t address;    /**< Faulting data address, 0 if the core did not record one. */
+  uint32_t pc;
+  uint32_t lr;
+  uint32_t sp;         /**< Stack pointer the exception frame was pushed to. */
+  uint32_t exc_return;
+} mpu_guard_fault_info;
+
+/* sets up the null page and main stack guards and enables the MPU */
+void mpu_guard_init(void);
+
+/* moves the thread guard to the bottom of a thread stack, called on every switch */
+RAMFUNC void mpu_guard_thread(const uint32_t *stack);
+
+/* reports a guard violation and resets with a crash dump, entered from MemManage_Handler */
+void mpu_guard_fault(const uint32_t *frame, uint32_t exc_return) __attribute__((noreturn));
+
+#endif /* INC_MPU_GUARD_H_ */
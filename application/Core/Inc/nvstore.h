@@ -0,0 +1,91 @@
+/*
+ * nvstore.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_NVSTORE_H_
+#define INC_NVSTORE_H_
+
+#include "rtc_ds1307.h"
+
+/**
+ * Small record store in the battery-backed RAM of the DS1307, for values
+ * that change often and must survive resets and power loss without
+ * wearing the flash.
+ *
+ * NVRAM map (offset 0 is register 0x08):
+ *   0-1    time zone, ds1307_set_time_zone()
+ *   2-7    free
+ *   8      century, rtc_ds1307.c
+ *   9-35   records below, each followed by its CRC8
+ *   36-55  free
+ *
+ * nvstore_init() loads all records in one burst; reads are then served
+ * from RAM and every write is a single burst of payload and CRC. A record
+ * whose CRC does not match (never written, battery lost, write cut short)
+ * reads as NVSTORE_ERROR_CRC. Thread context only, the bus accesses block.
+ */
+
+/* Record identifiers. */
+typedef enum {
+  NVSTORE_BOOT = 0,              /**< uint32_t boot counter. */
+  NVSTORE_FAULT,                 /**< nvstore_fault, last fault recorded. */
+  NVSTORE_FLASH_MARKER,          /**< nvstore_flash_marker, write-ahead marker of a flash update. */
+  NVSTORE_RECORDS
+} nvstore_id;
+
+/* Status report for the functions. */
+typedef enum {
+  NVSTORE_OK         = 0x00u, /**< The action was successful. */
+  NVSTORE_ERROR_CRC  = 0x01u, /**< The record is empty or corrupt. */
+  NVSTORE_ERROR_BUS  = 0x02u, /**< The DS1307 did not answer. */
+  NVSTORE_ERROR_ID   = 0x03u, /**< The record does not exist. */
+  NVSTORE_ERROR      = 0xFFu  /**< Generic error. */
+} nvstore_status;
+
+/* Last fault: application defined code and when it happened. */
+typedef struct {
+  uint32_t code;
+  epoch_t time;
+} nvstore_fault;
+
+/* Steps of a flash update, written before each step starts. */
+typedef enum {
+  NVSTORE_FLASH_IDLE = 0,        /**< No update in progress. */
+  NVSTORE_FLASH_ERASING,         /**< The target area is being erased. */
+  NVSTORE_FLASH_WRITING,         /**< The new image is being written. */
+  NVSTORE_FLASH_WRITTEN          /**< Written, not verified yet. */
+} nvstore_flash_state;
+
+/* Write-ahead marker, set by flash.c before each step and back to IDLE after
+ * it succeeded: after a reset, anything but IDLE means the step failed or
+ * was cut short. */
+typedef struct {
+  uint8_t state;                 /**< nvstore_flash_state. */
+  uint8_t reserved;
+  uint16_t sequence;             /**< Bumped for every step started from IDLE. */
+  uint32_t address;
+  uint32_t length;
+} nvstore_flash_marker;
+
+/* loads every record, after ds1307_init() */
+nvstore_status nvstore_init(void);
+
+/* copies a record out of the RAM image */
+nvstore_status nvstore_read(nvstore_id id, void *data);
+
+/* writes a record in one burst */
+nvstore_status nvstore_write(nvstore_id id, const void *data);
+
+/* adds one to the boot counter, starting from 0 if it was invalid */
+nvstore_status nvstore_boot_count(uint32_t *count);
+
+/* stores a fault code with the current DS1307 time as the last fault */
+nvstore_status nvstore_fault_record(uint32_t code);
+
+/* writes the flash marker before an update step, NVSTORE_FLASH_IDLE once it is done */
+nvstore_status nvstore_flash_mark(nvstore_flash_state state, uint32_t address, uint32_t length);
+
+#endif /* INC_NVSTORE_H_ */
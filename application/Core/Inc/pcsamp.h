@@ -0,0 +1,66 @@
+/*
+ * pcsamp.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_PCSAMP_H_
+#define INC_PCSAMP_H_
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * Statistical profiler. TIM5 interrupts at a fixed rate above every other
+ * interrupt and stores the PC and LR of the exception frame it preempted,
+ * so any code shows up, HAL and ISRs included, without instrumenting it.
+ * A capture fills the buffer and stops the timer before anything is
+ * printed, so the streaming does not profile itself. pcsamp_poll() then
+ * prints the samples as text lines for the pc_profile host tool:
+ *
+ *   pcsamp begin <rate_hz> <count>
+ *   $<pc> <lr>                       hex, one line per sample
+ *   pcsamp end
+ *
+ * Code running with interrupts masked is charged to where it unmasks.
+ */
+#define PCSAMP_TIM            TIM5
+#define PCSAMP_IRQn           TIM5_IRQn
+/* Samples of one capture, 8 bytes each. */
+#define PCSAMP_DEPTH          1024u
+/* Default rate, kept off multiples of the 1 kHz SysTick so periodic work does not alias. */
+#ifndef PCSAMP_RATE_HZ
+#define PCSAMP_RATE_HZ        997u
+#endif
+/* Sample lines printed by one pcsamp_poll() call. */
+#define PCSAMP_LINES_PER_POLL 32u
+
+/* Status codes. */
+typedef enum {
+  PCSAMP_OK    = 0x00u,
+  PCSAMP_BUSY  = 0x01u,
+  PCSAMP_ERROR = 0xFFu
+} pcsamp_status;
+
+/* One sample, from the stacked exception frame. */
+typedef struct {
+  uint32_t pc;
+  uint32_t lr;
+} pcsamp_sample;
+
+/* clocks the sampling timer, leaves it stopped */
+void pcsamp_init(void);
+
+/* starts a capture of PCSAMP_DEPTH samples at rate_hz, 0 for the default */
+pcsamp_status pcsamp_start(uint32_t rate_hz);
+
+/* stops a capture early, what was taken is still printed */
+void pcsamp_stop(void);
+
+/* prints the next lines of a finished capture, call from a task */
+void pcsamp_poll(void);
+
+/* stores one sample, called by TIM5_IRQHandler with the preempted frame */
+void pcsamp_isr(const uint32_t *frame);
+
+#endif /* INC_PCSAMP_H_ */
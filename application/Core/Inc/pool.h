@@ -0,0 +1,86 @@
+/*
+ * pool.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_POOL_H_
+#define INC_POOL_H_
+
+#include "stm32f4xx_hal.h"
+#include <stddef.h>
+
+/**
+ * Fixed-size block pools for driver buffers, in place of malloc.
+ *
+ * Every pool is a static array of equal blocks with a free list threaded
+ * through the unused blocks, so allocate and free are O(1) and the pools
+ * never fragment. Pools are set at compile time with POOL_TABLE, a board
+ * may define its own table before including this header:
+ *
+ *   X(id, block size in bytes, block count, lock-free)
+ *
+ * The block size must be a multiple of 8. Lock-free pools may be used from
+ * any ISR and from thread context, the others mask interrupts for a few
+ * instructions around the free list.
+ */
+#ifndef POOL_TABLE
+#define POOL_TABLE(X)                                                                 \
+  X(POOL_SMALL,   32u, 16u, 1u) /* short commands */                                 \
+  X(POOL_FRAME,  128u,  8u, 1u) /* UART frames, posted I2C writes */                  \
+  X(POOL_CHUNK,  256u,  4u, 0u) /* update chunks handed to flash_write() */
+#endif
+
+/* Section of the pool storage, empty keeps the blocks in .bss. */
+#ifndef POOL_SECTION
+#define POOL_SECTION
+#endif
+
+#define POOL_ID(id, size, count, lock_free) id,
+typedef enum {
+  POOL_TABLE(POOL_ID)
+  POOL_COUNT
+} pool_id;
+#undef POOL_ID
+
+/* Status report for the functions. */
+typedef enum {
+  POOL_OK            = 0x00u, /**< The action was successful. */
+  POOL_ERROR_INVALID = 0x01u, /**< The pool does not exist or the block is not from a pool. */
+  POOL_ERROR         = 0xFFu  /**< Generic error. */
+} pool_status;
+
+/* Usage of one pool, in blocks. */
+typedef struct {
+  uint32_t used;
+  uint32_t high_water;
+  uint32_t allocs;
+  uint32_t failures; /**< Allocations refused because the pool was empty. */
+} pool_stats;
+
+/* Allocates a block for an object of the given type, NULL if none fits. */
+#define POOL_NEW(type) ((type *)pool_alloc_size(sizeof(type)))
+
+/* threads the free lists and clears the statistics */
+void pool_init(void);
+
+/* takes one block from a pool, NULL if the pool is empty */
+void *pool_alloc(pool_id id);
+
+/* takes a block of at least size bytes from the smallest pool with one left */
+void *pool_alloc_size(size_t size);
+
+/* gives a block back to the pool it came from */
+pool_status pool_free(void *block);
+
+/* block size of a pool, 0 if it does not exist */
+uint32_t pool_block_size(pool_id id);
+
+/* reads the statistics of one pool */
+pool_status pool_get_stats(pool_id id, pool_stats *stats);
+
+/* prints the usage of every pool */
+void pool_report(void);
+
+#endif /* INC_POOL_H_ */
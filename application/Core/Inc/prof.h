@@ -0,0 +1,126 @@
+/*
+ * prof.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_PROF_H_
+#define INC_PROF_H_
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * Profiling zones on the DWT cycle counter. A zone is named at its first
+ * use and keeps count, min, max, mean and a log2 histogram of the cycles
+ * spent in it, callable from threads and ISRs alike:
+ *
+ *   void flash_work(void)
+ *   {
+ *     PROF_SCOPE(flash_work);   ends when the enclosing block is left
+ *     ...
+ *   }
+ *
+ *   PROF_BEGIN(crc);            explicit pair in the same block
+ *   ...
+ *   PROF_END(crc);
+ *
+ * In C++ PROF_SCOPE is a prof::Zone object. Zones with the same name
+ * share one entry. The cost of reading the counter is taken off every
+ * sample. Build with PROF_ENABLE 0 to compile all zones out.
+ */
+#ifndef PROF_ENABLE
+#define PROF_ENABLE      1
+#endif
+/* Entries of the zone table. */
+#define PROF_MAX_ZONES   16u
+/* Histogram bin n counts samples of 2^n to 2^(n+1)-1 cycles. */
+#define PROF_HIST_BINS   32u
+
+/* One entry of the zone table, cycles. */
+typedef struct {
+  const char *name;
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+  uint32_t hist[PROF_HIST_BINS];
+} prof_zone;
+
+/* Start of one sample, handed from prof_begin() to prof_end(). */
+typedef struct {
+  prof_zone *zone;
+  uint32_t start;
+} prof_mark;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* starts the cycle counter, measures its own cost and clears the table */
+void prof_init(void);
+
+/* registers the zone on first use and starts a sample */
+prof_mark prof_begin(prof_zone **slot, const char *name);
+
+/* ends a sample and adds it to its zone */
+void prof_end(prof_mark mark);
+
+/* ends the sample of a PROF_SCOPE, run by the cleanup attribute */
+void prof_scope_end(prof_mark *mark);
+
+/* clears the statistics, keeps the zones */
+void prof_reset(void);
+
+/* prints every zone and its histogram */
+void prof_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if PROF_ENABLE
+#define PROF_BEGIN(tag)                                                                   \
+  static prof_zone *prof_zone_##tag = NULL;                                               \
+  prof_mark prof_mark_##tag = prof_begin(&prof_zone_##tag, #tag)
+#define PROF_END(tag)    prof_end(prof_mark_##tag)
+#ifndef __cplusplus
+#define PROF_SCOPE(tag)                                                                   \
+  static prof_zone *prof_zone_##tag = NULL;                                               \
+  prof_mark prof_mark_##tag __attribute__((cleanup(prof_scope_end))) =                   \
+    prof_begin(&prof_zone_##tag, #tag)
+#else
+#define PROF_SCOPE(tag)                                                                   \
+  static prof_zone *prof_zone_##tag = NULL;                                               \
+  prof::Zone prof_scope_##tag(&prof_zone_##tag, #tag)
+#endif
+#else
+#define PROF_BEGIN(tag)  (void)0
+#define PROF_END(tag)    (void)0
+#define PROF_SCOPE(tag)  (void)0
+#endif
+
+#ifdef __cplusplus
+
+namespace prof
+{
+
+/* Zone that ends with the enclosing scope, see PROF_SCOPE. */
+class Zone
+{
+public:
+  Zone(prof_zone **slot, const char *name) : mark_(prof_begin(slot, name)) {}
+  ~Zone() { prof_end(mark_); }
+
+  Zone(const Zone &) = delete;
+  Zone &operator=(const Zone &) = delete;
+
+private:
+  prof_mark mark_;
+};
+
+} // namespace prof
+
+#endif /* __cplusplus */
+
+#endif /* INC_PROF_H_ */
@@ -0,0 +1,180 @@
+/*
+ * pt.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_PT_H_
+#define INC_PT_H_
+
+#include <stdint.h>
+
+/**
+ * Stackless coroutines (protothreads).
+ *
+ * A protothread is a function that can suspend in the middle of its body
+ * and resume there on the next call. The only state kept across calls is
+ * the resume point, 2 bytes per thread, so a multi-step I/O sequence can
+ * be written as straight-line code without a stack of its own:
+ *
+ *   static PT_THREAD(read_sequence(pt *p))
+ *   {
+ *     PT_BEGIN(p);
+ *     start_transfer();
+ *     PT_WAIT_UNTIL(p, transfer_done);
+ *     start_next_transfer();
+ *     PT_WAIT_UNTIL(p, transfer_done);
+ *     PT_END(p);
+ *   }
+ *
+ * The thread is driven by calling it again whenever the awaited condition
+ * may have changed, typically from the scheduler task that receives the
+ * I/O completion event.
+ *
+ * Limitations: local variables are not kept across a wait, keep them in a
+ * struct next to the pt. A switch statement cannot span a wait, and each
+ * wait must sit on its own source line.
+ */
+
+/* Return values of a protothread. */
+#define PT_WAITING  0u /**< Blocked on a condition. */
+#define PT_YIELDED  1u /**< Gave up the CPU, can run again right away. */
+#define PT_EXITED   2u /**< Left through PT_EXIT(). */
+#define PT_ENDED    3u /**< Reached PT_END(). */
+
+/* Resume point, the line of the last wait. 0 means start of the body. */
+typedef uint16_t pt_lc;
+
+typedef struct {
+  pt_lc lc;
+} pt;
+
+/* Declares a protothread function. */
+#define PT_THREAD(name_args) uint8_t name_args
+
+/* Rewinds a protothread to the start of its body. */
+#define PT_INIT(p) ((p)->lc = 0u)
+
+/* Opens the body of a protothread. */
+#define PT_BEGIN(p)                                                     \
+  {                                                                     \
+    uint8_t pt_yield_flag = 1u;                                         \
+    (void)pt_yield_flag;                                                \
+    switch ((p)->lc)                                                    \
+    {                                                                   \
+      case 0u:
+
+/* Closes the body of a protothread. */
+#define PT_END(p)                                                       \
+    }                                                                   \
+    pt_yield_flag = 0u;                                                 \
+    PT_INIT(p);                                                         \
+    return PT_ENDED;                                                    \
+  }
+
+/* Suspends the protothread until cond is true. */
+#define PT_WAIT_UNTIL(p, cond)                                          \
+  do                                                                    \
+  {                                                                     \
+    (p)->lc = (pt_lc)__LINE__;                                          \
+    /* FALLTHROUGH */                                                   \
+    case __LINE__:                                                      \
+      if (!(cond))                                                      \
+      {                                                                 \
+        return PT_WAITING;                                              \
+      }                                                                 \
+  } while (0)
+
+/* Suspends the protothread while cond is true. */
+#define PT_WAIT_WHILE(p, cond) PT_WAIT_UNTIL((p), !(cond))
+
+/* Suspends the protothread until the child protothread call has ended. */
+#define PT_WAIT_THREAD(p, thread) PT_WAIT_WHILE((p), PT_SCHEDULE(thread))
+
+/* Starts a child protothread and waits for it to end. */
+#define PT_SPAWN(p, child, thread)                                      \
+  do                                                                    \
+  {                                                                     \
+    PT_INIT(child);                                                     \
+    PT_WAIT_THREAD((p), (thread));                                      \
+  } while (0)
+
+/* Gives up the CPU once, resumes on the next call. */
+#define PT_YIELD(p)                                                     \
+  do                                                                    \
+  {                                                                     \
+    pt_yield_flag = 0u;                                                 \
+    (p)->lc = (pt_lc)__LINE__;                                          \
+    /* FALLTHROUGH */                                                   \
+    case __LINE__:                                                      \
+      if (0u == pt_yield_flag)                                          \
+      {                                                                 \
+        return PT_YIELDED;                                              \
+      }                                                                 \
+  } while (0)
+
+/* Gives up the CPU until cond is true, at least once. */
+#define PT_YIELD_UNTIL(p, cond)                                         \
+  do                                                                    \
+  {                                                                     \
+    pt_yield_flag = 0u;                                                 \
+    (p)->lc = (pt_lc)__LINE__;                                          \
+    /* FALLTHROUGH */                                                   \
+    case __LINE__:                                                      \
+      if ((0u == pt_yield_flag) || !(cond))                             \
+      {                                                                 \
+        return PT_YIELDED;                                              \
+      }                                                                 \
+  } while (0)
+
+/* Restarts the protothread from the top on the next call. */
+#define PT_RESTART(p)                                                   \
+  do                                                                    \
+  {                                                                     \
+    PT_INIT(p);                                                         \
+    return PT_WAITING;                                                  \
+  } while (0)
+
+/* Leaves the protothread, the next call starts from the top. */
+#define PT_EXIT(p)                                                      \
+  do                                                                    \
+  {                                                                     \
+    PT_INIT(p);                                                         \
+    return PT_EXITED;                                                   \
+  } while (0)
+
+/* Runs a protothread once, true while it has not finished. */
+#define PT_SCHEDULE(f) ((f) < PT_EXITED)
+
+#ifdef __cplusplus
+
+/**
+ * C++ wrapper: derive, implement run() with the same PT_ macros on &state_,
+ * and call resume() whenever the awaited condition may have changed.
+ *
+ *   class Sequence : public Protothread {
+ *     uint8_t run() override { PT_BEGIN(&state_); ... PT_END(&state_); }
+ *   };
+ */
+class Protothread
+{
+public:
+  Protothread() { PT_INIT(&state_); }
+  virtual ~Protothread() {}
+
+  /* Runs until the next wait, returns true while not finished. */
+  bool resume() { return PT_SCHEDULE(run()); }
+
+  /* Rewinds to the start of run(). */
+  void restart() { PT_INIT(&state_); }
+
+protected:
+  virtual uint8_t run() = 0;
+
+  pt state_;
+};
+
+#endif /* __cplusplus */
+
+#endif /* INC_PT_H_ */
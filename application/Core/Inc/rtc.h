@@ -0,0 +1,99 @@
+/*
+ * rtc.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_RTC_H_
+#define INC_RTC_H_
+
+#include "epoch.h"
+
+/**
+ * Time source abstraction. A backend is a table of functions; two are
+ * provided:
+ *
+ *   rtc_internal_backend  on-chip RTC clocked from LSE (LSI as fallback),
+ *                         read straight from its registers in a few dozen
+ *                         cycles, trimmable with smooth calibration.
+ *   rtc_ds1307_backend    DS1307 through the software clock, so reads are
+ *                         memory reads once the clock is synced; kept as the
+ *                         battery-backed reference.
+ *
+ * rtc_now() goes to the selected backend. The default is chosen at compile
+ * time with RTC_DEFAULT_BACKEND; define RTC_FIXED_BACKEND to drop runtime
+ * selection and call the default directly.
+ *
+ * rtc_discipline_start() keeps the selected backend in step with a
+ * reference: it sets it from the reference once, then measures the drift
+ * between them every period and trims the selected backend by it.
+ */
+
+#ifndef RTC_DEFAULT_BACKEND
+#define RTC_DEFAULT_BACKEND  rtc_internal_backend
+#endif
+
+/* Status report for the functions. */
+typedef enum {
+  RTC_OK            = 0x00u, /**< The action was successful. */
+  RTC_ERROR_INVALID = 0x01u, /**< The time source has no valid time yet. */
+  RTC_ERROR_HW      = 0x02u, /**< The hardware did not respond. */
+  RTC_ERROR_SUPPORT = 0x03u, /**< The backend cannot do this. */
+  RTC_ERROR         = 0xFFu  /**< Generic error. */
+} rtc_status;
+
+/* A time source. */
+typedef struct {
+  const char *name;
+  /* brings the source up, may block for oscillator start-up */
+  rtc_status (*init)(void);
+  /* current time and microseconds into the second */
+  rtc_status (*now)(epoch_t *t, uint32_t *usec);
+  /* sets the time, the new second starts on return */
+  rtc_status (*set)(epoch_t t);
+  /* corrects a measured drift, positive when the source runs fast; NULL if not trimmable */
+  rtc_status (*trim)(int32_t drift_ppb);
+} rtc_backend;
+
+/* Drift measurement between two sources, see rtc_calibrate_start(). */
+typedef struct {
+  const rtc_backend *ref;
+  const rtc_backend *target;
+  uint64_t ref_us;
+  uint64_t target_us;
+} rtc_calibration;
+
+extern const rtc_backend rtc_internal_backend;
+extern const rtc_backend rtc_ds1307_backend;
+
+/* initializes the default backend and selects it */
+rtc_status rtc_init(void);
+
+#ifndef RTC_FIXED_BACKEND
+/* switches rtc_now() to another backend, initializing it */
+rtc_status rtc_select(const rtc_backend *backend);
+#endif
+
+/* backend rtc_now() uses */
+const rtc_backend *rtc_current(void);
+
+/* current time from the selected backend */
+rtc_status rtc_now(epoch_t *t, uint32_t *usec);
+
+/* sets target from ref, call right after a second boundary of ref; does not block */
+rtc_status rtc_sync(const rtc_backend *ref, const rtc_backend *target);
+
+/* samples both sources, the start of a drift measurement */
+rtc_status rtc_calibrate_start(rtc_calibration *cal, const rtc_backend *ref, const rtc_backend *target);
+
+/* samples again and gives the drift of target against ref since the start, optionally trims target */
+rtc_status rtc_calibrate_finish(rtc_calibration *cal, int32_t *drift_ppb, uint8_t apply);
+
+/* keeps the selected backend synced and trimmed against ref, thread context */
+rtc_status rtc_discipline_start(const rtc_backend *ref, uint32_t period_s);
+
+/* prints the selected backend and the last drift measured */
+void rtc_report(void);
+
+#endif /* INC_RTC_H_ */
@@ -9,10 +9,10 @@
 #define INC_RTC_DS1307_H_
 
 #include "main.h"
+#include "i2c_bus.h"
+#include "epoch.h"
 
-extern I2C_HandleTypeDef *_ds1307_ui2c;
-
-/* DS1307 I2C clock */
+/* DS1307 I2C clock; a transfer that overruns its wire time fails and the bus is recovered, see bsp_i2c_timeout_ms() */
 #define DS1307_I2C_CLOCK    100000
 
 /* I2C slave address for DS1307 */
@@ -30,7 +30,13 @@ extern I2C_HandleTypeDef *_ds1307_ui2c;
 #define DS1307_REG_UTC_HR   0x08
 #define DS1307_REG_UTC_MIN  0x09
 #define DS1307_REG_CENT     0x10
-#define DS1307_TIMEOUT 		1000
+#define DS1307_REG_NVRAM    0x08
+
+/* Battery-backed RAM, 0x08 to 0x3F */
+#define DS1307_NVRAM_SIZE	56
+
+/* Bytes fetched by a burst time read: seconds up to and including the century */
+#define DS1307_BURST_LEN	(DS1307_REG_CENT + 1)
 
 /* Bits in control register */
 #define DS1307_CONTROL_OUT 	7 // use to translate bit 1
@@ -64,20 +70,19 @@ typedef enum
 /**
  * @brief  Structure for date and time
  */
-//typedef struct
-//{
-//	uint8_t seconds; // Seconds, from 00 to 59
-//	uint8_t minutes; // Minutes, from 00 to 59
-//	uint8_t hours;	 // Hours, 24Hour mode, 00 to 23
-//	uint8_t dow;	 // Day in a week, from 1 to 7
-//	uint8_t date;	 // Date in a month, 1 to 31
-//	uint8_t month;	 // Month in a year, 1 to 12
-//	uint8_t year;	 // Year, 00 to 99, 00 is 2000 and 99 is 2099
-//} ds1307_time_t;
-//ds1307_time_t ds1307;
-
-/* Initialize the DS1307 RTC module*/
-void ds1307_init(I2C_HandleTypeDef *hi2c);
+typedef struct
+{
+	uint8_t seconds; // Seconds, from 00 to 59
+	uint8_t minutes; // Minutes, from 00 to 59
+	uint8_t hours;	 // Hours, 24Hour mode, 00 to 23
+	uint8_t dow;	 // Day in a week, from 1 to 7
+	uint8_t date;	 // Date in a month, 1 to 31
+	uint8_t month;	 // Month in a year, 1 to 12
+	uint16_t year;	 // Year, 2000 to 2099
+} ds1307_time_t;
+
+/* Initialize the DS1307 RTC module on a managed bus */
+void ds1307_init(i2c_bus *bus);
 
 /* Set or clear Clock Halt bit ((CH)) to stop (1) or continue (0) real-time clock */
 void ds1307_set_clock_halt(uint8_t halt);
@@ -104,6 +109,10 @@ void ds1307_disable_output_pin(void);
 
 void ds1307_get_date_time(); 							// get full date and time
 
+ds1307_result_t ds1307_read_time(ds1307_time_t *time);	// snapshot of the full date and time in one transaction
+
+void ds1307_decode_time(const uint8_t *raw, ds1307_time_t *time);	// decode a burst read of DS1307_BURST_LEN registers
+
 uint8_t ds1307_get_dayofweek(void); 					// get one register date or time
 uint8_t ds1307_get_date(void);
 uint8_t ds1307_get_month(void);
@@ -116,9 +125,12 @@ uint8_t ds1307_get_second(void);
 /* Set Time */
 
 void ds1307_set_time_zone(int8_t hour, uint8_t min); 	// Set time zone
+ds1307_result_t ds1307_get_time_zone(int8_t *hour, uint8_t *min);	// Get time zone, see epoch_tz_offset()
 
 void ds1307_set_date_time(uint8_t second, uint8_t minute, uint8_t hour_24mode, uint8_t dayofweek, uint8_t date, uint8_t month, uint16_t year); 	// set full date and time
 
+ds1307_result_t ds1307_write_time(const ds1307_time_t *time);	// set full date and time in one transaction
+
 void ds1307_set_dayofweek(uint8_t dow);					// set one register date or time
 void ds1307_set_date(uint8_t date);
 void ds1307_set_month(uint8_t month);
@@ -129,10 +141,24 @@ void ds1307_set_minute(uint8_t minute);
 void ds1307_set_second(uint8_t second);
 void ds1307_set_timezone(int8_t hr, uint8_t min);
 
+/* Battery-backed RAM, offset 0 is register 0x08 */
+ds1307_result_t ds1307_write_nvram(uint8_t offset, const uint8_t *data, uint8_t len);
+ds1307_result_t ds1307_read_nvram(uint8_t offset, uint8_t *data, uint8_t len);
+
+/* Unix time of a date and time, and back; dow 1 is Sunday */
+epoch_t ds1307_time_to_epoch(const ds1307_time_t *time);
+void ds1307_time_from_epoch(epoch_t t, ds1307_time_t *time);
+
+/* Bus device of the DS1307, for asynchronous requests */
+i2c_device *ds1307_get_device(void);
+
+/* Compare bus and CPU time of the burst read with the per-register path */
+void ds1307_bench(void);
+
 /* Convert BCD value to Bin */
-uint8_t ds1307_bcd_to_bin(uint8_t bin);
+uint8_t ds1307_bcd_to_bin(uint8_t bcd);
 
 /* Convert Bin value to BCD */
-uint8_t ds1307_bin_to_bcd(uint8_t dec);
+uint8_t ds1307_bin_to_bcd(uint8_t bin);
 
 #endif /* INC_RTC_DS1307_H_ */
@@ -0,0 +1,43 @@
+/*
+ * rtc_internal.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_RTC_INTERNAL_H_
+#define INC_RTC_INTERNAL_H_
+
+#include "rtc.h"
+
+/**
+ * On-chip RTC as an rtc.h backend (rtc_internal_backend).
+ *
+ * Clocked from the 32.768 kHz LSE, or from the LSI when no crystal starts
+ * within LSE_STARTUP_TIMEOUT. The calendar lives in the backup domain, so
+ * a running RTC is kept as is across resets and only a first start (or a
+ * backup domain that lost power) reinitialises it to 2000-01-01.
+ *
+ * Reads take the subsecond, time and date shadow registers, consistent with
+ * each other, with no bus access. The calendar counts years 2000 to 2099.
+ * Trimming uses smooth calibration: steps of about 0.95 ppm, from -487 to
+ * +488 ppm, applied over 32 s cycles.
+ */
+
+/* Clock feeding the RTC. */
+typedef enum {
+  RTC_INTERNAL_NONE = 0,         /**< Not started. */
+  RTC_INTERNAL_LSE,              /**< 32.768 kHz crystal. */
+  RTC_INTERNAL_LSI               /**< Internal RC, tens of ppm off per degree. */
+} rtc_internal_clock;
+
+/* First year of the on-chip calendar. */
+#define RTC_INTERNAL_BASE_YEAR   2000u
+
+/* clock the RTC runs from */
+rtc_internal_clock rtc_internal_get_clock(void);
+
+/* total correction programmed by trims, in ppb, positive speeds the RTC up */
+int32_t rtc_internal_get_trim(void);
+
+#endif /* INC_RTC_INTERNAL_H_ */
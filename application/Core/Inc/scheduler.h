@@ -0,0 +1,83 @@
+/*
+ * scheduler.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_SCHEDULER_H_
+#define INC_SCHEDULER_H_
+
+#include "stm32f4xx_hal.h"
+
+/* Number of tasks that can be registered. */
+#define SCHED_MAX_TASKS        8u
+/* Number of priority levels, 0 is the highest. */
+#define SCHED_PRIO_LEVELS      4u
+/* Depth of each priority queue and of the ISR queue, must be a power of two. */
+#define SCHED_QUEUE_LEN        16u
+/* Number of sched_every() timers that can be armed. */
+#define SCHED_MAX_PERIODIC     8u
+
+/* Signals below this value are reserved for the scheduler. */
+#define SCHED_SIG_USER         0x10u
+/* Signal posted by sched_every(). */
+#define SCHED_SIG_TICK         0x01u
+
+/* Status report for the functions. */
+typedef enum {
+  SCHED_OK          = 0x00u, /**< The action was successful. */
+  SCHED_ERROR_FULL  = 0x01u, /**< The queue or table is full, nothing was posted. */
+  SCHED_ERROR_TASK  = 0x02u, /**< The task id is not valid. */
+  SCHED_ERROR       = 0xFFu  /**< Generic error. */
+} sched_status;
+
+typedef uint8_t sched_task_id;
+
+/* Event handed to a task, stamped with the cycle counter when it was posted. */
+typedef struct {
+  uint16_t sig;
+  sched_task_id task;
+  uint32_t param;
+  uint32_t stamp;
+} sched_event;
+
+/* Task handler, runs to completion for every event. */
+typedef void (*sched_handler)(const sched_event *evt);
+
+/* Run-time accounting for one task, in core cycles. */
+typedef struct {
+  uint32_t runs;
+  uint64_t busy_cycles;
+  uint32_t max_run_cycles;
+  uint32_t max_latency_cycles;
+} sched_stats;
+
+/* initializes the scheduler and the cycle counter */
+void sched_init(void);
+
+/* registers a task, returns its id through *id */
+sched_status sched_task_create(const char *name, sched_handler handler, uint8_t prio, sched_task_id *id);
+
+/* posts an event from thread context */
+sched_status sched_post(sched_task_id task, uint16_t sig, uint32_t param);
+
+/* posts an event from interrupt context */
+sched_status sched_post_isr(sched_task_id task, uint16_t sig, uint32_t param);
+
+/* posts SCHED_SIG_TICK to a task every period_ms */
+sched_status sched_every(sched_task_id task, uint32_t period_ms);
+
+/* dispatches all pending events, sleeps if there are none */
+void sched_run_once(void);
+
+/* reads the statistics of one task */
+sched_status sched_get_stats(sched_task_id task, sched_stats *stats);
+
+/* name of a task, NULL for an invalid id */
+const char *sched_task_name(sched_task_id task);
+
+/* prints run time and worst latency of every task */
+void sched_report(void);
+
+#endif /* INC_SCHEDULER_H_ */
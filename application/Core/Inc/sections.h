@@ -0,0 +1,27 @@
+/*
+ * sections.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_SECTIONS_H_
+#define INC_SECTIONS_H_
+
+/**
+ * Placement attributes for the custom linker sections. Put them on the
+ * declaration and on the definition.
+ *
+ * RAMFUNC: code copied to RAM by Reset_Handler, runs without flash wait
+ * states and keeps running while the flash is busy programming. Calls
+ * between flash and RAM go through a long call.
+ *
+ * NOINIT: data Reset_Handler neither loads nor zeroes, so it survives a
+ * warm reset (watchdog, NVIC_SystemReset, jump from the bootloader). It
+ * holds garbage after power-up: guard it with a magic word or a CRC, and
+ * never give it an initializer.
+ */
+#define RAMFUNC  __attribute__((section(".ramfunc"), noinline, long_call))
+#define NOINIT   __attribute__((section(".noinit")))
+
+#endif /* INC_SECTIONS_H_ */
@@ -0,0 +1,90 @@
+/*
+ * softclock.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_SOFTCLOCK_H_
+#define INC_SOFTCLOCK_H_
+
+#include "rtc_ds1307.h"
+#include "scheduler.h"
+
+/**
+ * Software copy of the DS1307 time, so reading the time never touches the
+ * I2C bus.
+ *
+ * The DS1307 drives a 1 Hz square wave on SQW/OUT whose falling edge comes
+ * with the seconds update. Each edge advances the local copy, kept as Unix
+ * time (see epoch.h), by one second and records the cycle counter;
+ * softclock_now() adds the time since that edge for sub-second resolution,
+ * scaled by the measured edge period.
+ * Every SOFTCLOCK_RESYNC_S edges the chip is read again right after an
+ * edge, and the local copy is corrected if it drifted (missed edges,
+ * time set on the chip behind our back).
+ *
+ * The edge interrupt only stamps the edge; the rest runs from the work
+ * queue.
+ * Reads are lock-free and may be done from any context, interrupts
+ * included: the writer fills the spare of two slots and then publishes it.
+ */
+
+/* Edges between two reads of the chip. */
+#define SOFTCLOCK_RESYNC_S     60u
+/* The chip is only read if this much of the current second is left after the edge. */
+#define SOFTCLOCK_WINDOW_MS    500u
+/* Edge periods further than this from the estimate are treated as glitches or misses, in ppm. */
+#define SOFTCLOCK_GLITCH_PPM   20000u
+/* Scheduler priority of the resync task. */
+#define SOFTCLOCK_TASK_PRIO    1u
+/* Work queue level the edge interrupt defers its follow-up to, see workq.h. */
+#define SOFTCLOCK_WORKQ_LEVEL  0u
+
+/* Status report for the functions. */
+typedef enum {
+  SOFTCLOCK_OK          = 0x00u, /**< The action was successful. */
+  SOFTCLOCK_ERROR_SYNC  = 0x01u, /**< No valid time yet, the first edge or chip read is pending. */
+  SOFTCLOCK_ERROR       = 0xFFu  /**< Generic error. */
+} softclock_status;
+
+/* Timestamp handed out by softclock_now(). */
+typedef struct {
+  epoch_t epoch;               /**< Same instant as time, for arithmetic. */
+  ds1307_time_t time;
+  uint32_t usec;               /**< Microseconds into the current second, 0 to 999999. */
+} softclock_time;
+
+/* Synchronisation health, see softclock_report(). */
+typedef struct {
+  uint32_t edges;              /**< SQW edges seen. */
+  uint32_t glitches;           /**< Edges rejected for an implausible period. */
+  uint32_t resyncs;            /**< Successful reads of the chip. */
+  uint32_t corrections;        /**< Reads that found the local copy off. */
+  int32_t last_offset_s;       /**< Chip minus local time at the last correction. */
+  uint32_t period_cycles;      /**< Current estimate of one SQW period. */
+  int32_t drift_ppm;           /**< DS1307 crystal against the core clock, mean over all edges. */
+} softclock_stats;
+
+/* starts the 1 Hz output and the resync task, after ds1307_init() and sched_init() */
+softclock_status softclock_init(void);
+
+/* SQW falling edge, called from the EXTI callback */
+void softclock_edge_isr(void);
+
+/* current time, callable from any context */
+softclock_status softclock_now(softclock_time *now);
+
+/* posts sig to task from every SQW edge while the time is valid, one task at most */
+void softclock_notify(sched_task_id task, uint16_t sig);
+
+/* drops the local copy until the chip has been read again, after setting the chip */
+void softclock_resync(void);
+
+/* reads the synchronisation statistics */
+void softclock_get_stats(softclock_stats *stats);
+
+/* prints the synchronisation statistics */
+void softclock_report(void);
+
+#endif /* INC_SOFTCLOCK_H_ */
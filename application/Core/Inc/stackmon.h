@@ -0,0 +1,33 @@
+/*
+ * stackmon.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_STACKMON_H_
+#define INC_STACKMON_H_
+
+#include "stm32f4xx_hal.h"
+
+/* Fill word of the MSP stack reservation, must match Reset_Handler. */
+#define STACKMON_PAINT  0xC5C5C5C5u
+
+/* Snapshot of the MSP stack, in bytes. */
+typedef struct {
+  uint32_t size;       /**< Reservation, _Min_Stack_Size. */
+  uint32_t used;       /**< Current depth. */
+  uint32_t high_water; /**< Deepest use since reset. */
+  uint8_t overflowed;  /**< The lowest word of the reservation was written. */
+} stackmon_stats;
+
+/* measures the MSP stack, scans the painted reservation */
+void stackmon_get(stackmon_stats *stats);
+
+/* deepest stack use since reset, in bytes */
+uint32_t stackmon_high_water(void);
+
+/* prints the stack use, the line the stack_check host tool takes with -m */
+void stackmon_report(void);
+
+#endif /* INC_STACKMON_H_ */
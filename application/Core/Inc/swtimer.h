@@ -0,0 +1,74 @@
+/*
+ * swtimer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_SWTIMER_H_
+#define INC_SWTIMER_H_
+
+#include "stm32f4xx_hal.h"
+
+/* Wheel geometry: SWTIMER_LEVELS wheels of 2^SWTIMER_SLOT_BITS slots each. */
+#define SWTIMER_SLOT_BITS   6u
+#define SWTIMER_SLOTS       (1u << SWTIMER_SLOT_BITS)
+#define SWTIMER_LEVELS      4u
+/* Longest delay that can be armed, in SysTick ticks (about 4.6 hours at 1 kHz). */
+#define SWTIMER_MAX_DELAY   ((1u << (SWTIMER_SLOT_BITS * SWTIMER_LEVELS)) - 1u)
+
+/* Status report for the functions. */
+typedef enum {
+  SWTIMER_OK           = 0x00u, /**< The action was successful. */
+  SWTIMER_ERROR_RANGE  = 0x01u, /**< The delay or period is longer than SWTIMER_MAX_DELAY. */
+  SWTIMER_ERROR        = 0xFFu  /**< Generic error. */
+} swtimer_status;
+
+typedef struct swtimer swtimer;
+
+/* Expiry callback, always called from thread context. */
+typedef void (*swtimer_callback)(swtimer *timer, void *arg);
+
+/* Intrusive list link, the timer lives in the slot it is linked into. */
+typedef struct swtimer_link {
+  struct swtimer_link *next;
+  struct swtimer_link *prev;
+} swtimer_link;
+
+/* Software timer, owned by the caller. Do not touch the fields directly. */
+struct swtimer {
+  swtimer_link link;         /**< Must stay first. */
+  uint32_t expires;          /**< Absolute tick of the next expiry. */
+  uint32_t period;           /**< Reload value, 0 for one-shot. */
+  swtimer_callback callback;
+  void *arg;
+};
+
+/* initializes the timer wheel */
+void swtimer_init(void);
+
+/* binds a callback to a timer, the timer starts stopped */
+void swtimer_setup(swtimer *timer, swtimer_callback callback, void *arg);
+
+/* arms a timer, period 0 makes it one-shot */
+swtimer_status swtimer_start(swtimer *timer, uint32_t delay, uint32_t period);
+
+/* disarms a timer, does nothing if it is not running */
+void swtimer_stop(swtimer *timer);
+
+/* tells whether a timer is armed */
+uint8_t swtimer_is_active(const swtimer *timer);
+
+/* current wheel time in ticks */
+uint32_t swtimer_now(void);
+
+/* advances time by one tick, called from SysTick_Handler */
+void swtimer_tick_isr(void);
+
+/* tells whether swtimer_process() has expiries to run */
+uint8_t swtimer_pending(void);
+
+/* runs every expired timer, called from thread context */
+void swtimer_process(void);
+
+#endif /* INC_SWTIMER_H_ */
@@ -0,0 +1,145 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_TRACE_H_
+#define INC_TRACE_H_
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * Event trace. Every event is one 8-byte record stamped with the DWT cycle
+ * counter, written inline into a RAM ring with interrupts masked for a
+ * handful of instructions. The ring keeps the newest TRACE_DEPTH events.
+ *
+ *   void EXTI0_IRQHandler(void)
+ *   {
+ *     trace_isr_enter();
+ *     ...
+ *     trace_isr_exit();
+ *   }
+ *
+ *   TRACE_MARK(3);                  instant marker, any id
+ *
+ * trace_dump_start() freezes the ring and trace_poll() prints it on the
+ * console for the trace_export host tool, which writes Chrome trace JSON
+ * (chrome://tracing, ui.perfetto.dev):
+ *
+ *   trace begin <core_hz> <count>
+ *   trace task <id> <name>          scheduler task names
+ *   #<cycles><arg><type><aux>...    hex, 8 bytes per record
+ *   trace end
+ *
+ * Build with TRACE_ENABLE 0 to compile all events out.
+ */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE         1
+#endif
+/* Records in the ring, a power of two. */
+#define TRACE_DEPTH          1024u
+/* Records per printed line, and lines printed by one trace_poll() call. */
+#define TRACE_PER_LINE       4u
+#define TRACE_LINES_PER_POLL 16u
+
+#if (TRACE_DEPTH & (TRACE_DEPTH - 1u)) != 0u
+#error "TRACE_DEPTH must be a power of two"
+#endif
+
+/* Record types, arg and aux as noted. */
+typedef enum {
+  TRACE_ISR_ENTER  = 0x01u, /**< arg: exception number. */
+  TRACE_ISR_EXIT   = 0x02u, /**< arg: exception number. */
+  TRACE_TASK_BEGIN = 0x03u, /**< arg: scheduler task id, aux: signal. */
+  TRACE_TASK_END   = 0x04u, /**< arg: scheduler task id. */
+  TRACE_USER_MARK  = 0x05u, /**< arg: marker id. */
+  TRACE_I2C_BEGIN  = 0x06u, /**< arg: 7-bit slave address. */
+  TRACE_I2C_END    = 0x07u, /**< arg: 7-bit slave address, aux: 1 on error. */
+  TRACE_UART_BEGIN = 0x08u, /**< arg: bytes written to the console. */
+  TRACE_UART_END   = 0x09u  /**< arg: bytes written to the console. */
+} trace_type;
+
+/* One event. */
+typedef struct {
+  uint32_t cycles;
+  uint16_t arg;
+  uint8_t type;
+  uint8_t aux;
+} trace_record;
+
+/* Ring state, written by trace_event() only. */
+extern trace_record trace_ring[TRACE_DEPTH];
+extern volatile uint32_t trace_head;
+extern volatile uint8_t trace_on;
+
+/* clears the ring and starts recording */
+void trace_init(void);
+
+/* stops recording and starts printing the ring, 0 if a dump is running */
+uint8_t trace_dump_start(void);
+
+/* prints the next lines of a dump, recording restarts after the last one */
+void trace_poll(void);
+
+/**
+ * @brief   Records one event, from any context.
+ * @param   type: trace_type.
+ * @param   arg:  Argument, see trace_type.
+ * @param   aux:  Extra byte, see trace_type.
+ * @return  void
+ */
+static inline void trace_event(uint8_t type, uint16_t arg, uint8_t aux)
+{
+#if TRACE_ENABLE
+  uint32_t primask;
+  trace_record *r;
+
+  if (0u == trace_on)
+  {
+    return;
+  }
+  primask = __get_PRIMASK();
+  __disable_irq();
+  r = &trace_ring[trace_head & (TRACE_DEPTH - 1u)];
+  trace_head = trace_head + 1u;
+  r->cycles = DWT->CYCCNT;
+  r->arg = arg;
+  r->type = type;
+  r->aux = aux;
+  __set_PRIMASK(primask);
+#else
+  (void)type;
+  (void)arg;
+  (void)aux;
+#endif
+}
+
+/**
+ * @brief   Records the entry of the running interrupt handler.
+ * @param   void
+ * @return  void
+ */
+static inline void trace_isr_enter(void)
+{
+#if TRACE_ENABLE
+  trace_event(TRACE_ISR_ENTER, (uint16_t)__get_IPSR(), 0u);
+#endif
+}
+
+/**
+ * @brief   Records the exit of the running interrupt handler.
+ * @param   void
+ * @return  void
+ */
+static inline void trace_isr_exit(void)
+{
+#if TRACE_ENABLE
+  trace_event(TRACE_ISR_EXIT, (uint16_t)__get_IPSR(), 0u);
+#endif
+}
+
+#define TRACE_MARK(id)  trace_event(TRACE_USER_MARK, (uint16_t)(id), 0u)
+
+#endif /* INC_TRACE_H_ */
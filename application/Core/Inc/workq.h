@@ -0,0 +1,70 @@
+/*
+ * workq.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#ifndef INC_WORKQ_H_
+#define INC_WORKQ_H_
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * Deferred work. An ISR hands the slow part of its job to workq_submit()
+ * and returns; the item runs later, most urgent level first.
+ *
+ * With WORKQ_USE_PENDSV 1 the items run inside PendSV, an interrupt at the
+ * lowest priority: they preempt the scheduler loop and every thread, so
+ * they must only call ISR-safe APIs, e.g. sched_post_isr() rather than
+ * sched_post(), and must not block or busy-wait, which stalls the loop and
+ * the threads for as long.
+ */
+/* Number of priority levels, 0 is the most urgent. */
+#define WORKQ_LEVELS       3u
+/* Items each level can hold, must be a power of two. */
+#define WORKQ_DEPTH        16u
+/* 1: items run from PendSV at the lowest interrupt priority.
+ * 0: items run from the scheduler loop in thread context. */
+#ifndef WORKQ_USE_PENDSV
+#define WORKQ_USE_PENDSV   1
+#endif
+
+/* Status report for the functions. */
+typedef enum {
+  WORKQ_OK           = 0x00u, /**< The action was successful. */
+  WORKQ_ERROR_FULL   = 0x01u, /**< The level has no room left, the item was dropped. */
+  WORKQ_ERROR_LEVEL  = 0x02u, /**< The level does not exist. */
+  WORKQ_ERROR        = 0xFFu  /**< Generic error. */
+} workq_status;
+
+/* Deferred work, gets the argument given at submit time. */
+typedef void (*workq_fn)(uint32_t arg);
+
+/* Enqueue to execution latency of one level, in core cycles. */
+typedef struct {
+  uint32_t runs;
+  uint32_t dropped;
+  uint32_t max_latency_cycles;
+  uint64_t total_latency_cycles;
+} workq_stats;
+
+/* initializes the work queues */
+void workq_init(void);
+
+/* defers fn(arg) at a priority level, callable from any ISR */
+workq_status workq_submit(uint8_t level, workq_fn fn, uint32_t arg);
+
+/* tells whether items are waiting */
+uint8_t workq_pending(void);
+
+/* runs every waiting item, most urgent level first */
+void workq_run(void);
+
+/* reads the statistics of one level */
+workq_status workq_get_stats(uint8_t level, workq_stats *stats);
+
+/* prints the latency of every level */
+void workq_report(void);
+
+#endif /* INC_WORKQ_H_ */
@@ -0,0 +1,245 @@
+/*
+ * crashdump.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "crashdump.h"
+#include <stddef.h>
+#include <stdio.h>
+
+extern uint32_t _estack; /* Symbol defined in the linker script */
+
+/* Stacking failed, the exception frame holds garbage. */
+#define CRASHDUMP_STKERR_Msk  (SCB_CFSR_MSTKERR_Msk | SCB_CFSR_STKERR_Msk)
+/* Words of the basic exception frame. */
+#define CRASHDUMP_FRAME_WORDS 8u
+
+/* Kept over the reset, valid when magic and check match. */
+static NOINIT crashdump_record dump;
+
+static uint32_t fault_stack[CRASHDUMP_STACK_SIZE / 4u] __attribute__((aligned(8)));
+uint32_t *const crashdump_stack_top = &fault_stack[CRASHDUMP_STACK_SIZE / 4u];
+
+static const char *const reason_names[] = {
+  "none", "hard fault", "memmanage fault", "bus fault", "usage fault", "Error_Handler"
+};
+
+/**
+ * @brief   Checksum of a dump, the complement of the sum of its words.
+ * @param   *d: Dump.
+ * @return  Value for d->check.
+ */
+static uint32_t crashdump_sum(const crashdump_record *d)
+{
+  const uint32_t *word = (const uint32_t *)d;
+  uint32_t sum = 0u;
+
+  for (uint32_t i = 0u; i < (offsetof(crashdump_record, check) / 4u); i++)
+  {
+    sum += word[i];
+  }
+  return ~sum;
+}
+
+/**
+ * @brief   Tells whether the RAM holds a dump record, pending or not.
+ *          After power-up it holds garbage.
+ * @param   void
+ * @return  1 if it does, 0 otherwise.
+ */
+static uint8_t crashdump_valid(void)
+{
+  return ((CRASHDUMP_MAGIC == dump.magic) && (crashdump_sum(&dump) == dump.check)) ? 1u : 0u;
+}
+
+/**
+ * @brief   Fills the common part of the dump: fault status, the count and
+ *          up to CRASHDUMP_STACK_WORDS words of stack from sp, bounded by
+ *          the end of RAM.
+ * @param   reason: What happened.
+ * @param   sp:     Stack pointer of the failing context.
+ * @return  void
+ */
+static void crashdump_store(crashdump_reason reason, uint32_t sp)
+{
+  uint32_t top = (uint32_t)&_estack;
+  uint32_t words = 0u;
+
+  dump.crashes = (0u != crashdump_valid()) ? (dump.crashes + 1u) : 1u;
+  dump.magic = CRASHDUMP_MAGIC;
+  dump.reason = reason;
+  dump.sp = sp;
+  dump.cfsr = SCB->CFSR;
+  dump.hfsr = SCB->HFSR;
+  dump.mmfar = SCB->MMFAR;
+  dump.bfar = SCB->BFAR;
+
+  if ((SRAM1_BASE <= sp) && (top > sp) && (0u == (sp & 3u)))
+  {
+    words = (top - sp) / 4u;
+    words = (CRASHDUMP_STACK_WORDS < words) ? CRASHDUMP_STACK_WORDS : words;
+  }
+  for (uint32_t i = 0u; i < CRASHDUMP_STACK_WORDS; i++)
+  {
+    dump.stack[i] = (i < words) ? ((const uint32_t *)sp)[i] : 0u;
+  }
+  dump.stack_words = words;
+}
+
+/**
+ * @brief   Enables the configurable fault handlers, without it every fault
+ *          escalates to HardFault and loses its own status bits.
+ * @param   void
+ * @return  void
+ */
+void crashdump_init(void)
+{
+  SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk | SCB_SHCSR_USGFAULTENA_Msk;
+}
+
+/**
+ * @brief   Prints the reset cause and, if the last run ended in a fault,
+ *          its dump. The dump is then marked reported, its crash count
+ *          stays. Call once the console UART is up.
+ * @param   void
+ * @return  crashdump_reason of the dump printed, 0 if there was none.
+ */
+uint32_t crashdump_check(void)
+{
+  uint32_t csr = RCC->CSR;
+  uint32_t reason;
+
+  printf("reset:%s%s%s%s%s%s%s\n",
+         (0u != (csr & RCC_CSR_PORRSTF)) ? " power-on" : "",
+         (0u != (csr & RCC_CSR_BORRSTF)) ? " brown-out" : "",
+         (0u != (csr & RCC_CSR_PINRSTF)) ? " pin" : "",
+         (0u != (csr & RCC_CSR_SFTRSTF)) ? " software" : "",
+         (0u != (csr & RCC_CSR_IWDGRSTF)) ? " iwdg" : "",
+         (0u != (csr & RCC_CSR_WWDGRSTF)) ? " wwdg" : "",
+         (0u != (csr & RCC_CSR_LPWRRSTF)) ? " low-power" : "");
+  RCC->CSR |= RCC_CSR_RMVF;
+
+  /* The flags say power-on for a cold start, the RAM is random then. */
+  if ((0u == crashdump_valid()) || (0u != (csr & (RCC_CSR_PORRSTF | RCC_CSR_BORRSTF))))
+  {
+    dump.magic = 0u;
+    return 0u;
+  }
+  if (0u == dump.reason)
+  {
+    return 0u;
+  }
+
+  printf("crash %lu: %s pc 0x%08lx lr 0x%08lx sp 0x%08lx xpsr 0x%08lx\n",
+         (unsigned long)dump.crashes,
+         reason_names[(dump.reason <= CRASHDUMP_ERROR) ? dump.reason : 0u],
+         (unsigned long)dump.pc, (unsigned long)dump.lr, (unsigned long)dump.sp, (unsigned long)dump.xpsr);
+  printf("  r0 0x%08lx r1 0x%08lx r2 0x%08lx r3 0x%08lx r12 0x%08lx\n",
+         (unsigned long)dump.r0, (unsigned long)dump.r1, (unsigned long)dump.r2,
+         (unsigned long)dump.r3, (unsigned long)dump.r12);
+  printf("  cfsr 0x%08lx hfsr 0x%08lx mmfar 0x%08lx bfar 0x%08lx exc_return 0x%08lx\n",
+         (unsigned long)dump.cfsr, (unsigned long)dump.hfsr, (unsigned long)dump.mmfar,
+         (unsigned long)dump.bfar, (unsigned long)dump.exc_return);
+  for (uint32_t i = 0u; i < dump.stack_words; i += 4u)
+  {
+    printf("  0x%08lx:", (unsigned long)(dump.sp + (4u * i)));
+    for (uint32_t j = i; (j < dump.stack_words) && (j < (i + 4u)); j++)
+    {
+      printf(" %08lx", (unsigned long)dump.stack[j]);
+    }
+    printf("\n");
+  }
+
+  reason = dump.reason;
+  dump.reason = 0u;
+  dump.check = crashdump_sum(&dump);
+  return reason;
+}
+
+/**
+ * @brief   Stores the dump of a fault and resets. Runs on the fault stack
+ *          with the MPU off, so an overflowed stack or a guard can be read.
+ * @param   *frame:     Exception frame, on the stack that was in use.
+ * @param   exc_return: EXC_RETURN of the fault.
+ * @param   reason:     Which handler was entered.
+ * @return  Does not return.
+ */
+void crashdump_fault(const uint32_t *frame, uint32_t exc_return, crashdump_reason reason)
+{
+  __disable_irq();
+  ARM_MPU_Disable();
+
+  crashdump_store(reason, (uint32_t)frame);
+  dump.exc_return = exc_return;
+  if ((0u == (dump.cfsr & CRASHDUMP_STKERR_Msk)) && (CRASHDUMP_FRAME_WORDS <= dump.stack_words))
+  {
+    dump.r0 = frame[0];
+    dump.r1 = frame[1];
+    dump.r2 = frame[2];
+    dump.r3 = frame[3];
+    dump.r12 = frame[4];
+    dump.lr = frame[5];
+    dump.pc = frame[6];
+    dump.xpsr = frame[7];
+  }
+  else
+  {
+    dump.r0 = dump.r1 = dump.r2 = dump.r3 = dump.r12 = 0u;
+    dump.lr = dump.pc = dump.xpsr = 0u;
+  }
+  dump.check = crashdump_sum(&dump);
+
+  __DSB();
+  NVIC_SystemReset();
+}
+
+/**
+ * @brief   Stores the dump of a failed initialisation or HAL call and resets.
+ * @param   pc: Return address of Error_Handler(), the failing call site.
+ * @return  Does not return.
+ */
+void crashdump_error(uint32_t pc)
+{
+  uint32_t sp = (0u != (__get_CONTROL() & CONTROL_SPSEL_Msk)) ? __get_PSP() : __get_MSP();
+
+  __disable_irq();
+  crashdump_store(CRASHDUMP_ERROR, sp);
+  dump.r0 = dump.r1 = dump.r2 = dump.r3 = dump.r12 = 0u;
+  dump.lr = 0u;
+  dump.pc = pc;
+  dump.xpsr = __get_xPSR();
+  dump.exc_return = 0u;
+  dump.check = crashdump_sum(&dump);
+
+  __DSB();
+  NVIC_SystemReset();
+}
+
+/**
+ * Fault handlers. Naked: the frame is picked from MSP or PSP before any
+ * push, then the MSP moves to the fault stack, the faulting one may have
+ * overflowed. reason is a crashdump_reason value.
+ */
+#define CRASHDUMP_HANDLER(name, reason)                  \
+  __attribute__((naked)) void name(void)                 \
+  {                                                      \
+    __ASM volatile (                                     \
+      "   tst     lr, #4                      \n"        \
+      "   ite     eq                          \n"        \
+      "   mrseq   r0, msp                     \n"        \
+      "   mrsne   r0, psp                     \n"        \
+      "   mov     r1, lr                      \n"        \
+      "   movs    r2, #" #reason "            \n"        \
+      "   ldr     r3, =crashdump_stack_top    \n"        \
+      "   ldr     r3, [r3]                    \n"        \
+      "   msr     msp, r3                     \n"        \
+      "   b       crashdump_fault             \n"        \
+      "   .ltorg                              \n"        \
+    );                                                   \
+  }
+
+CRASHDUMP_HANDLER(HardFault_Handler, 1)
+CRASHDUMP_HANDLER(BusFault_Handler, 3)
+CRASHDUMP_HANDLER(UsageFault_Handler, 4)
@@ -0,0 +1,157 @@
+/*
+ * epoch.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "epoch.h"
+
+/* Leap days from year 1 up to and including year y. */
+#define EPOCH_LEAPS(y)   (((y) / 4u) - ((y) / 100u) + ((y) / 400u))
+/* Days from 1970-01-01 to January 1st of year 1970 + i. */
+#define EPOCH_YS(i)      (365u * (i) + EPOCH_LEAPS(EPOCH_BASE_YEAR - 1u + (i)) - EPOCH_LEAPS(EPOCH_BASE_YEAR - 1u))
+#define EPOCH_YS2(i)     EPOCH_YS(i), EPOCH_YS((i) + 1u)
+#define EPOCH_YS4(i)     EPOCH_YS2(i), EPOCH_YS2((i) + 2u)
+#define EPOCH_YS8(i)     EPOCH_YS4(i), EPOCH_YS4((i) + 4u)
+#define EPOCH_YS16(i)    EPOCH_YS8(i), EPOCH_YS8((i) + 8u)
+#define EPOCH_YS32(i)    EPOCH_YS16(i), EPOCH_YS16((i) + 16u)
+#define EPOCH_YS64(i)    EPOCH_YS32(i), EPOCH_YS32((i) + 32u)
+#define EPOCH_YS128(i)   EPOCH_YS64(i), EPOCH_YS64((i) + 64u)
+
+/* Years in the table: 1970 to 2107, one past the last year epoch_t reaches. */
+#define EPOCH_YEARS      138u
+
+_Static_assert(EPOCH_YS(30u) == 10957u, "2000-01-01 is day 10957");
+_Static_assert(EPOCH_YS(EPOCH_YEARS - 1u) <= UINT16_MAX, "year starts must fit in 16 bits");
+
+/* Start of every year, the leap years show as 366-day gaps. */
+static const uint16_t year_start[EPOCH_YEARS] = {
+  EPOCH_YS128(0u), EPOCH_YS8(128u), EPOCH_YS2(136u)
+};
+
+/* Start of every month within the year, [leap][month - 1], plus the year length. */
+static const uint16_t month_start[2][13] = {
+  {0u, 31u, 59u, 90u, 120u, 151u, 181u, 212u, 243u, 273u, 304u, 334u, 365u},
+  {0u, 31u, 60u, 91u, 121u, 152u, 182u, 213u, 244u, 274u, 305u, 335u, 366u}
+};
+
+/**
+ * @brief   Tells whether a year has a February 29th.
+ * @param   year: Year, any value.
+ * @return  1 if it is a leap year, 0 otherwise.
+ */
+uint8_t epoch_is_leap(uint16_t year)
+{
+  return (uint8_t)(((0u == (year % 4u)) && (0u != (year % 100u))) || (0u == (year % 400u)));
+}
+
+/**
+ * @brief   Converts a date to a day number.
+ * @param   year:  Year, 1970 to 2106.
+ * @param   month: Month, 1 to 12.
+ * @param   date:  Day of month, 1 to 31.
+ * @return  Days since 1970-01-01.
+ */
+uint32_t epoch_days_from_civil(uint16_t year, uint8_t month, uint8_t date)
+{
+  uint32_t idx = (uint32_t)year - EPOCH_BASE_YEAR;
+  uint32_t leap = (uint32_t)(year_start[idx + 1u] - year_start[idx]) - 365u;
+
+  return year_start[idx] + month_start[leap][month - 1u] + date - 1u;
+}
+
+/**
+ * @brief   Converts a day number to a date.
+ * @param   days:   Days since 1970-01-01, up to 49709 (2106-02-06).
+ * @param   *year:  Receives the year.
+ * @param   *month: Receives the month, 1 to 12.
+ * @param   *date:  Receives the day of month, 1 to 31.
+ * @return  void
+ */
+void epoch_civil_from_days(uint32_t days, uint16_t *year, uint8_t *month, uint8_t *date)
+{
+  /* 1461 days per 4 years, the estimate is off by at most one year either way. */
+  uint32_t idx = ((days * 4u) + 2u) / 1461u;
+  uint32_t doy;
+  uint32_t leap;
+  uint32_t m;
+
+  idx -= (uint32_t)(days < year_start[idx]);
+  idx += (uint32_t)(days >= year_start[idx + 1u]);
+  doy = days - year_start[idx];
+  leap = (uint32_t)(year_start[idx + 1u] - year_start[idx]) - 365u;
+
+  /* Months are 28 to 31 days long, so doy / 32 is the month or the one before. */
+  m = doy >> 5;
+  m += (uint32_t)(doy >= month_start[leap][m + 1u]);
+
+  *year = (uint16_t)(EPOCH_BASE_YEAR + idx);
+  *month = (uint8_t)(m + 1u);
+  *date = (uint8_t)(doy - month_start[leap][m] + 1u);
+}
+
+/**
+ * @brief   Gives the weekday of a day number.
+ * @param   days: Days since 1970-01-01.
+ * @return  Weekday, 0 is Sunday.
+ */
+uint8_t epoch_weekday(uint32_t days)
+{
+  /* 1970-01-01 was a Thursday. */
+  return (uint8_t)((days + 4u) % 7u);
+}
+
+/**
+ * @brief   Converts a broken-down time to Unix time.
+ * @param   *civil: Time to convert, weekday is ignored.
+ * @return  Seconds since 1970-01-01 00:00:00.
+ */
+epoch_t epoch_from_civil(const epoch_civil *civil)
+{
+  uint32_t days = epoch_days_from_civil(civil->year, civil->month, civil->date);
+
+  return (days * EPOCH_SECS_PER_DAY) + ((uint32_t)civil->hours * 3600u) +
+         ((uint32_t)civil->minutes * 60u) + civil->seconds;
+}
+
+/**
+ * @brief   Converts Unix time to a broken-down time.
+ * @param   t:      Seconds since 1970-01-01 00:00:00.
+ * @param   *civil: Receives the time, weekday included.
+ * @return  void
+ */
+void epoch_to_civil(epoch_t t, epoch_civil *civil)
+{
+  uint32_t days = t / EPOCH_SECS_PER_DAY;
+  uint32_t sod = t - (days * EPOCH_SECS_PER_DAY);
+  uint32_t hours = sod / 3600u;
+  uint32_t rest = sod - (hours * 3600u);
+  uint32_t minutes = rest / 60u;
+
+  epoch_civil_from_days(days, &civil->year, &civil->month, &civil->date);
+  civil->hours = (uint8_t)hours;
+  civil->minutes = (uint8_t)minutes;
+  civil->seconds = (uint8_t)(rest - (minutes * 60u));
+  civil->weekday = epoch_weekday(days);
+}
+
+/**
+ * @brief   Converts a time zone as stored in DS1307_REG_UTC_HR/MIN to an
+ *          offset in seconds, local time minus UTC. The minutes take the
+ *          sign of the hour, so -3 and 30 is UTC-03:30.
+ * @param   hour:   Hours east of UTC, -12 to 14.
+ * @param   minute: Extra minutes, 0 to 59.
+ * @return  Offset in seconds.
+ */
+int32_t epoch_tz_offset(int8_t hour, uint8_t minute)
+{
+  int32_t offset = ((int32_t)hour * 3600) + ((int32_t)minute * 60);
+
+  if (hour < 0)
+  {
+    offset -= 2 * (int32_t)minute * 60;
+  }
+
+  return offset;
+}
@@ -6,6 +6,8 @@
  */
 
 #include "flash.h"
+#include "nvstore.h"
+#include "prof.h"
 
 /* Function pointer for jumping to user application. */
 typedef void (*fnc_ptr)(void);
@@ -17,6 +19,8 @@ typedef void (*fnc_ptr)(void);
  */
 flash_status flash_erase(uint32_t address)
 {
+  /* Write-ahead: a reset during the erase leaves the marker set. Length 0 is "to the end". */
+  (void)nvstore_flash_mark(NVSTORE_FLASH_ERASING, address, 0u);
   HAL_FLASH_Unlock();
 
   flash_status status = FLASH_ERROR;
@@ -35,6 +39,10 @@ flash_status flash_erase(uint32_t address)
   }
 
   HAL_FLASH_Lock();
+  if (FLASH_OK == status)
+  {
+    (void)nvstore_flash_mark(NVSTORE_FLASH_IDLE, 0u, 0u);
+  }
 
   return status;
 }
@@ -48,8 +56,10 @@ flash_status flash_erase(uint32_t address)
  */
 flash_status flash_write(uint32_t address, uint32_t *data, uint32_t length)
 {
+  PROF_SCOPE(flash_write);
   flash_status status = FLASH_OK;
 
+  (void)nvstore_flash_mark(NVSTORE_FLASH_WRITING, address, length * 4u);
   HAL_FLASH_Unlock();
 
   /* Loop through the array. */
@@ -79,6 +89,10 @@ flash_status flash_write(uint32_t address, uint32_t *data, uint32_t length)
   }
 
   HAL_FLASH_Lock();
+  if (FLASH_OK == status)
+  {
+    (void)nvstore_flash_mark(NVSTORE_FLASH_IDLE, 0u, 0u);
+  }
 
   return status;
 }
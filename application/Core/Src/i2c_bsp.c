@@ -18,31 +18,333 @@
 
 /* Includes ----------------------------------------------------------- */
 #include "i2c_bsp.h"
+#include "cycles.h"
 
 /* Private defines ---------------------------------------------------- */
 /* Private enumerate/structure ---------------------------------------- */
 /* Private macros ----------------------------------------------------- */
 /* Public variables --------------------------------------------------- */
 /* Private variables -------------------------------------------------- */
+static bsp_i2c_bus *buses[BSP_I2C_MAX_BUSES];
+
 /* Private function prototypes ---------------------------------------- */
+static bsp_i2c_bus *bsp_i2c_find_bus(I2C_HandleTypeDef *hi2c);
+static HAL_StatusTypeDef bsp_i2c_start(bsp_i2c_bus *bus);
+static HAL_StatusTypeDef bsp_i2c_start_phase(bsp_i2c_bus *bus);
+static void bsp_i2c_complete(bsp_i2c_bus *bus, uint8_t status);
+static void bsp_i2c_release(I2C_HandleTypeDef *hi2c);
+
 /* Function definitions ----------------------------------------------- */
-uint8_t bsp_i2c_transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, packet data){
-	HAL_StatusTypeDef status = HAL_I2C_Master_Transmit(hi2c, DevAddress, data.data, data.length, HAL_MAX_DELAY);
+uint8_t bsp_i2c_transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, const packet *data){
+	HAL_StatusTypeDef status = HAL_I2C_Master_Transmit(hi2c, DevAddress, data->data, data->length, bsp_i2c_timeout_ms(hi2c, data->length));
 	if (status == HAL_OK) {
 		return I2C_SUCCESS;
 	}
-	else {
-		return I2C_ERROR;
+	if (status != HAL_ERROR) {
+		/* timeout or busy, not a NACK: a slave holds the bus */
+		bsp_i2c_recover(hi2c);
 	}
+	return I2C_ERROR;
 }
 
-uint8_t bsp_i2c_receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, packet data){
-	HAL_StatusTypeDef status = HAL_I2C_Master_Receive(hi2c, DevAddress, data.data, data.length, HAL_MAX_DELAY);
+uint8_t bsp_i2c_receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, const packet *data){
+	HAL_StatusTypeDef status = HAL_I2C_Master_Receive(hi2c, DevAddress, data->data, data->length, bsp_i2c_timeout_ms(hi2c, data->length));
 	if (status == HAL_OK) {
 		return I2C_SUCCESS;
 	}
+	if (status != HAL_ERROR) {
+		bsp_i2c_recover(hi2c);
+	}
+	return I2C_ERROR;
+}
+
+uint8_t bsp_i2c_bus_init(bsp_i2c_bus *bus, I2C_HandleTypeDef *hi2c){
+	bus->hi2c = hi2c;
+	bus->head = NULL;
+	bus->tail = NULL;
+	bus->scl_port = NULL;
+	bus->sda_port = NULL;
+	bus->recoveries = 0;
+	cycles_init();
+	for (uint8_t i = 0; i < BSP_I2C_MAX_BUSES; i++) {
+		if ((buses[i] == NULL) || (buses[i]->hi2c == hi2c)) {
+			buses[i] = bus;
+			return I2C_SUCCESS;
+		}
+	}
+	return I2C_ERROR;
+}
+
+uint8_t bsp_i2c_submit(bsp_i2c_bus *bus, bsp_i2c_xfer *xfer){
+	uint8_t idle;
+	uint32_t primask;
+
+	xfer->status = I2C_PENDING;
+	xfer->phase = 0;
+	xfer->next = NULL;
+
+	/* the queue is also advanced from the completion interrupts */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	idle = (bus->head == NULL);
+	if (idle) {
+		bus->head = xfer;
+	}
 	else {
+		bus->tail->next = xfer;
+	}
+	bus->tail = xfer;
+	__set_PRIMASK(primask);
+
+	if (idle && (bsp_i2c_start(bus) != HAL_OK)) {
+		bsp_i2c_complete(bus, I2C_ERROR);
 		return I2C_ERROR;
 	}
+	return I2C_SUCCESS;
+}
+
+uint8_t bsp_i2c_busy(const bsp_i2c_bus *bus){
+	return (bus->head != NULL);
+}
+
+uint8_t bsp_i2c_wait(const bsp_i2c_xfer *xfer){
+	while (xfer->status == I2C_PENDING) {
+		bsp_i2c_poll();
+		if (xfer->status == I2C_PENDING) {
+			__WFI();
+		}
+	}
+	return xfer->status;
+}
+
+void bsp_i2c_set_recovery_pins(bsp_i2c_bus *bus, GPIO_TypeDef *scl_port, uint16_t scl_pin, GPIO_TypeDef *sda_port, uint16_t sda_pin){
+	bus->scl_port = scl_port;
+	bus->scl_pin = scl_pin;
+	bus->sda_port = sda_port;
+	bus->sda_pin = sda_pin;
+}
+
+uint32_t bsp_i2c_timeout_ms(const I2C_HandleTypeDef *hi2c, uint32_t length){
+	/* 9 bits per byte with two address bytes, START, repeated START and STOP */
+	uint32_t bits = ((length + 2) * 9) + 3;
+	uint32_t clock = (hi2c->Init.ClockSpeed != 0) ? hi2c->Init.ClockSpeed : 100000;
+
+	return ((bits * 1000) + clock - 1) / clock + BSP_I2C_TIMEOUT_SLACK_MS;
+}
+
+void bsp_i2c_recover(I2C_HandleTypeDef *hi2c){
+	(void)HAL_I2C_DeInit(hi2c);
+	bsp_i2c_release(hi2c);
+}
+
+void bsp_i2c_poll(void){
+	for (uint8_t i = 0; i < BSP_I2C_MAX_BUSES; i++) {
+		bsp_i2c_bus *bus = buses[i];
+		uint8_t expired;
+		uint32_t primask;
+
+		if (bus == NULL) {
+			continue;
+		}
+		primask = __get_PRIMASK();
+		__disable_irq();
+		expired = (bus->head != NULL) && ((int32_t)(HAL_GetTick() - bus->head->deadline) > 0);
+		if (expired) {
+			/* no completion interrupt can race with the recovery after this */
+			(void)HAL_I2C_DeInit(bus->hi2c);
+		}
+		__set_PRIMASK(primask);
+
+		if (expired) {
+			bsp_i2c_release(bus->hi2c);
+			bsp_i2c_complete(bus, I2C_ERROR);
+		}
+	}
+}
+
+/**
+ * @brief  <find the engine attached to a HAL handle>
+ */
+static bsp_i2c_bus *bsp_i2c_find_bus(I2C_HandleTypeDef *hi2c){
+	for (uint8_t i = 0; i < BSP_I2C_MAX_BUSES; i++) {
+		if ((buses[i] != NULL) && (buses[i]->hi2c == hi2c)) {
+			return buses[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief  <put the head transaction on the bus and arm its deadline>
+ */
+static HAL_StatusTypeDef bsp_i2c_start(bsp_i2c_bus *bus){
+	bsp_i2c_xfer *xfer = bus->head;
+	HAL_StatusTypeDef status;
+
+	if (xfer->phase == 0) {
+		xfer->deadline = HAL_GetTick() + bsp_i2c_timeout_ms(bus->hi2c, (uint32_t)xfer->tx.length + xfer->rx.length);
+	}
+	status = bsp_i2c_start_phase(bus);
+	if (status == HAL_BUSY) {
+		/* the line stayed busy, leave the transaction queued for bsp_i2c_poll() to recover */
+		xfer->deadline = HAL_GetTick();
+		return HAL_OK;
+	}
+	return status;
+}
+
+/**
+ * @brief  <hand the current phase of the head transaction to the HAL, DMA if linked and long enough>
+ */
+static HAL_StatusTypeDef bsp_i2c_start_phase(bsp_i2c_bus *bus){
+	I2C_HandleTypeDef *hi2c = bus->hi2c;
+	bsp_i2c_xfer *xfer = bus->head;
+	uint8_t tx_dma = (hi2c->hdmatx != NULL) && (xfer->tx.length >= BSP_I2C_DMA_MIN);
+	uint8_t rx_dma = (hi2c->hdmarx != NULL) && (xfer->rx.length >= BSP_I2C_DMA_MIN);
+
+	switch (xfer->op) {
+	case BSP_I2C_OP_WRITE:
+		return tx_dma ? HAL_I2C_Master_Transmit_DMA(hi2c, xfer->address, xfer->tx.data, xfer->tx.length)
+					  : HAL_I2C_Master_Transmit_IT(hi2c, xfer->address, xfer->tx.data, xfer->tx.length);
+	case BSP_I2C_OP_READ:
+		return rx_dma ? HAL_I2C_Master_Receive_DMA(hi2c, xfer->address, xfer->rx.data, xfer->rx.length)
+					  : HAL_I2C_Master_Receive_IT(hi2c, xfer->address, xfer->rx.data, xfer->rx.length);
+	case BSP_I2C_OP_WRITE_READ:
+		/* no STOP after the first frame, the read phase starts with a repeated start */
+		if (xfer->phase == 0) {
+			return tx_dma ? HAL_I2C_Master_Seq_Transmit_DMA(hi2c, xfer->address, xfer->tx.data, xfer->tx.length, I2C_FIRST_FRAME)
+						  : HAL_I2C_Master_Seq_Transmit_IT(hi2c, xfer->address, xfer->tx.data, xfer->tx.length, I2C_FIRST_FRAME);
+		}
+		return rx_dma ? HAL_I2C_Master_Seq_Receive_DMA(hi2c, xfer->address, xfer->rx.data, xfer->rx.length, I2C_LAST_FRAME)
+					  : HAL_I2C_Master_Seq_Receive_IT(hi2c, xfer->address, xfer->rx.data, xfer->rx.length, I2C_LAST_FRAME);
+	default:
+		return HAL_ERROR;
+	}
+}
+
+/**
+ * @brief  <retire the head transaction, start the next one, then notify>
+ */
+static void bsp_i2c_complete(bsp_i2c_bus *bus, uint8_t status){
+	uint32_t primask;
+
+	do {
+		bsp_i2c_xfer *done;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+		done = bus->head;
+		bus->head = done->next;
+		if (bus->head == NULL) {
+			bus->tail = NULL;
+		}
+		__set_PRIMASK(primask);
+
+		done->status = status;
+		/* keep the bus busy before spending time in the callback */
+		status = I2C_SUCCESS;
+		if ((bus->head != NULL) && (bsp_i2c_start(bus) != HAL_OK)) {
+			status = I2C_ERROR;
+		}
+		if (done->callback != NULL) {
+			done->callback(done);
+		}
+	} while ((status == I2C_ERROR) && (bus->head != NULL));
+}
+
+/**
+ * @brief  <clock a stuck slave free, send a STOP and restart the peripheral>
+ */
+static void bsp_i2c_release(I2C_HandleTypeDef *hi2c){
+	bsp_i2c_bus *bus = bsp_i2c_find_bus(hi2c);
+
+	if ((bus != NULL) && (bus->scl_port != NULL)) {
+		GPIO_InitTypeDef gpio = {0};
+		uint32_t clock = (hi2c->Init.ClockSpeed != 0) ? hi2c->Init.ClockSpeed : 100000;
+		uint32_t half = SystemCoreClock / (2 * clock);
+		uint32_t start;
+
+		/* open drain outputs released high, the HAL init gives them back to the peripheral */
+		HAL_GPIO_WritePin(bus->scl_port, bus->scl_pin, GPIO_PIN_SET);
+		HAL_GPIO_WritePin(bus->sda_port, bus->sda_pin, GPIO_PIN_SET);
+		gpio.Mode = GPIO_MODE_OUTPUT_OD;
+		gpio.Pull = GPIO_PULLUP;
+		gpio.Speed = GPIO_SPEED_FREQ_LOW;
+		gpio.Pin = bus->scl_pin;
+		HAL_GPIO_Init(bus->scl_port, &gpio);
+		gpio.Pin = bus->sda_pin;
+		HAL_GPIO_Init(bus->sda_port, &gpio);
+
+		/* each phase below is half an SCL period */
+		for (uint8_t i = 0; i < (2 * BSP_I2C_RECOVERY_PULSES) + 4; i++) {
+			if (i < 2 * BSP_I2C_RECOVERY_PULSES) {
+				HAL_GPIO_WritePin(bus->scl_port, bus->scl_pin, ((i & 1) != 0) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+			}
+			else {
+				/* STOP: SCL low, SDA low, SCL high, then SDA rises */
+				static const uint8_t stop_scl[4] = {0, 0, 1, 1};
+				static const uint8_t stop_sda[4] = {1, 0, 0, 1};
+				uint8_t step = i - (2 * BSP_I2C_RECOVERY_PULSES);
+
+				HAL_GPIO_WritePin(bus->scl_port, bus->scl_pin, stop_scl[step] ? GPIO_PIN_SET : GPIO_PIN_RESET);
+				HAL_GPIO_WritePin(bus->sda_port, bus->sda_pin, stop_sda[step] ? GPIO_PIN_SET : GPIO_PIN_RESET);
+			}
+			start = cycles_now();
+			while ((cycles_now() - start) < half) {
+			}
+		}
+	}
+	(void)HAL_I2C_Init(hi2c);
+	if (bus != NULL) {
+		bus->recoveries++;
+	}
+}
+
+/**
+ * @brief  <HAL hook: transmit part finished>
+ */
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c){
+	bsp_i2c_bus *bus = bsp_i2c_find_bus(hi2c);
+
+	if ((bus == NULL) || (bus->head == NULL)) {
+		return;
+	}
+	if ((bus->head->op == BSP_I2C_OP_WRITE_READ) && (bus->head->phase == 0)) {
+		bus->head->phase = 1;
+		if (bsp_i2c_start(bus) != HAL_OK) {
+			bsp_i2c_complete(bus, I2C_ERROR);
+		}
+		return;
+	}
+	bsp_i2c_complete(bus, I2C_SUCCESS);
+}
+
+/**
+ * @brief  <HAL hook: receive part finished>
+ */
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c){
+	bsp_i2c_bus *bus = bsp_i2c_find_bus(hi2c);
+
+	if ((bus != NULL) && (bus->head != NULL)) {
+		bsp_i2c_complete(bus, I2C_SUCCESS);
+	}
+}
+
+/**
+ * @brief  <HAL hook: NACK, arbitration loss, bus error or DMA error>
+ */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c){
+	bsp_i2c_bus *bus = bsp_i2c_find_bus(hi2c);
+
+	if ((bus != NULL) && (bus->head != NULL)) {
+		bsp_i2c_complete(bus, I2C_ERROR);
+	}
+}
+
+/**
+ * @brief  <HAL hook: transfer aborted>
+ */
+void HAL_I2C_AbortCpltCallback(I2C_HandleTypeDef *hi2c){
+	HAL_I2C_ErrorCallback(hi2c);
 }
 /* End of file -------------------------------------------------------- */
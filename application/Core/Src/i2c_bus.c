@@ -0,0 +1,468 @@
+/*
+ * i2c_bus.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "i2c_bus.h"
+#include "cycles.h"
+#include "pool.h"
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+/* A posted write: the request and a copy of the bytes share one pool block. */
+typedef struct {
+  i2c_request req;
+  uint8_t data[];
+} i2c_posted;
+
+static void i2c_bus_dispatch(i2c_bus *bus);
+static void i2c_bus_done(bsp_i2c_xfer *xfer);
+
+/**
+ * @brief   Takes ownership of an initialized I2C handle. Every transfer on
+ *          this peripheral must go through the manager from now on.
+ * @param   *bus:  Manager state, owned by the caller.
+ * @param   *hi2c: Handle configured by MX_I2Cx_Init().
+ * @return  status: Report about the success of the initialization.
+ */
+i2c_bus_status i2c_bus_init(i2c_bus *bus, I2C_HandleTypeDef *hi2c)
+{
+  cycles_init();
+
+  bus->pending = NULL;
+  bus->active = NULL;
+  bus->queued = NULL;
+  bus->devices = NULL;
+  bus->last = NULL;
+  bus->batch = 0u;
+
+  if (I2C_SUCCESS != bsp_i2c_bus_init(&bus->engine, hi2c))
+  {
+    return I2C_BUS_ERROR;
+  }
+
+  return I2C_BUS_OK;
+}
+
+/**
+ * @brief   Attaches a device to a bus and clears its statistics.
+ * @param   *dev:    Device, owned by its driver.
+ * @param   *bus:    Bus the device sits on.
+ * @param   *name:   Label printed in the report.
+ * @param   address: 7-bit slave address.
+ * @return  void
+ */
+void i2c_device_init(i2c_device *dev, i2c_bus *bus, const char *name, uint16_t address)
+{
+  uint32_t primask;
+
+  dev->bus = bus;
+  dev->name = name;
+  dev->address = address;
+  dev->stats = (i2c_device_stats){0};
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  dev->next = bus->devices;
+  bus->devices = dev;
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Fills a request for a device. With tx only it writes, with rx
+ *          only it reads, with both it writes then reads after a repeated
+ *          start. callback and context are cleared.
+ * @param   *req:   Request to fill.
+ * @param   *dev:   Target device.
+ * @param   *tx:    Bytes to write, NULL if none.
+ * @param   tx_len: Number of bytes to write.
+ * @param   *rx:    Buffer for the bytes read, NULL if none.
+ * @param   rx_len: Number of bytes to read.
+ * @return  void
+ */
+void i2c_request_setup(i2c_request *req, i2c_device *dev, uint8_t *tx, uint16_t tx_len,
+                       uint8_t *rx, uint16_t rx_len)
+{
+  req->dev = dev;
+  req->callback = NULL;
+  req->context = NULL;
+  req->status = I2C_BUS_OK;
+
+  req->xfer.address = (uint16_t)(dev->address << 1);
+  req->xfer.tx.data = tx;
+  req->xfer.tx.length = (NULL != tx) ? tx_len : 0u;
+  req->xfer.rx.data = rx;
+  req->xfer.rx.length = (NULL != rx) ? rx_len : 0u;
+  if (0u == req->xfer.rx.length)
+  {
+    req->xfer.op = BSP_I2C_OP_WRITE;
+  }
+  else if (0u == req->xfer.tx.length)
+  {
+    req->xfer.op = BSP_I2C_OP_READ;
+  }
+  else
+  {
+    req->xfer.op = BSP_I2C_OP_WRITE_READ;
+  }
+  req->xfer.callback = i2c_bus_done;
+  req->xfer.context = req;
+}
+
+/**
+ * @brief   Queues a request. It is handed to the engine when it is the
+ *          most urgent one waiting at the time a slot frees up.
+ * @param   *req:        Request filled by i2c_request_setup().
+ * @param   prio:        Priority, 0 is the most urgent.
+ * @param   deadline_ms: Time from now the request should be done by, or
+ *                       I2C_BUS_NO_DEADLINE. Only orders the queue and
+ *                       counts misses, late requests still run.
+ * @return  status: Report about the success of the submission.
+ */
+i2c_bus_status i2c_bus_submit(i2c_request *req, uint8_t prio, uint32_t deadline_ms)
+{
+  i2c_bus *bus;
+  uint32_t primask;
+
+  if ((NULL == req->dev) || ((0u == req->xfer.tx.length) && (0u == req->xfer.rx.length)))
+  {
+    return I2C_BUS_ERROR_PARAM;
+  }
+  bus = req->dev->bus;
+
+  req->prio = prio;
+  req->has_deadline = (I2C_BUS_NO_DEADLINE != deadline_ms) ? 1u : 0u;
+  req->deadline = HAL_GetTick() + deadline_ms;
+  req->stamp = cycles_now();
+  req->status = I2C_BUS_PENDING;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  req->next = bus->pending;
+  bus->pending = req;
+  __set_PRIMASK(primask);
+
+  i2c_bus_dispatch(bus);
+
+  return I2C_BUS_OK;
+}
+
+/**
+ * @brief   Blocks until a submitted request completes, thread context
+ *          only. Once on the bus a request takes at most
+ *          bsp_i2c_timeout_ms() of its length, one HAL tick and one bus
+ *          recovery before it fails.
+ * @param   *req: Request to wait for.
+ * @return  status: Final status of the request.
+ */
+i2c_bus_status i2c_bus_wait(const i2c_request *req)
+{
+  while (I2C_BUS_PENDING == req->status)
+  {
+    /* A stuck transfer is failed here after bsp_i2c_timeout_ms(). */
+    bsp_i2c_poll();
+    if (I2C_BUS_PENDING == req->status)
+    {
+      __WFI();
+    }
+  }
+
+  return (i2c_bus_status)req->status;
+}
+
+/**
+ * @brief   Writes bytes to a device and waits for the result.
+ * @param   *dev: Target device.
+ * @param   *data: Bytes to write.
+ * @param   len:  Number of bytes.
+ * @return  status: Report about the success of the transfer.
+ */
+i2c_bus_status i2c_dev_write(i2c_device *dev, const uint8_t *data, uint16_t len)
+{
+  i2c_request req;
+  i2c_bus_status status;
+
+  i2c_request_setup(&req, dev, (uint8_t *)data, len, NULL, 0u);
+  status = i2c_bus_submit(&req, I2C_BUS_PRIO_DEFAULT, I2C_BUS_NO_DEADLINE);
+  if (I2C_BUS_OK != status)
+  {
+    return status;
+  }
+
+  return i2c_bus_wait(&req);
+}
+
+/**
+ * @brief   Completion of a posted write, interrupt context: gives the block
+ *          back. The request is the first member, so it is the block.
+ * @param   *req: The finished request.
+ * @return  void
+ */
+static void i2c_bus_posted_done(i2c_request *req)
+{
+  (void)pool_free(req);
+}
+
+/**
+ * @brief   Writes bytes to a device without waiting. The request and a copy
+ *          of the bytes go in a pool block that is freed on completion, so
+ *          the caller keeps nothing. A failure only shows in the device
+ *          statistics. Waits like i2c_dev_write() when no block is free.
+ * @param   *dev: Target device.
+ * @param   *data: Bytes to write, copied.
+ * @param   len:  Number of bytes.
+ * @return  status: Report about the success of the submission.
+ */
+i2c_bus_status i2c_dev_post_write(i2c_device *dev, const uint8_t *data, uint16_t len)
+{
+  i2c_posted *post = pool_alloc_size(sizeof(i2c_posted) + len);
+  i2c_bus_status status;
+
+  if (NULL == post)
+  {
+    return i2c_dev_write(dev, data, len);
+  }
+  memcpy(post->data, data, len);
+  i2c_request_setup(&post->req, dev, post->data, len, NULL, 0u);
+  post->req.callback = i2c_bus_posted_done;
+  status = i2c_bus_submit(&post->req, I2C_BUS_PRIO_DEFAULT, I2C_BUS_NO_DEADLINE);
+  if (I2C_BUS_OK != status)
+  {
+    (void)pool_free(post);
+  }
+
+  return status;
+}
+
+/**
+ * @brief   Writes bytes to a device, then reads after a repeated start, and
+ *          waits for the result. The usual way to read registers.
+ * @param   *dev:   Target device.
+ * @param   *tx:    Bytes to write, typically the register address.
+ * @param   tx_len: Number of bytes to write.
+ * @param   *rx:    Buffer for the bytes read.
+ * @param   rx_len: Number of bytes to read.
+ * @return  status: Report about the success of the transfer.
+ */
+i2c_bus_status i2c_dev_write_read(i2c_device *dev, const uint8_t *tx, uint16_t tx_len,
+                                  uint8_t *rx, uint16_t rx_len)
+{
+  i2c_request req;
+  i2c_bus_status status;
+
+  i2c_request_setup(&req, dev, (uint8_t *)tx, tx_len, rx, rx_len);
+  status = i2c_bus_submit(&req, I2C_BUS_PRIO_DEFAULT, I2C_BUS_NO_DEADLINE);
+  if (I2C_BUS_OK != status)
+  {
+    return status;
+  }
+
+  return i2c_bus_wait(&req);
+}
+
+/**
+ * @brief   Prints the bus recoveries, then transfers, errors, deadline
+ *          misses and mean and worst latency of every device on a bus over
+ *          the console UART.
+ * @param   *bus: Bus to report.
+ * @return  void
+ */
+void i2c_bus_report(const i2c_bus *bus)
+{
+  uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+
+  printf("i2c recoveries %lu\n", (unsigned long)bus->engine.recoveries);
+  printf("device   addr  transfers   errors   missed   mean_us    max_us\n");
+  for (const i2c_device *dev = bus->devices; NULL != dev; dev = dev->next)
+  {
+    i2c_device_stats s;
+    uint32_t primask = __get_PRIMASK();
+    uint32_t mean = 0u;
+
+    __disable_irq();
+    s = dev->stats;
+    __set_PRIMASK(primask);
+
+    if (0u != s.transfers)
+    {
+      mean = (uint32_t)(s.total_latency_cycles / s.transfers);
+    }
+    printf("%-8s 0x%02x %10lu %8lu %8lu %9lu %9lu\n", dev->name, (unsigned)dev->address,
+           (unsigned long)s.transfers, (unsigned long)s.errors, (unsigned long)s.deadline_misses,
+           (unsigned long)(mean / cycles_per_us), (unsigned long)(s.max_latency_cycles / cycles_per_us));
+  }
+}
+
+/**
+ * @brief   Ordering key of a request: ms left before its deadline, requests
+ *          without one sort last.
+ * @param   *req: Request to rate.
+ * @param   now:  Current HAL tick.
+ * @return  Slack in ms, negative if the deadline has passed.
+ */
+static int32_t i2c_bus_slack(const i2c_request *req, uint32_t now)
+{
+  if (0u == req->has_deadline)
+  {
+    return INT32_MAX;
+  }
+
+  return (int32_t)(req->deadline - now);
+}
+
+/**
+ * @brief   Removes and returns the request to hand to the engine next,
+ *          called with interrupts masked. See i2c_bus.h for the policy.
+ * @param   *bus: Bus to pick from, pending must not be empty.
+ * @return  Request to put on the bus.
+ */
+static i2c_request *i2c_bus_pick(i2c_bus *bus)
+{
+  uint32_t now = HAL_GetTick();
+  i2c_request **best = NULL;
+  i2c_request **same = NULL;
+  i2c_request **link;
+  i2c_request *req;
+
+  for (link = &bus->pending; NULL != *link; link = &(*link)->next)
+  {
+    req = *link;
+    if ((NULL == best) || (req->prio < (*best)->prio) ||
+        ((req->prio == (*best)->prio) && (i2c_bus_slack(req, now) <= i2c_bus_slack(*best, now))))
+    {
+      best = link;
+    }
+    if ((req->dev == bus->last) &&
+        ((NULL == same) || (req->prio < (*same)->prio) ||
+         ((req->prio == (*same)->prio) && (i2c_bus_slack(req, now) <= i2c_bus_slack(*same, now)))))
+    {
+      same = link;
+    }
+  }
+
+  /* Stay on the same device while it does not cost the others too much. */
+  if ((NULL != same) && (same != best) && ((*same)->prio == (*best)->prio) &&
+      (bus->batch < I2C_BUS_BATCH_MAX) && (i2c_bus_slack(*best, now) > (int32_t)I2C_BUS_URGENT_MS))
+  {
+    best = same;
+  }
+
+  req = *best;
+  *best = req->next;
+  req->next = NULL;
+
+  bus->batch = (req->dev == bus->last) ? (uint8_t)(bus->batch + 1u) : 1u;
+  bus->last = req->dev;
+
+  return req;
+}
+
+/**
+ * @brief   Hands requests to the engine until it holds the one on the bus
+ *          and one queued behind it.
+ * @param   *bus: Bus to serve.
+ * @return  void
+ */
+static void i2c_bus_dispatch(i2c_bus *bus)
+{
+  for (;;)
+  {
+    i2c_request *req = NULL;
+    uint8_t starts = 0u;
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if ((NULL == bus->queued) && (NULL != bus->pending))
+    {
+      req = i2c_bus_pick(bus);
+      if (NULL == bus->active)
+      {
+        bus->active = req;
+        starts = 1u;
+      }
+      else
+      {
+        bus->queued = req;
+      }
+    }
+    __set_PRIMASK(primask);
+
+    if (NULL == req)
+    {
+      return;
+    }
+    if (0u != starts)
+    {
+      trace_event(TRACE_I2C_BEGIN, req->dev->address, 0u);
+    }
+    /* A failed start completes through i2c_bus_done() right away. */
+    (void)bsp_i2c_submit(&bus->engine, &req->xfer);
+  }
+}
+
+/**
+ * @brief   Engine completion callback, runs in interrupt context. Updates
+ *          the device statistics, refills the engine, then notifies. The
+ *          engine has already started the queued request.
+ * @param   *xfer: Finished transfer, embedded in an i2c_request.
+ * @return  void
+ */
+static void i2c_bus_done(bsp_i2c_xfer *xfer)
+{
+  i2c_request *req = (i2c_request *)xfer->context;
+  i2c_device *dev = req->dev;
+  i2c_bus *bus = dev->bus;
+  uint32_t latency = cycles_now() - req->stamp;
+  i2c_device_stats *s = &dev->stats;
+  i2c_request *next = NULL;
+  uint32_t primask;
+
+  trace_event(TRACE_I2C_END, dev->address, (I2C_SUCCESS != xfer->status) ? 1u : 0u);
+  s->transfers++;
+  s->total_latency_cycles += latency;
+  if (latency > s->max_latency_cycles)
+  {
+    s->max_latency_cycles = latency;
+  }
+  if (I2C_SUCCESS != xfer->status)
+  {
+    s->errors++;
+  }
+  if ((0u != req->has_deadline) && ((int32_t)(HAL_GetTick() - req->deadline) > 0))
+  {
+    s->deadline_misses++;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (req == bus->active)
+  {
+    bus->active = bus->queued;
+    bus->queued = NULL;
+    next = bus->active;
+  }
+  else if (req == bus->queued)
+  {
+    /* A submit from an interrupt got its request into the engine first. */
+    bus->queued = NULL;
+  }
+  __set_PRIMASK(primask);
+
+  if (NULL != next)
+  {
+    trace_event(TRACE_I2C_BEGIN, next->dev->address, 0u);
+  }
+  i2c_bus_dispatch(bus);
+
+  /* A waiter may reuse the request as soon as the status is written. */
+  i2c_request_callback callback = req->callback;
+  req->status = (I2C_SUCCESS == xfer->status) ? I2C_BUS_OK : I2C_BUS_ERROR_XFER;
+  if (NULL != callback)
+  {
+    callback(req);
+  }
+}
@@ -0,0 +1,421 @@
+/*
+ * kernel.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "kernel.h"
+#include "cycles.h"
+#include "sections.h"
+#if KERNEL_STACK_GUARD
+#include "mpu_guard.h"
+#endif
+#include <stdio.h>
+
+/* Initial xPSR of a thread, only the Thumb bit set. */
+#define KERNEL_INITIAL_XPSR        0x01000000u
+/* EXC_RETURN for thread mode on PSP without FPU context. */
+#define KERNEL_INITIAL_EXC_RETURN  0xFFFFFFFDu
+/* Ready bit of a priority, so that CLZ of the bitmap gives the highest one. */
+#define KERNEL_PRIO_BIT(prio)      (0x80000000u >> (prio))
+#define KERNEL_IDLE_STACK_WORDS    (KERNEL_STACK_MIN / 4u)
+
+/* Shared with the PendSV and SVC handlers, keep the names. */
+kernel_thread *volatile kernel_current = NULL;
+volatile uint32_t kernel_switch_start = 0u;
+volatile uint32_t kernel_switch_cycles = 0u;
+
+static kernel_thread *threads[KERNEL_PRIO_LEVELS];
+static volatile uint32_t ready = 0u;
+static volatile uint32_t delayed = 0u;
+static volatile uint8_t running = 0u;
+
+static kernel_switch_stats switch_stats;
+
+static kernel_thread idle_thread;
+static uint32_t idle_stack[KERNEL_IDLE_STACK_WORDS] __attribute__((aligned(8)));
+
+RAMFUNC void kernel_select(void);
+void kernel_first(void);
+
+/**
+ * @brief   Called at the start of every PendSV, before any thread switch.
+ *          Weak, the deferred work queue overrides it.
+ * @param   void
+ * @return  void
+ */
+__attribute__((weak)) void kernel_pendsv_hook(void)
+{
+}
+
+/**
+ * @brief   Runs when nothing else is ready, sleeps until the next interrupt.
+ * @param   arg: Unused.
+ * @return  void
+ */
+static void kernel_idle(void *arg)
+{
+  (void)arg;
+  for (;;)
+  {
+    __WFI();
+  }
+}
+
+/**
+ * @brief   Catches a thread returning from its entry function and parks it for good.
+ * @param   void
+ * @return  void
+ */
+static void kernel_thread_exit(void)
+{
+  __disable_irq();
+  ready &= ~KERNEL_PRIO_BIT(kernel_current->prio);
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+  __enable_irq();
+  for (;;)
+  {
+  }
+}
+
+/**
+ * @brief   Picks the highest priority ready thread, called by PendSV between
+ *          saving the old context and restoring the new one. O(1), runs from RAM.
+ * @param   void
+ * @return  void
+ */
+RAMFUNC void kernel_select(void)
+{
+  /* Fold in the cost of the previous switch, measured by PendSV itself. */
+  if (0u != switch_stats.count)
+  {
+    switch_stats.last_cycles = kernel_switch_cycles;
+    if (kernel_switch_cycles > switch_stats.max_cycles)
+    {
+      switch_stats.max_cycles = kernel_switch_cycles;
+    }
+  }
+  switch_stats.count++;
+
+  kernel_current = threads[__CLZ(ready)];
+  kernel_current->switches++;
+#if KERNEL_STACK_GUARD
+  mpu_guard_thread(kernel_current->stack);
+#endif
+}
+
+/**
+ * @brief   Initializes the kernel and creates the idle thread.
+ * @param   void
+ * @return  void
+ */
+void kernel_init(void)
+{
+  cycles_init();
+
+  for (uint32_t prio = 0u; prio < KERNEL_PRIO_LEVELS; prio++)
+  {
+    threads[prio] = NULL;
+  }
+  ready = 0u;
+  delayed = 0u;
+  running = 0u;
+  switch_stats = (kernel_switch_stats){0};
+
+  (void)kernel_thread_create(&idle_thread, "idle", kernel_idle, NULL, KERNEL_PRIO_IDLE,
+                             idle_stack, sizeof(idle_stack));
+}
+
+/**
+ * @brief   Creates a thread. It becomes ready right away and runs once the
+ *          kernel is started, or at the next switch if it already is.
+ * @param   thread:     Thread control block, owned by the caller.
+ * @param   name:       Name used in the report.
+ * @param   entry:      Thread function.
+ * @param   arg:        Argument handed to entry.
+ * @param   prio:       Unique priority, 0 is the highest.
+ * @param   stack:      Stack memory, 8-byte aligned.
+ * @param   stack_size: Stack size in bytes, at least KERNEL_STACK_MIN.
+ * @return  status: Report about the success of the creation.
+ */
+kernel_status kernel_thread_create(kernel_thread *thread, const char *name, kernel_entry entry, void *arg,
+                                   uint8_t prio, uint32_t *stack, uint32_t stack_size)
+{
+  if ((KERNEL_PRIO_LEVELS <= prio) || (NULL != threads[prio]))
+  {
+    return KERNEL_ERROR_PRIO;
+  }
+  if ((NULL == stack) || (KERNEL_STACK_MIN > stack_size))
+  {
+    return KERNEL_ERROR_STACK;
+  }
+
+  /* Build the frame PendSV expects: r4-r11 and EXC_RETURN below the hardware frame. */
+  uint32_t *sp = (uint32_t *)(((uint32_t)stack + stack_size) & ~7u);
+  *--sp = KERNEL_INITIAL_XPSR;
+  *--sp = (uint32_t)entry & ~1u;            /* PC */
+  *--sp = (uint32_t)kernel_thread_exit;     /* LR */
+  *--sp = 0u;                               /* R12 */
+  *--sp = 0u;                               /* R3 */
+  *--sp = 0u;                               /* R2 */
+  *--sp = 0u;                               /* R1 */
+  *--sp = (uint32_t)arg;                    /* R0 */
+  *--sp = KERNEL_INITIAL_EXC_RETURN;
+  for (uint32_t i = 0u; i < 8u; i++)
+  {
+    *--sp = 0u;                             /* R11 to R4 */
+  }
+
+  thread->sp = sp;
+  thread->name = name;
+  thread->stack = stack;
+  thread->stack_size = stack_size;
+  thread->delay = 0u;
+  thread->switches = 0u;
+  thread->prio = prio;
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  threads[prio] = thread;
+  ready |= KERNEL_PRIO_BIT(prio);
+  if ((0u != running) && (prio < kernel_current->prio))
+  {
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+  }
+  __set_PRIMASK(primask);
+
+  return KERNEL_OK;
+}
+
+/**
+ * @brief   Starts the highest priority ready thread. The main stack is
+ *          rewound and reused by interrupts only, this never returns.
+ * @param   void
+ * @return  void
+ */
+void kernel_start(void)
+{
+  /* PendSV must not preempt any other handler. */
+  NVIC_SetPriority(PendSV_IRQn, (1u << __NVIC_PRIO_BITS) - 1u);
+  /* Lazy stacking: FPU registers are only saved for threads that used them. */
+  FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+
+  /* kernel_current stays NULL until SVC_Handler picks the first thread, so
+     a PendSV taken before the svc does not save a context to the PSP. */
+  __disable_irq();
+
+  __ASM volatile (
+    "   ldr     r0, =0xE000ED08     \n" /* SCB->VTOR */
+    "   ldr     r0, [r0]            \n"
+    "   ldr     r0, [r0]            \n" /* initial MSP from the vector table */
+    "   msr     msp, r0             \n"
+    "   mov     r0, #0              \n"
+    "   msr     control, r0         \n" /* drop any FPU context of main() */
+    "   cpsie   i                   \n"
+    "   cpsie   f                   \n"
+    "   dsb                         \n"
+    "   isb                         \n"
+    "   svc     0                   \n"
+    "   nop                         \n"
+    "   .ltorg                      \n"
+    ::: "r0", "memory"
+  );
+
+  for (;;)
+  {
+  }
+}
+
+/**
+ * @brief   Blocks the calling thread for a number of SysTick ticks.
+ * @param   ticks: Ticks to sleep, 0 returns right away.
+ * @return  void
+ */
+void kernel_delay(uint32_t ticks)
+{
+  if (0u == ticks)
+  {
+    return;
+  }
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t bit = KERNEL_PRIO_BIT(kernel_current->prio);
+  kernel_current->delay = ticks;
+  ready &= ~bit;
+  delayed |= bit;
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+  /* PendSV runs as soon as interrupts are enabled again. */
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Gets the thread running right now.
+ * @param   void
+ * @return  Running thread, NULL before kernel_start().
+ */
+kernel_thread *kernel_self(void)
+{
+  return kernel_current;
+}
+
+/**
+ * @brief   Advances the delays of the delayed threads and requests a switch
+ *          if a higher priority thread became ready. Runs at the PendSV priority.
+ * @param   void
+ * @return  void
+ */
+void kernel_tick_isr(void)
+{
+  if (0u == running)
+  {
+    return;
+  }
+
+  uint32_t pending = delayed;
+  while (0u != pending)
+  {
+    uint32_t prio = __CLZ(pending);
+    uint32_t bit = KERNEL_PRIO_BIT(prio);
+
+    pending &= ~bit;
+    if (0u == --threads[prio]->delay)
+    {
+      delayed &= ~bit;
+      ready |= bit;
+    }
+  }
+
+  if (threads[__CLZ(ready)] != kernel_current)
+  {
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+  }
+}
+
+/**
+ * @brief   Reads the context switch cost measured in PendSV.
+ * @param   *stats: Receives a copy of the statistics.
+ * @return  void
+ */
+void kernel_get_switch_stats(kernel_switch_stats *stats)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  *stats = switch_stats;
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Prints every thread and the context switch cost over the console UART.
+ * @param   void
+ * @return  void
+ */
+void kernel_report(void)
+{
+  kernel_switch_stats stats;
+
+  kernel_get_switch_stats(&stats);
+  printf("thread      prio  switches\n");
+  for (uint32_t prio = 0u; prio < KERNEL_PRIO_LEVELS; prio++)
+  {
+    if (NULL != threads[prio])
+    {
+      printf("%-10s %5lu %9lu\n", threads[prio]->name, (unsigned long)prio,
+             (unsigned long)threads[prio]->switches);
+    }
+  }
+  printf("switch cycles last %lu max %lu count %lu\n", (unsigned long)stats.last_cycles,
+         (unsigned long)stats.max_cycles, (unsigned long)stats.count);
+}
+
+/**
+ * @brief   Picks the first thread and starts the kernel, from SVC_Handler.
+ *          PendSV has a lower priority, so no switch runs in between.
+ * @param   void
+ * @return  void
+ */
+void kernel_first(void)
+{
+  kernel_thread *first = threads[__CLZ(ready)];
+
+  first->switches++;
+#if KERNEL_STACK_GUARD
+  mpu_guard_thread(first->stack);
+#endif
+  kernel_current = first;
+  running = 1u;
+}
+
+/**
+ * @brief   Starts the first thread, entered once through the svc in kernel_start().
+ */
+__attribute__((naked)) void SVC_Handler(void)
+{
+  __ASM volatile (
+    "   bl      kernel_first        \n" /* lr is reloaded from the thread frame */
+    "   ldr     r3, =kernel_current \n"
+    "   ldr     r1, [r3]            \n"
+    "   ldr     r0, [r1]            \n" /* kernel_current->sp */
+    "   ldmia   r0!, {r4-r11, lr}   \n"
+    "   msr     psp, r0             \n"
+    "   isb                         \n"
+    "   bx      lr                  \n"
+    "   .ltorg                      \n"
+  );
+}
+
+/**
+ * @brief   Runs kernel_pendsv_hook(), then switches threads if the kernel
+ *          is started. r4-r11, EXC_RETURN and, only if the thread used
+ *          the FPU, s16-s31 go on the thread stack; the hardware stacks the
+ *          rest, lazily for the FPU registers. The switch times itself with
+ *          DWT->CYCCNT into kernel_switch_cycles.
+ */
+__attribute__((naked)) RAMFUNC void PendSV_Handler(void)
+{
+  __ASM volatile (
+    "   push    {r4, lr}                 \n" /* r4 keeps MSP 8-byte aligned */
+    "   bl      kernel_pendsv_hook       \n"
+    "   pop     {r4, lr}                 \n"
+    "   ldr     r3, =kernel_current      \n"
+    "   ldr     r2, [r3]                 \n"
+    "   cbnz    r2, 1f                   \n"
+    "   bx      lr                       \n" /* kernel not started */
+    "1:                                  \n"
+    "   ldr     r1, =0xE0001004          \n" /* DWT->CYCCNT */
+    "   ldr     r1, [r1]                 \n"
+    "   ldr     r2, =kernel_switch_start \n"
+    "   str     r1, [r2]                 \n"
+    "   mrs     r0, psp                  \n"
+    "   isb                              \n"
+    "   ldr     r3, =kernel_current      \n"
+    "   ldr     r2, [r3]                 \n"
+    "   tst     lr, #0x10                \n" /* EXC_RETURN bit 4 clear: FPU frame */
+    "   it      eq                       \n"
+    "   vstmdbeq r0!, {s16-s31}          \n"
+    "   stmdb   r0!, {r4-r11, lr}        \n"
+    "   str     r0, [r2]                 \n"
+    "   cpsid   i                        \n"
+    "   bl      kernel_select            \n"
+    "   cpsie   i                        \n"
+    "   ldr     r3, =kernel_current      \n"
+    "   ldr     r2, [r3]                 \n"
+    "   ldr     r0, [r2]                 \n"
+    "   ldmia   r0!, {r4-r11, lr}        \n"
+    "   tst     lr, #0x10                \n"
+    "   it      eq                       \n"
+    "   vldmiaeq r0!, {s16-s31}          \n"
+    "   msr     psp, r0                  \n"
+    "   isb                              \n"
+    "   ldr     r1, =0xE0001004          \n"
+    "   ldr     r1, [r1]                 \n"
+    "   ldr     r2, =kernel_switch_start \n"
+    "   ldr     r2, [r2]                 \n"
+    "   sub     r1, r1, r2               \n"
+    "   ldr     r2, =kernel_switch_cycles\n"
+    "   str     r1, [r2]                 \n"
+    "   bx      lr                       \n"
+    "   .ltorg                           \n"
+  );
+}
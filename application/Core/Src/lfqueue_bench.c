@@ -0,0 +1,118 @@
+/*
+ * lfqueue_bench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "lfqueue.h"
+#include "cycles.h"
+#include <stdio.h>
+
+/* Operations timed per measurement, the queue is refilled in bursts of its capacity. */
+#define LFQ_BENCH_OPS       4096u
+#define LFQ_BENCH_CAPACITY  64u
+
+LFQ_SPSC_DEFINE(lfq_bench_spsc, uint32_t, LFQ_BENCH_CAPACITY)
+LFQ_MPSC_DEFINE(lfq_bench_mpsc, uint32_t, LFQ_BENCH_CAPACITY)
+
+static lfq_bench_spsc spsc;
+static lfq_bench_mpsc mpsc;
+
+/* Reference: the ad-hoc ring guarded by masking interrupts that the queues replace. */
+static uint32_t locked_buf[LFQ_BENCH_CAPACITY];
+static uint32_t locked_head = 0u;
+static uint32_t locked_tail = 0u;
+
+static uint8_t locked_push(const uint32_t *value)
+{
+  uint8_t ok = 0u;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if ((locked_head - locked_tail) < LFQ_BENCH_CAPACITY)
+  {
+    locked_buf[locked_head & (LFQ_BENCH_CAPACITY - 1u)] = *value;
+    locked_head++;
+    ok = 1u;
+  }
+  __set_PRIMASK(primask);
+
+  return ok;
+}
+
+static uint8_t locked_pop(uint32_t *value)
+{
+  uint8_t ok = 0u;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if (locked_head != locked_tail)
+  {
+    *value = locked_buf[locked_tail & (LFQ_BENCH_CAPACITY - 1u)];
+    locked_tail++;
+    ok = 1u;
+  }
+  __set_PRIMASK(primask);
+
+  return ok;
+}
+
+/**
+ * @brief   Times LFQ_BENCH_OPS pushes and as many pops of one queue type.
+ * @param   name: Label printed in the report.
+ * @param   push: Push function of the queue.
+ * @param   pop:  Pop function of the queue.
+ * @param   q:    Queue instance handed to push and pop.
+ * @return  void
+ */
+#define LFQ_BENCH_RUN(name, push, pop, q)                                               \
+  do                                                                                    \
+  {                                                                                     \
+    uint32_t push_cycles = 0u;                                                          \
+    uint32_t pop_cycles = 0u;                                                           \
+    uint32_t value = 0u;                                                                \
+    for (uint32_t done = 0u; done < LFQ_BENCH_OPS; done += LFQ_BENCH_CAPACITY)         \
+    {                                                                                   \
+      uint32_t start = cycles_now();                                                    \
+      for (uint32_t i = 0u; i < LFQ_BENCH_CAPACITY; i++)                                \
+      {                                                                                 \
+        value = i;                                                                      \
+        (void)push(q, &value);                                                          \
+      }                                                                                 \
+      uint32_t mid = cycles_now();                                                      \
+      for (uint32_t i = 0u; i < LFQ_BENCH_CAPACITY; i++)                                \
+      {                                                                                 \
+        (void)pop(q, &value);                                                           \
+      }                                                                                 \
+      push_cycles += mid - start;                                                       \
+      pop_cycles += cycles_now() - mid;                                                 \
+    }                                                                                   \
+    printf("%-8s push %3lu.%02lu pop %3lu.%02lu cycles/op\n", (name),                   \
+           (unsigned long)(push_cycles / LFQ_BENCH_OPS),                                \
+           (unsigned long)(((push_cycles % LFQ_BENCH_OPS) * 100u) / LFQ_BENCH_OPS),     \
+           (unsigned long)(pop_cycles / LFQ_BENCH_OPS),                                 \
+           (unsigned long)(((pop_cycles % LFQ_BENCH_OPS) * 100u) / LFQ_BENCH_OPS));     \
+  } while (0)
+
+#define LFQ_BENCH_LOCKED_PUSH(q, v) locked_push(v)
+#define LFQ_BENCH_LOCKED_POP(q, v)  locked_pop(v)
+
+/**
+ * @brief   Prints the cost of one push and one pop, in core cycles, for the
+ *          SPSC and MPSC queues and for an interrupt-masking ring.
+ *          Loop overhead is included, so compare the rows rather than the
+ *          absolute numbers.
+ * @param   void
+ * @return  void
+ */
+void lfqueue_bench(void)
+{
+  cycles_init();
+  lfq_bench_spsc_init(&spsc);
+  lfq_bench_mpsc_init(&mpsc);
+
+  LFQ_BENCH_RUN("spsc", lfq_bench_spsc_push, lfq_bench_spsc_pop, &spsc);
+  LFQ_BENCH_RUN("mpsc", lfq_bench_mpsc_push, lfq_bench_mpsc_pop, &mpsc);
+  LFQ_BENCH_RUN("irq-lock", LFQ_BENCH_LOCKED_PUSH, LFQ_BENCH_LOCKED_POP, NULL);
+}
@@ -1,4 +1,3 @@
-<<<<<<< HEAD
 // thien
 //          khoa
 //aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa
@@ -27,6 +26,22 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include <stdio.h>
+#include "scheduler.h"
+#include "workq.h"
+#include "i2c_bus.h"
+#include "rtc_ds1307.h"
+#include "softclock.h"
+#include "nvstore.h"
+#include "rtc.h"
+#include "pool.h"
+#include "stackmon.h"
+#include "mpu_guard.h"
+#include "prof.h"
+#include "pcsamp.h"
+#include "crashdump.h"
+#include "trace.h"
+#include "kernel.h"
+#include "lfqueue.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -39,6 +54,15 @@
 /* USER CODE BEGIN PD */
 #define MAJOR 0 //Major version number
 #define MINOR 2 //Minor version number
+#define LED_PERIOD_MS     1000u  //LED blink half period
+#define REPORT_PERIOD_MS  10000u //Scheduler report period
+#define RTC_TRIM_PERIOD_S 600u   //Internal RTC trim period against the DS1307
+#define CONSOLE_POLL_MS   50u    //Console command poll period
+#ifndef KERNEL_RUN
+#define KERNEL_RUN        0      //1: the main loop runs as a kernel thread next to a demo thread pair
+#endif
+#define KERNEL_MAIN_STACK 4096u  //Stack of the main loop thread, bytes
+#define KERNEL_DEMO_STACK 512u   //Stack of a demo thread, bytes
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -47,18 +71,44 @@
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
+I2C_HandleTypeDef hi2c1;
+DMA_HandleTypeDef hdma_i2c1_rx;
+DMA_HandleTypeDef hdma_i2c1_tx;
+
 UART_HandleTypeDef huart1;
 
 /* USER CODE BEGIN PV */
 const uint8_t APP_Version[2] = {MAJOR, MINOR};
+static sched_task_id led_task;
+static sched_task_id report_task;
+static sched_task_id console_task;
+i2c_bus i2c1_bus;
+static uint32_t boot_count;
+static uint32_t last_crash;
+#if KERNEL_RUN
+static kernel_thread main_thread;
+static kernel_thread ping_thread;
+static kernel_thread pong_thread;
+static uint32_t main_stack[KERNEL_MAIN_STACK / 4u] __attribute__((aligned(32)));
+static uint32_t ping_stack[KERNEL_DEMO_STACK / 4u] __attribute__((aligned(32)));
+static uint32_t pong_stack[KERNEL_DEMO_STACK / 4u] __attribute__((aligned(32)));
+#endif
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART1_UART_Init(void);
+static void MX_I2C1_Init(void);
 /* USER CODE BEGIN PFP */
-
+static void led_task_handler(const sched_event *evt);
+static void report_task_handler(const sched_event *evt);
+static void console_task_handler(const sched_event *evt);
+#if KERNEL_RUN
+static void main_thread_entry(void *arg);
+static void demo_thread_entry(void *arg);
+#endif
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -82,7 +132,8 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-
+  crashdump_init();
+  mpu_guard_init();
   /* USER CODE END Init */
 
   /* Configure the system clock */
@@ -94,9 +145,74 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART1_UART_Init();
+  MX_I2C1_Init();
   /* USER CODE BEGIN 2 */
+  prof_init();
+  pcsamp_init();
+  trace_init();
   printf("Starting Application (%d.%d)\n", APP_Version[0], APP_Version[1]);
+  last_crash = crashdump_check();
+
+  pool_init();
+  workq_init();
+  sched_init();
+  if (I2C_BUS_OK != i2c_bus_init(&i2c1_bus, &hi2c1))
+  {
+    Error_Handler();
+  }
+  bsp_i2c_set_recovery_pins(&i2c1_bus.engine, I2C1_SCL_GPIO_Port, I2C1_SCL_Pin, I2C1_SDA_GPIO_Port, I2C1_SDA_Pin);
+  ds1307_init(&i2c1_bus);
+  if (NVSTORE_OK == nvstore_init())
+  {
+    if (NVSTORE_OK == nvstore_boot_count(&boot_count))
+    {
+      printf("Boot %lu\n", (unsigned long)boot_count);
+    }
+    if (0u != last_crash)
+    {
+      (void)nvstore_fault_record(last_crash);
+    }
+  }
+  if (SOFTCLOCK_OK != softclock_init())
+  {
+    Error_Handler();
+  }
+  /* Internal RTC on the hot path, the DS1307 as reference; the DS1307 alone if there is no internal RTC. */
+  if (RTC_ERROR_HW == rtc_init())
+  {
+#ifndef RTC_FIXED_BACKEND
+    (void)rtc_select(&rtc_ds1307_backend);
+#endif
+  }
+  if (RTC_OK != rtc_discipline_start(&rtc_ds1307_backend, RTC_TRIM_PERIOD_S))
+  {
+    Error_Handler();
+  }
+  if ((SCHED_OK != sched_task_create("led", led_task_handler, 1u, &led_task)) ||
+      (SCHED_OK != sched_task_create("report", report_task_handler, SCHED_PRIO_LEVELS - 1u, &report_task)) ||
+      (SCHED_OK != sched_task_create("console", console_task_handler, SCHED_PRIO_LEVELS - 1u, &console_task)) ||
+      (SCHED_OK != sched_every(led_task, LED_PERIOD_MS)) ||
+      (SCHED_OK != sched_every(report_task, REPORT_PERIOD_MS)) ||
+      (SCHED_OK != sched_every(console_task, CONSOLE_POLL_MS)))
+  {
+    Error_Handler();
+  }
+#if KERNEL_RUN
+  /* The loop below moves into a thread, two demo threads preempt it every few ticks. */
+  kernel_init();
+  if ((KERNEL_OK != kernel_thread_create(&ping_thread, "ping", demo_thread_entry, (void *)10u, 1u,
+                                         ping_stack, sizeof(ping_stack))) ||
+      (KERNEL_OK != kernel_thread_create(&pong_thread, "pong", demo_thread_entry, (void *)25u, 2u,
+                                         pong_stack, sizeof(pong_stack))) ||
+      (KERNEL_OK != kernel_thread_create(&main_thread, "main", main_thread_entry, NULL, KERNEL_PRIO_IDLE - 1u,
+                                         main_stack, sizeof(main_stack))))
+  {
+    Error_Handler();
+  }
+  kernel_start();
+#endif
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -106,8 +222,8 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
-	  HAL_GPIO_TogglePin(LED2_GPIO_Port, LED2_Pin);
-	  HAL_Delay(1000);
+	  sched_run_once();
+	  bsp_i2c_poll();
   }
   /* USER CODE END 3 */
 }
@@ -153,6 +269,40 @@ void SystemClock_Config(void)
   }
 }
 
+/**
+  * @brief I2C1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_I2C1_Init(void)
+{
+
+  /* USER CODE BEGIN I2C1_Init 0 */
+
+  /* USER CODE END I2C1_Init 0 */
+
+  /* USER CODE BEGIN I2C1_Init 1 */
+
+  /* USER CODE END I2C1_Init 1 */
+  hi2c1.Instance = I2C1;
+  hi2c1.Init.ClockSpeed = 100000;
+  hi2c1.Init.DutyCycle = I2C_DUTYCYCLE_2;
+  hi2c1.Init.OwnAddress1 = 0;
+  hi2c1.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+  hi2c1.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+  hi2c1.Init.OwnAddress2 = 0;
+  hi2c1.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+  hi2c1.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+  if (HAL_I2C_Init(&hi2c1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN I2C1_Init 2 */
+
+  /* USER CODE END I2C1_Init 2 */
+
+}
+
 /**
   * @brief USART1 Initialization Function
   * @param None
@@ -186,6 +336,25 @@ static void MX_USART1_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream0_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream0_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream0_IRQn);
+  /* DMA1_Stream6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -211,17 +380,170 @@ static void MX_GPIO_Init(void)
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(LED2_GPIO_Port, &GPIO_InitStruct);
 
+  /*Configure GPIO pin : RTC_SQW_Pin */
+  GPIO_InitStruct.Pin = RTC_SQW_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(RTC_SQW_GPIO_Port, &GPIO_InitStruct);
+
+  /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(RTC_SQW_EXTI_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(RTC_SQW_EXTI_IRQn);
+
 /* USER CODE BEGIN MX_GPIO_Init_2 */
 /* USER CODE END MX_GPIO_Init_2 */
 }
 
 /* USER CODE BEGIN 4 */
+/**
+  * @brief  Blinks the LED, runs on every periodic tick.
+  * @param  evt: Scheduler event.
+  * @retval None
+  */
+static void led_task_handler(const sched_event *evt)
+{
+  if (SCHED_SIG_TICK == evt->sig)
+  {
+    HAL_GPIO_TogglePin(LED2_GPIO_Port, LED2_Pin);
+  }
+}
+
+/**
+  * @brief  Prints the scheduler, I2C bus, clock, pool, work queue and stack reports.
+  * @param  evt: Scheduler event.
+  * @retval None
+  */
+static void report_task_handler(const sched_event *evt)
+{
+  if (SCHED_SIG_TICK == evt->sig)
+  {
+    sched_report();
+    i2c_bus_report(&i2c1_bus);
+    softclock_report();
+    rtc_report();
+    pool_report();
+    workq_report();
+    stackmon_report();
+  }
+}
+
+/**
+  * @brief  Polls the console UART for one-key commands:
+  *         'p' prints the profiling zones, 'z' clears them,
+  *         's' takes a PC sample capture, 'd' dumps the event trace,
+  *         'k' prints the kernel threads (build with KERNEL_RUN 1),
+  *         'l' runs the lock-free queue benchmark,
+  *         'b' runs the DS1307 burst read benchmark.
+  *         Prints captures and dumps a few lines per tick.
+  * @param  evt: Scheduler event.
+  * @retval None
+  */
+static void console_task_handler(const sched_event *evt)
+{
+  if (SCHED_SIG_TICK != evt->sig)
+  {
+    return;
+  }
+
+  pcsamp_poll();
+  trace_poll();
+  if (RESET == __HAL_UART_GET_FLAG(&huart1, UART_FLAG_RXNE))
+  {
+    return;
+  }
+
+  switch ((char)(huart1.Instance->DR & 0xFFu))
+  {
+    case 'p':
+      prof_report();
+      break;
+    case 'z':
+      prof_reset();
+      printf("profile cleared\n");
+      break;
+    case 's':
+      if (PCSAMP_OK != pcsamp_start(0u))
+      {
+        printf("pcsamp busy\n");
+      }
+      break;
+    case 'd':
+      if (0u == trace_dump_start())
+      {
+        printf("trace busy\n");
+      }
+      break;
+    case 'k':
+      if (NULL != kernel_self())
+      {
+        kernel_report();
+      }
+      else
+      {
+        printf("kernel not running\n");
+      }
+      break;
+    case 'l':
+      lfqueue_bench();
+      break;
+    case 'b':
+      ds1307_bench();
+      break;
+    default:
+      break;
+  }
+}
+
+#if KERNEL_RUN
+/**
+  * @brief  Runs the scheduler loop of main() as the lowest application thread.
+  * @param  arg: Unused.
+  * @retval None
+  */
+static void main_thread_entry(void *arg)
+{
+  (void)arg;
+  for (;;)
+  {
+    sched_run_once();
+    bsp_i2c_poll();
+  }
+}
+
+/**
+  * @brief  Demo thread, sleeps a fixed number of ticks over and over.
+  * @param  arg: Sleep period in ticks.
+  * @retval None
+  */
+static void demo_thread_entry(void *arg)
+{
+  for (;;)
+  {
+    kernel_delay((uint32_t)arg);
+  }
+}
+#endif
+
+/**
+  * @brief  EXTI line detection callback.
+  * @param  GPIO_Pin: Pin that triggered the interrupt.
+  * @retval None
+  */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  if (RTC_SQW_Pin == GPIO_Pin)
+  {
+    softclock_edge_isr();
+  }
+}
+
 #ifdef __GNUC__
 int __io_putchar(int ch)
 #else
 int fputc(int ch, FILE *f)
 #endif
 {
+	PROF_SCOPE(io_putchar);
 	HAL_UART_Transmit(&huart1, (uint8_t *)&ch, 1, HAL_MAX_DELAY);
 	return ch;
 }
@@ -235,10 +557,7 @@ void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
-  __disable_irq();
-  while (1)
-  {
-  }
+  crashdump_error((uint32_t)__builtin_return_address(0));
   /* USER CODE END Error_Handler_Debug */
 }
 
@@ -0,0 +1,211 @@
+/*
+ * mpu_guard.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "mpu_guard.h"
+#include "kernel.h"
+#include "crashdump.h"
+
+extern uint32_t _estack;         /* Symbol defined in the linker script */
+extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
+
+/* MemManage status bits, the low byte of CFSR. */
+#define MPU_GUARD_MMFSR_Msk  0xFFu
+
+/* Last fault, kept for a debugger and across a warm reset. */
+NOINIT volatile mpu_guard_fault_info mpu_guard_last;
+
+static uint32_t msp_guard = 0u;
+static uint32_t thread_guard = 0u;
+
+/**
+ * @brief   Writes one character to the console UART, polling. Used in the
+ *          fault handler only, where the HAL handle may be locked.
+ * @param   c: Character.
+ * @return  void
+ */
+static void mpu_guard_putc(char c)
+{
+  while (0u == (MPU_GUARD_UART->SR & USART_SR_TXE))
+  {
+  }
+  MPU_GUARD_UART->DR = (uint8_t)c;
+}
+
+/**
+ * @brief   Writes a string to the console UART, polling.
+ * @param   *s: String.
+ * @return  void
+ */
+static void mpu_guard_puts(const char *s)
+{
+  while ('\0' != *s)
+  {
+    mpu_guard_putc(*s++);
+  }
+}
+
+/**
+ * @brief   Writes a label and a 32-bit value in hex.
+ * @param   *label: Text before the value.
+ * @param   value:  Value.
+ * @return  void
+ */
+static void mpu_guard_puthex(const char *label, uint32_t value)
+{
+  mpu_guard_puts(label);
+  mpu_guard_puts(" 0x");
+  for (int32_t shift = 28; shift >= 0; shift -= 4)
+  {
+    mpu_guard_putc("0123456789abcdef"[(value >> shift) & 0xFu]);
+  }
+}
+
+/**
+ * @brief   Tells whether an address lies in a stack guard.
+ * @param   address: Address to check.
+ * @param   guard:   Base of the guard, 0 if there is none.
+ * @return  1 if it does, 0 otherwise.
+ */
+static uint8_t mpu_guard_hit(uint32_t address, uint32_t guard)
+{
+  return ((0u != guard) && ((address - guard) < MPU_GUARD_SIZE)) ? 1u : 0u;
+}
+
+/**
+ * @brief   Sets up the guards and enables the MPU: no access at all to the
+ *          first MPU_GUARD_NULL_SIZE bytes of the address space and to the
+ *          MPU_GUARD_SIZE bytes right below the main stack reservation.
+ *          Everything else keeps the default memory map, so the normal
+ *          path costs nothing. _sbrk stops the heap below the stack guard.
+ * @param   void
+ * @return  void
+ */
+void mpu_guard_init(void)
+{
+  uint32_t limit = (uint32_t)&_estack - (uint32_t)&_Min_Stack_Size;
+
+  msp_guard = MPU_GUARD_BELOW(limit);
+  thread_guard = 0u;
+
+  ARM_MPU_Disable();
+  ARM_MPU_SetRegion(ARM_MPU_RBAR(MPU_GUARD_REGION_NULL, 0x00000000u),
+                    ARM_MPU_RASR(1u, ARM_MPU_AP_NONE, 0u, 0u, 0u, 0u, 0u, ARM_MPU_REGION_SIZE_1KB));
+  ARM_MPU_SetRegion(ARM_MPU_RBAR(MPU_GUARD_REGION_MSP, msp_guard),
+                    ARM_MPU_RASR(1u, ARM_MPU_AP_NONE, 0u, 0u, 0u, 0u, 0u, ARM_MPU_REGION_SIZE_32B));
+  ARM_MPU_ClrRegion(MPU_GUARD_REGION_THREAD);
+  /* Privileged code keeps the default map elsewhere, the handlers of
+     HardFault and NMI run without the MPU. */
+  ARM_MPU_Enable(MPU_CTRL_PRIVDEFENA_Msk);
+  /* Without this a violation escalates to HardFault, not MemManage_Handler. */
+  SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+  __DSB();
+  __ISB();
+}
+
+/**
+ * @brief   Moves the thread guard to the lowest aligned MPU_GUARD_SIZE
+ *          bytes of a thread stack. Runs inside PendSV, whose exception
+ *          return makes the new region take effect, so no barrier is needed.
+ * @param   *stack: Lowest address of the thread stack.
+ * @return  void
+ */
+RAMFUNC void mpu_guard_thread(const uint32_t *stack)
+{
+  thread_guard = MPU_GUARD_INSIDE(stack);
+  ARM_MPU_SetRegion(ARM_MPU_RBAR(MPU_GUARD_REGION_THREAD, thread_guard),
+                    ARM_MPU_RASR(1u, ARM_MPU_AP_NONE, 0u, 0u, 0u, 0u, 0u, ARM_MPU_REGION_SIZE_32B));
+}
+
+/**
+ * @brief   Reports a guard violation on the console UART in one line, then
+ *          leaves a crash dump and resets. MemManage_Handler moves the MSP
+ *          to the fault stack first, the exception frame is read with the
+ *          MPU off because it may sit in a guard itself.
+ * @param   *frame:     Exception frame, on the stack that was in use.
+ * @param   exc_return: EXC_RETURN of the fault.
+ * @return  Does not return.
+ */
+void mpu_guard_fault(const uint32_t *frame, uint32_t exc_return)
+{
+  uint32_t cfsr = SCB->CFSR & MPU_GUARD_MMFSR_Msk;
+  uint32_t address = (0u != (cfsr & SCB_CFSR_MMARVALID_Msk)) ? SCB->MMFAR : 0u;
+  uint32_t where;
+  const char *what;
+
+  ARM_MPU_Disable();
+
+  mpu_guard_last.cfsr = cfsr;
+  mpu_guard_last.address = address;
+  mpu_guard_last.sp = (uint32_t)frame;
+  mpu_guard_last.exc_return = exc_return;
+  /* A failed push of the frame leaves garbage where it should be. */
+  mpu_guard_last.pc = (0u != (cfsr & SCB_CFSR_MSTKERR_Msk)) ? 0u : frame[6];
+  mpu_guard_last.lr = (0u != (cfsr & SCB_CFSR_MSTKERR_Msk)) ? 0u : frame[5];
+
+  where = (0u != address) ? address : (uint32_t)frame;
+  if ((0u != (cfsr & SCB_CFSR_MMARVALID_Msk)) && (MPU_GUARD_NULL_SIZE > address))
+  {
+    what = "null pointer";
+  }
+  else if (0u != mpu_guard_hit(where, msp_guard))
+  {
+    what = "main stack overflow";
+  }
+  else if (0u != mpu_guard_hit(where, thread_guard))
+  {
+    what = "thread stack overflow";
+  }
+  else if (0u != (cfsr & SCB_CFSR_IACCVIOL_Msk))
+  {
+    what = "execute violation";
+  }
+  else
+  {
+    what = "access violation";
+  }
+
+  mpu_guard_puts("\nMPU fault: ");
+  mpu_guard_puts(what);
+  if ((0u != (exc_return & 0x4u)) && (NULL != kernel_self()))
+  {
+    mpu_guard_puts(" in ");
+    mpu_guard_puts(kernel_self()->name);
+  }
+  mpu_guard_puthex(" addr", address);
+  mpu_guard_puthex(" pc", mpu_guard_last.pc);
+  mpu_guard_puthex(" lr", mpu_guard_last.lr);
+  mpu_guard_puthex(" sp", mpu_guard_last.sp);
+  mpu_guard_puthex(" cfsr", cfsr);
+  mpu_guard_puts("\n");
+  /* Let the last character out before the reset. */
+  while (0u == (MPU_GUARD_UART->SR & USART_SR_TC))
+  {
+  }
+
+  crashdump_fault(frame, exc_return, CRASHDUMP_MEMMANAGE);
+}
+
+/**
+ * @brief   Memory management fault. Naked: after a stack overflow the MSP
+ *          points into the guard and any push would fault again, so the
+ *          frame is located and the MSP reset before C code runs.
+ */
+__attribute__((naked)) void MemManage_Handler(void)
+{
+  __ASM volatile (
+    "   tst     lr, #4              \n"
+    "   ite     eq                  \n"
+    "   mrseq   r0, msp             \n"
+    "   mrsne   r0, psp             \n"
+    "   mov     r1, lr              \n"
+    "   ldr     r2, =crashdump_stack_top \n" /* the report runs on the fault stack */
+    "   ldr     r2, [r2]            \n"
+    "   msr     msp, r2             \n"
+    "   b       mpu_guard_fault     \n"
+    "   .ltorg                      \n"
+  );
+}
@@ -0,0 +1,192 @@
+/*
+ * nvstore.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "nvstore.h"
+#include <string.h>
+
+/* First NVRAM offset after the century byte. */
+#define NVSTORE_BASE        (DS1307_REG_CENT - DS1307_REG_NVRAM + 1u)
+
+/* Stored size of each record: payload plus CRC. */
+#define NVSTORE_BOOT_SIZE   (sizeof(uint32_t) + 1u)
+#define NVSTORE_FAULT_SIZE  (sizeof(nvstore_fault) + 1u)
+#define NVSTORE_FLASH_SIZE  (sizeof(nvstore_flash_marker) + 1u)
+
+#define NVSTORE_BOOT_AT     0u
+#define NVSTORE_FAULT_AT    (NVSTORE_BOOT_AT + NVSTORE_BOOT_SIZE)
+#define NVSTORE_FLASH_AT    (NVSTORE_FAULT_AT + NVSTORE_FAULT_SIZE)
+#define NVSTORE_SIZE        (NVSTORE_FLASH_AT + NVSTORE_FLASH_SIZE)
+
+_Static_assert(sizeof(nvstore_fault) == 8u, "nvstore_fault must not have padding");
+_Static_assert(sizeof(nvstore_flash_marker) == 12u, "nvstore_flash_marker must not have padding");
+_Static_assert((NVSTORE_BASE + NVSTORE_SIZE) <= DS1307_NVRAM_SIZE, "records do not fit in the DS1307 NVRAM");
+
+/* Where each record sits in the image, and its payload size. */
+static const struct {
+  uint8_t at;
+  uint8_t size;
+} records[NVSTORE_RECORDS] = {
+  [NVSTORE_BOOT]         = {NVSTORE_BOOT_AT, NVSTORE_BOOT_SIZE - 1u},
+  [NVSTORE_FAULT]        = {NVSTORE_FAULT_AT, NVSTORE_FAULT_SIZE - 1u},
+  [NVSTORE_FLASH_MARKER] = {NVSTORE_FLASH_AT, NVSTORE_FLASH_SIZE - 1u},
+};
+
+/* RAM image of the records, the NVRAM holds the same bytes. */
+static uint8_t image[NVSTORE_SIZE];
+
+/**
+ * @brief   CRC-8, polynomial 0x07, seeded with the record id so a record
+ *          read at the wrong place does not pass.
+ * @param   id:    Record identifier.
+ * @param   *data: Payload.
+ * @param   len:   Payload size.
+ * @return  CRC of id and payload.
+ */
+static uint8_t nvstore_crc8(nvstore_id id, const uint8_t *data, uint8_t len)
+{
+  uint8_t crc = (uint8_t)(0xFFu ^ (uint8_t)id);
+
+  for (uint8_t i = 0u; i < len; i++)
+  {
+    crc ^= data[i];
+    for (uint8_t bit = 0u; bit < 8u; bit++)
+    {
+      crc = (uint8_t)(((uint32_t)crc << 1) ^ ((0u != (crc & 0x80u)) ? 0x07u : 0u));
+    }
+  }
+
+  return crc;
+}
+
+/**
+ * @brief   Loads every record from the DS1307 in one burst.
+ * @param   void
+ * @return  status: Report about the success of the load.
+ */
+nvstore_status nvstore_init(void)
+{
+  if (TM_DS1307_Result_Ok != ds1307_read_nvram(NVSTORE_BASE, image, sizeof(image)))
+  {
+    memset(image, 0, sizeof(image));
+    return NVSTORE_ERROR_BUS;
+  }
+
+  return NVSTORE_OK;
+}
+
+/**
+ * @brief   Copies a record out of the RAM image, no bus access.
+ * @param   id:    Record to read.
+ * @param   *data: Receives the payload, sized for the record type.
+ * @return  status: NVSTORE_ERROR_CRC if the record is empty or corrupt.
+ */
+nvstore_status nvstore_read(nvstore_id id, void *data)
+{
+  const uint8_t *rec;
+
+  if (NVSTORE_RECORDS <= id)
+  {
+    return NVSTORE_ERROR_ID;
+  }
+  rec = &image[records[id].at];
+  if (nvstore_crc8(id, rec, records[id].size) != rec[records[id].size])
+  {
+    return NVSTORE_ERROR_CRC;
+  }
+  memcpy(data, rec, records[id].size);
+
+  return NVSTORE_OK;
+}
+
+/**
+ * @brief   Writes a record, payload and CRC in one burst.
+ * @param   id:    Record to write.
+ * @param   *data: Payload, sized for the record type.
+ * @return  status: Report about the success of the write.
+ */
+nvstore_status nvstore_write(nvstore_id id, const void *data)
+{
+  uint8_t rec[NVSTORE_SIZE];
+
+  if (NVSTORE_RECORDS <= id)
+  {
+    return NVSTORE_ERROR_ID;
+  }
+  memcpy(rec, data, records[id].size);
+  rec[records[id].size] = nvstore_crc8(id, rec, records[id].size);
+  if (TM_DS1307_Result_Ok != ds1307_write_nvram(NVSTORE_BASE + records[id].at, rec, records[id].size + 1u))
+  {
+    /* The image keeps what the NVRAM held before. */
+    return NVSTORE_ERROR_BUS;
+  }
+  memcpy(&image[records[id].at], rec, records[id].size + 1u);
+
+  return NVSTORE_OK;
+}
+
+/**
+ * @brief   Counts one more boot. Call once per reset.
+ * @param   *count: Receives the new count, 1 after a battery loss.
+ * @return  status: Report about the success of the write.
+ */
+nvstore_status nvstore_boot_count(uint32_t *count)
+{
+  uint32_t boots = 0u;
+
+  (void)nvstore_read(NVSTORE_BOOT, &boots);
+  boots++;
+  *count = boots;
+
+  return nvstore_write(NVSTORE_BOOT, &boots);
+}
+
+/**
+ * @brief   Stores a fault as the last one, stamped with the DS1307 time.
+ * @param   code: Application defined code, e.g. a crashdump_reason.
+ * @return  status: Report about the success of the write.
+ */
+nvstore_status nvstore_fault_record(uint32_t code)
+{
+  nvstore_fault fault = {code, 0};
+  ds1307_time_t now;
+
+  /* A fault without a time is still worth keeping. */
+  if (TM_DS1307_Result_Ok == ds1307_read_time(&now))
+  {
+    fault.time = ds1307_time_to_epoch(&now);
+  }
+
+  return nvstore_write(NVSTORE_FAULT, &fault);
+}
+
+/**
+ * @brief   Writes the flash marker ahead of an update step. Leaving
+ *          NVSTORE_FLASH_IDLE starts a new update and bumps the sequence;
+ *          address and length are kept when the marker goes back to IDLE.
+ * @param   state:   Step about to start, NVSTORE_FLASH_IDLE when done.
+ * @param   address: First flash address the step touches.
+ * @param   length:  Bytes the step touches.
+ * @return  status: Report about the success of the write.
+ */
+nvstore_status nvstore_flash_mark(nvstore_flash_state state, uint32_t address, uint32_t length)
+{
+  nvstore_flash_marker marker = {0};
+
+  (void)nvstore_read(NVSTORE_FLASH_MARKER, &marker);
+  if (NVSTORE_FLASH_IDLE != state)
+  {
+    if (NVSTORE_FLASH_IDLE == marker.state)
+    {
+      marker.sequence++;
+    }
+    marker.address = address;
+    marker.length = length;
+  }
+  marker.state = (uint8_t)state;
+
+  return nvstore_write(NVSTORE_FLASH_MARKER, &marker);
+}
@@ -0,0 +1,193 @@
+/*
+ * pcsamp.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "pcsamp.h"
+#include <stdio.h>
+
+/* Timer counter clock, the auto-reload value sets the rate from it. */
+#define PCSAMP_COUNT_HZ  1000000u
+
+typedef enum {
+  PCSAMP_IDLE = 0u,
+  PCSAMP_SAMPLING,
+  PCSAMP_DUMPING
+} pcsamp_state;
+
+static pcsamp_sample samples[PCSAMP_DEPTH];
+static volatile uint32_t count = 0u;
+static volatile pcsamp_state state = PCSAMP_IDLE;
+static uint32_t rate = 0u;
+/* Lines of the capture printed so far, the header included. */
+static uint32_t printed = 0u;
+
+/**
+ * @brief   Clock of the APB1 timers: PCLK1, doubled when APB1 is divided.
+ * @param   void
+ * @return  Timer clock in Hz.
+ */
+static uint32_t pcsamp_timer_clock(void)
+{
+  uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+
+  return (RCC_HCLK_DIV1 == (RCC->CFGR & RCC_CFGR_PPRE1)) ? pclk1 : (2u * pclk1);
+}
+
+/**
+ * @brief   Enables the timer clock and its interrupt at the highest
+ *          priority, so ISRs are sampled too. The timer stays stopped.
+ * @param   void
+ * @return  void
+ */
+void pcsamp_init(void)
+{
+  __HAL_RCC_TIM5_CLK_ENABLE();
+  PCSAMP_TIM->CR1 = 0u;
+  PCSAMP_TIM->DIER = 0u;
+  PCSAMP_TIM->SR = 0u;
+  state = PCSAMP_IDLE;
+  count = 0u;
+
+  HAL_NVIC_SetPriority(PCSAMP_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(PCSAMP_IRQn);
+}
+
+/**
+ * @brief   Starts a capture. The previous one must have been printed.
+ * @param   rate_hz: Samples per second, 0 for PCSAMP_RATE_HZ.
+ * @return  PCSAMP_OK, PCSAMP_BUSY while a capture runs or prints,
+ *          PCSAMP_ERROR for a rate the timer cannot make.
+ */
+pcsamp_status pcsamp_start(uint32_t rate_hz)
+{
+  uint32_t reload;
+
+  if (PCSAMP_IDLE != state)
+  {
+    return PCSAMP_BUSY;
+  }
+  if (0u == rate_hz)
+  {
+    rate_hz = PCSAMP_RATE_HZ;
+  }
+  reload = PCSAMP_COUNT_HZ / rate_hz;
+  if (2u > reload)
+  {
+    return PCSAMP_ERROR;
+  }
+
+  rate = rate_hz;
+  count = 0u;
+  printed = 0u;
+  state = PCSAMP_SAMPLING;
+
+  PCSAMP_TIM->PSC = (pcsamp_timer_clock() / PCSAMP_COUNT_HZ) - 1u;
+  PCSAMP_TIM->ARR = reload - 1u;
+  PCSAMP_TIM->CNT = 0u;
+  PCSAMP_TIM->EGR = TIM_EGR_UG;   /* loads PSC, sets UIF */
+  PCSAMP_TIM->SR = 0u;
+  PCSAMP_TIM->DIER = TIM_DIER_UIE;
+  PCSAMP_TIM->CR1 = TIM_CR1_CEN;
+  return PCSAMP_OK;
+}
+
+/**
+ * @brief   Stops the timer and hands the samples to pcsamp_poll().
+ * @param   void
+ * @return  void
+ */
+void pcsamp_stop(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  PCSAMP_TIM->CR1 = 0u;
+  PCSAMP_TIM->DIER = 0u;
+  PCSAMP_TIM->SR = 0u;
+  if (PCSAMP_SAMPLING == state)
+  {
+    state = PCSAMP_DUMPING;
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Prints up to PCSAMP_LINES_PER_POLL lines of a finished capture,
+ *          so a long dump does not hold up the other tasks.
+ * @param   void
+ * @return  void
+ */
+void pcsamp_poll(void)
+{
+  uint32_t lines = 0u;
+
+  if (PCSAMP_DUMPING != state)
+  {
+    return;
+  }
+
+  if (0u == printed)
+  {
+    printf("pcsamp begin %lu %lu\n", (unsigned long)rate, (unsigned long)count);
+    printed = 1u;
+  }
+  while ((printed <= count) && (PCSAMP_LINES_PER_POLL > lines))
+  {
+    const pcsamp_sample *s = &samples[printed - 1u];
+
+    printf("$%08lx %08lx\n", (unsigned long)s->pc, (unsigned long)s->lr);
+    printed++;
+    lines++;
+  }
+  if (printed > count)
+  {
+    printf("pcsamp end\n");
+    state = PCSAMP_IDLE;
+  }
+}
+
+/**
+ * @brief   Stores the PC and LR of the preempted context, stops the timer
+ *          once the buffer is full.
+ * @param   *frame: Exception frame of the preempted context.
+ * @return  void
+ */
+void pcsamp_isr(const uint32_t *frame)
+{
+  uint32_t n = count;
+
+  PCSAMP_TIM->SR = ~TIM_SR_UIF;
+  if (PCSAMP_SAMPLING != state)
+  {
+    return;
+  }
+
+  samples[n].pc = frame[6];
+  samples[n].lr = frame[5];
+  n++;
+  count = n;
+  if (PCSAMP_DEPTH <= n)
+  {
+    PCSAMP_TIM->CR1 = 0u;
+    PCSAMP_TIM->DIER = 0u;
+    state = PCSAMP_DUMPING;
+  }
+}
+
+/**
+ * @brief   Sampling timer interrupt. Naked so the exception frame is where
+ *          the stack pointer of the preempted context points.
+ */
+__attribute__((naked)) void TIM5_IRQHandler(void)
+{
+  __ASM volatile (
+    "   tst     lr, #4              \n"
+    "   ite     eq                  \n"
+    "   mrseq   r0, msp             \n"
+    "   mrsne   r0, psp             \n"
+    "   b       pcsamp_isr          \n"
+  );
+}
@@ -0,0 +1,336 @@
+/*
+ * pool.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "pool.h"
+#include "lfqueue.h"
+#include <stdio.h>
+
+typedef struct {
+  const char *name;
+  uint8_t *base;
+  uint32_t block_size;
+  uint32_t count;
+  uint8_t lock_free;
+} pool_desc;
+
+typedef struct {
+  volatile uint32_t used;
+  volatile uint32_t high_water;
+  volatile uint32_t allocs;
+  volatile uint32_t failures;
+} pool_counters;
+
+/* Block storage, 8-byte aligned so any driver structure fits a block. */
+#define POOL_STORAGE(id, size, count, lock_free)                                       \
+  _Static_assert((0u != (size)) && (0u == ((size) % 8u)), #id ": block size must be a multiple of 8"); \
+  _Static_assert(0u != (count), #id ": pool must hold at least one block");           \
+  static uint64_t id##_storage[((size) / 8u) * (count)] POOL_SECTION;
+POOL_TABLE(POOL_STORAGE)
+#undef POOL_STORAGE
+
+#define POOL_DESC(id, size, count, lock_free) {#id, (uint8_t *)id##_storage, (size), (count), (lock_free)},
+static const pool_desc pools[POOL_COUNT] = {
+  POOL_TABLE(POOL_DESC)
+};
+#undef POOL_DESC
+
+/* Address of the first free block, the first word of a free block links the next one. */
+static volatile uint32_t heads[POOL_COUNT];
+static pool_counters counters[POOL_COUNT];
+
+/**
+ * @brief   Adds to a counter shared with interrupts.
+ * @param   *ptr:  Counter.
+ * @param   delta: Amount to add, may wrap to subtract.
+ * @return  The new value.
+ */
+static uint32_t pool_add(volatile uint32_t *ptr, uint32_t delta)
+{
+  uint32_t value;
+
+  do
+  {
+    value = *ptr;
+  } while (0u == lfq_cas(ptr, value, value + delta));
+
+  return value + delta;
+}
+
+/**
+ * @brief   Raises a maximum shared with interrupts.
+ * @param   *ptr:  Maximum.
+ * @param   value: Candidate.
+ * @return  void
+ */
+static void pool_raise(volatile uint32_t *ptr, uint32_t value)
+{
+  uint32_t max;
+
+  do
+  {
+    max = *ptr;
+    if (value <= max)
+    {
+      return;
+    }
+  } while (0u == lfq_cas(ptr, max, value));
+}
+
+/**
+ * @brief   Unlinks the first free block of a lock-free pool.
+ *          A plain compare-and-swap would suffer from ABA here: between
+ *          reading the head and its link an ISR may take that block and
+ *          give it back on top of another list. With LDREX/STREX any
+ *          exception in between clears the monitor and the STREX fails.
+ * @param   *head: Free list.
+ * @return  The block, NULL if the list is empty.
+ */
+static void *pool_pop(volatile uint32_t *head)
+{
+  uint32_t block;
+
+  do
+  {
+    block = __LDREXW(head);
+    if (0u == block)
+    {
+      __CLREX();
+      return NULL;
+    }
+  } while (0u != __STREXW(*(uint32_t *)block, head));
+
+  return (void *)block;
+}
+
+/**
+ * @brief   Takes one block without counting a failure.
+ * @param   id: Pool.
+ * @return  The block, NULL if the pool is empty.
+ */
+static void *pool_take(pool_id id)
+{
+  pool_counters *c = &counters[id];
+  void *block;
+
+  if (0u != pools[id].lock_free)
+  {
+    block = pool_pop(&heads[id]);
+    if (NULL != block)
+    {
+      pool_add(&c->allocs, 1u);
+      pool_raise(&c->high_water, pool_add(&c->used, 1u));
+    }
+  }
+  else
+  {
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    block = (void *)heads[id];
+    if (NULL != block)
+    {
+      heads[id] = *(uint32_t *)block;
+      c->allocs++;
+      c->used++;
+      if (c->used > c->high_water)
+      {
+        c->high_water = c->used;
+      }
+    }
+    __set_PRIMASK(primask);
+  }
+
+  return block;
+}
+
+/**
+ * @brief   Threads the free list of every pool through its blocks and
+ *          clears the statistics. Call before any allocation.
+ * @param   void
+ * @return  void
+ */
+void pool_init(void)
+{
+  for (uint32_t id = 0u; id < POOL_COUNT; id++)
+  {
+    const pool_desc *pool = &pools[id];
+
+    for (uint32_t i = 0u; i < pool->count; i++)
+    {
+      uint32_t *block = (uint32_t *)(pool->base + (i * pool->block_size));
+      *block = ((i + 1u) < pool->count) ? (uint32_t)(block) + pool->block_size : 0u;
+    }
+    heads[id] = (uint32_t)pool->base;
+    counters[id] = (pool_counters){0};
+  }
+}
+
+/**
+ * @brief   Takes one block from a pool in constant time. Callable from any
+ *          ISR when the pool is lock-free.
+ * @param   id: Pool.
+ * @return  The block, NULL if the pool is empty or does not exist.
+ */
+void *pool_alloc(pool_id id)
+{
+  void *block;
+
+  if (POOL_COUNT <= id)
+  {
+    return NULL;
+  }
+
+  block = pool_take(id);
+  if (NULL == block)
+  {
+    pool_add(&counters[id].failures, 1u);
+  }
+
+  return block;
+}
+
+/**
+ * @brief   Takes a block of at least size bytes. Tries the pools in table
+ *          order, so the table lists them from the smallest block up and
+ *          an empty pool spills into the next larger one.
+ * @param   size: Bytes needed.
+ * @return  The block, NULL if no pool with large enough blocks has one left.
+ */
+void *pool_alloc_size(size_t size)
+{
+  pool_id first = POOL_COUNT;
+
+  for (uint32_t id = 0u; id < POOL_COUNT; id++)
+  {
+    if (size <= pools[id].block_size)
+    {
+      void *block = pool_take((pool_id)id);
+
+      if (NULL != block)
+      {
+        return block;
+      }
+      if (POOL_COUNT == first)
+      {
+        first = (pool_id)id;
+      }
+    }
+  }
+
+  /* Charge the failure to the pool the size belongs to. */
+  if (POOL_COUNT != first)
+  {
+    pool_add(&counters[first].failures, 1u);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Gives a block back to the pool it came from. The owner is found
+ *          from the address, a pointer into the middle of a block or from
+ *          elsewhere is refused.
+ * @param   *block: Block from pool_alloc() or pool_alloc_size().
+ * @return  status: Report about the success of the release.
+ */
+pool_status pool_free(void *block)
+{
+  uint32_t address = (uint32_t)block;
+
+  for (uint32_t id = 0u; id < POOL_COUNT; id++)
+  {
+    const pool_desc *pool = &pools[id];
+    uint32_t offset = address - (uint32_t)pool->base;
+
+    if (offset >= (pool->block_size * pool->count))
+    {
+      continue;
+    }
+    if (0u != (offset % pool->block_size))
+    {
+      return POOL_ERROR_INVALID;
+    }
+
+    if (0u != pool->lock_free)
+    {
+      uint32_t next;
+
+      /* Pushing is ABA-safe: the link is written before the head moves. */
+      do
+      {
+        next = heads[id];
+        *(uint32_t *)block = next;
+      } while (0u == lfq_cas(&heads[id], next, address));
+      pool_add(&counters[id].used, (uint32_t)-1);
+    }
+    else
+    {
+      uint32_t primask = __get_PRIMASK();
+
+      __disable_irq();
+      *(uint32_t *)block = heads[id];
+      heads[id] = address;
+      counters[id].used--;
+      __set_PRIMASK(primask);
+    }
+
+    return POOL_OK;
+  }
+
+  return POOL_ERROR_INVALID;
+}
+
+/**
+ * @brief   Tells the block size of a pool.
+ * @param   id: Pool.
+ * @return  Bytes per block, 0 if the pool does not exist.
+ */
+uint32_t pool_block_size(pool_id id)
+{
+  return (POOL_COUNT > id) ? pools[id].block_size : 0u;
+}
+
+/**
+ * @brief   Reads the statistics of one pool.
+ * @param   id:     Pool.
+ * @param   *stats: Receives the counters.
+ * @return  status: Report about the success of the read.
+ */
+pool_status pool_get_stats(pool_id id, pool_stats *stats)
+{
+  if ((POOL_COUNT <= id) || (NULL == stats))
+  {
+    return POOL_ERROR_INVALID;
+  }
+
+  stats->used = counters[id].used;
+  stats->high_water = counters[id].high_water;
+  stats->allocs = counters[id].allocs;
+  stats->failures = counters[id].failures;
+
+  return POOL_OK;
+}
+
+/**
+ * @brief   Prints the usage of every pool.
+ * @param   void
+ * @return  void
+ */
+void pool_report(void)
+{
+  printf("pool         size  count   used   high     allocs   failed\n");
+  for (uint32_t id = 0u; id < POOL_COUNT; id++)
+  {
+    pool_stats s;
+
+    pool_get_stats((pool_id)id, &s);
+    printf("%-11s %5lu %6lu %6lu %6lu %10lu %8lu\n", pools[id].name,
+           (unsigned long)pools[id].block_size, (unsigned long)pools[id].count,
+           (unsigned long)s.used, (unsigned long)s.high_water,
+           (unsigned long)s.allocs, (unsigned long)s.failures);
+  }
+}
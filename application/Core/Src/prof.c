@@ -0,0 +1,197 @@
+/*
+ * prof.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "prof.h"
+#include "cycles.h"
+#include <stdio.h>
+#include <string.h>
+
+static prof_zone zones[PROF_MAX_ZONES];
+static uint32_t zone_count = 0u;
+/* Cycles of a back-to-back begin/end, taken off every sample. */
+static uint32_t overhead = 0u;
+
+/**
+ * @brief   Clears the statistics of one zone.
+ * @param   *zone: Zone.
+ * @return  void
+ */
+static void prof_clear(prof_zone *zone)
+{
+  const char *name = zone->name;
+
+  memset(zone, 0, sizeof(*zone));
+  zone->name = name;
+  zone->min = UINT32_MAX;
+}
+
+/**
+ * @brief   Starts the cycle counter, clears the table and measures the
+ *          cost of an empty zone.
+ * @param   void
+ * @return  void
+ */
+void prof_init(void)
+{
+  prof_zone probe = {0};
+  prof_mark mark;
+
+  cycles_init();
+  zone_count = 0u;
+  overhead = 0u;
+
+  prof_clear(&probe);
+  for (uint32_t i = 0u; i < 8u; i++)
+  {
+    mark.zone = &probe;
+    mark.start = cycles_now();
+    prof_end(mark);
+  }
+  overhead = probe.min;
+}
+
+/**
+ * @brief   Starts a sample. The zone is looked up by name or added to the
+ *          table the first time a call site runs; the site keeps it in
+ *          *slot so later calls skip the lookup.
+ * @param   **slot: Call site cache, NULL until the zone is known.
+ * @param   *name:  Zone name, must stay valid.
+ * @return  Start of the sample, for prof_end(). A full table leaves the
+ *          zone NULL and the sample is dropped.
+ */
+prof_mark prof_begin(prof_zone **slot, const char *name)
+{
+  prof_mark mark;
+
+  if (NULL == *slot)
+  {
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    for (uint32_t i = 0u; (NULL == *slot) && (i < zone_count); i++)
+    {
+      if (0 == strcmp(zones[i].name, name))
+      {
+        *slot = &zones[i];
+      }
+    }
+    if ((NULL == *slot) && (PROF_MAX_ZONES > zone_count))
+    {
+      zones[zone_count].name = name;
+      prof_clear(&zones[zone_count]);
+      *slot = &zones[zone_count++];
+    }
+    __set_PRIMASK(primask);
+  }
+
+  mark.zone = *slot;
+  mark.start = cycles_now();
+  return mark;
+}
+
+/**
+ * @brief   Ends a sample and adds it to its zone.
+ * @param   mark: Returned by prof_begin().
+ * @return  void
+ */
+void prof_end(prof_mark mark)
+{
+  uint32_t cycles = cycles_now() - mark.start;
+  prof_zone *zone = mark.zone;
+
+  if (NULL == zone)
+  {
+    return;
+  }
+  cycles = (cycles > overhead) ? (cycles - overhead) : 0u;
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  zone->count++;
+  zone->total += cycles;
+  if (cycles < zone->min)
+  {
+    zone->min = cycles;
+  }
+  if (cycles > zone->max)
+  {
+    zone->max = cycles;
+  }
+  zone->hist[31u - __CLZ(cycles | 1u)]++;
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Ends the sample of a PROF_SCOPE when its block is left.
+ * @param   *mark: The scope's mark.
+ * @return  void
+ */
+void prof_scope_end(prof_mark *mark)
+{
+  prof_end(*mark);
+}
+
+/**
+ * @brief   Clears the statistics of every zone, the zones stay registered.
+ * @param   void
+ * @return  void
+ */
+void prof_reset(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  for (uint32_t i = 0u; i < zone_count; i++)
+  {
+    prof_clear(&zones[i]);
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Prints every zone in cycles, and the non-empty histogram bins
+ *          as lower bound:count.
+ * @param   void
+ * @return  void
+ */
+void prof_report(void)
+{
+  uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+  uint32_t count = zone_count;
+
+  printf("zone                  count        min        max       mean    mean_us\n");
+  for (uint32_t i = 0u; i < count; i++)
+  {
+    prof_zone z;
+    uint32_t primask = __get_PRIMASK();
+    uint32_t mean = 0u;
+
+    __disable_irq();
+    z = zones[i];
+    __set_PRIMASK(primask);
+
+    if (0u == z.count)
+    {
+      printf("%-18s %8lu\n", z.name, 0ul);
+      continue;
+    }
+    mean = (uint32_t)(z.total / z.count);
+    printf("%-18s %8lu %10lu %10lu %10lu %10lu\n", z.name, (unsigned long)z.count,
+           (unsigned long)z.min, (unsigned long)z.max, (unsigned long)mean,
+           (unsigned long)(mean / cycles_per_us));
+    printf("  hist");
+    for (uint32_t bin = 0u; bin < PROF_HIST_BINS; bin++)
+    {
+      if (0u != z.hist[bin])
+      {
+        printf(" %lu:%lu", (unsigned long)(1ul << bin), (unsigned long)z.hist[bin]);
+      }
+    }
+    printf("\n");
+  }
+  printf("zone overhead %lu cycles, removed\n", (unsigned long)overhead);
+}
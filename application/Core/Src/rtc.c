@@ -0,0 +1,428 @@
+/*
+ * rtc.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "rtc.h"
+#include "softclock.h"
+#include "scheduler.h"
+#include <stdio.h>
+
+/* rtc_sync() only sets the target this close after a second boundary of the reference. */
+#define RTC_SYNC_WINDOW_US    2000u
+/* Shortest calibration interval, shorter ones resolve too little. */
+#define RTC_CAL_MIN_S         10u
+/* Offsets beyond this after a calibration set the target again. */
+#define RTC_RESYNC_US         500000
+/* Scheduler priority of the discipline task. */
+#define RTC_TASK_PRIO         2u
+/* Posted to the discipline task on each SQW edge of the DS1307. */
+#define RTC_SIG_EDGE          SCHED_SIG_USER
+
+#ifndef RTC_FIXED_BACKEND
+static const rtc_backend *current = &RTC_DEFAULT_BACKEND;
+#define RTC_CURRENT  current
+#else
+#define RTC_CURRENT  (&RTC_DEFAULT_BACKEND)
+#endif
+
+/* Discipline task state. */
+static struct {
+  sched_task_id task;
+  const rtc_backend *ref;
+  uint32_t period_s;
+  uint32_t elapsed_s;
+  uint8_t running;
+  uint8_t synced;
+  rtc_calibration cal;
+  uint32_t syncs;
+  uint32_t calibrations;
+  int32_t last_drift_ppb;
+  int32_t last_offset_us;
+} discipline;
+
+/*-----------------------------------------------DS1307 backend-------------------------------------------------------*/
+
+/**
+ * @brief   The DS1307 is brought up by ds1307_init() and softclock_init(),
+ *          this only checks that it answers.
+ * @param   void
+ * @return  status: RTC_ERROR_HW if the chip does not answer.
+ */
+static rtc_status rtc_ds1307_init(void)
+{
+  ds1307_time_t time;
+
+  return (TM_DS1307_Result_Ok == ds1307_read_time(&time)) ? RTC_OK : RTC_ERROR_HW;
+}
+
+/**
+ * @brief   Reads the software clock, or the chip itself while the software
+ *          clock is not synced (whole seconds only, blocking).
+ * @param   *t:    Receives the time.
+ * @param   *usec: Receives the microseconds into the second, may be NULL.
+ * @return  status: RTC_ERROR_HW if the chip had to be read and did not answer.
+ */
+static rtc_status rtc_ds1307_now(epoch_t *t, uint32_t *usec)
+{
+  softclock_time now;
+  ds1307_time_t time;
+
+  if (SOFTCLOCK_OK == softclock_now(&now))
+  {
+    *t = now.epoch;
+    if (NULL != usec)
+    {
+      *usec = now.usec;
+    }
+    return RTC_OK;
+  }
+
+  if (TM_DS1307_Result_Ok != ds1307_read_time(&time))
+  {
+    return RTC_ERROR_HW;
+  }
+  *t = ds1307_time_to_epoch(&time);
+  if (NULL != usec)
+  {
+    *usec = 0u;
+  }
+
+  return RTC_OK;
+}
+
+/**
+ * @brief   Writes the chip, which restarts its seconds divider, and makes
+ *          the software clock read it again.
+ * @param   t: Time to set.
+ * @return  status: RTC_ERROR_HW if the chip did not answer.
+ */
+static rtc_status rtc_ds1307_set(epoch_t t)
+{
+  ds1307_time_t time;
+
+  ds1307_time_from_epoch(t, &time);
+  if (TM_DS1307_Result_Ok != ds1307_write_time(&time))
+  {
+    return RTC_ERROR_HW;
+  }
+  softclock_resync();
+
+  return RTC_OK;
+}
+
+/* The DS1307 has no trimming, its drift is the crystal's. */
+const rtc_backend rtc_ds1307_backend = {
+  .name = "ds1307",
+  .init = rtc_ds1307_init,
+  .now = rtc_ds1307_now,
+  .set = rtc_ds1307_set,
+  .trim = NULL,
+};
+
+/*-----------------------------------------------Selection-------------------------------------------------------*/
+
+/**
+ * @brief   Initializes the default backend, RTC_DEFAULT_BACKEND.
+ * @param   void
+ * @return  status: Status of the backend init; RTC_ERROR_INVALID means it
+ *          runs but has no valid time yet.
+ */
+rtc_status rtc_init(void)
+{
+  return RTC_DEFAULT_BACKEND.init();
+}
+
+#ifndef RTC_FIXED_BACKEND
+/**
+ * @brief   Initializes a backend and makes rtc_now() use it. On a hard
+ *          error the previous backend stays selected.
+ * @param   *backend: Backend to use.
+ * @return  status: Status of the backend init.
+ */
+rtc_status rtc_select(const rtc_backend *backend)
+{
+  rtc_status status = backend->init();
+
+  if ((RTC_OK == status) || (RTC_ERROR_INVALID == status))
+  {
+    current = backend;
+  }
+
+  return status;
+}
+#endif
+
+/**
+ * @brief   Tells which backend rtc_now() uses.
+ * @param   void
+ * @return  Selected backend.
+ */
+const rtc_backend *rtc_current(void)
+{
+  return RTC_CURRENT;
+}
+
+/**
+ * @brief   Reads the current time from the selected backend.
+ * @param   *t:    Receives the time.
+ * @param   *usec: Receives the microseconds into the second, may be NULL.
+ * @return  status: Status of the backend read.
+ */
+rtc_status rtc_now(epoch_t *t, uint32_t *usec)
+{
+  return RTC_CURRENT->now(t, usec);
+}
+
+/*-----------------------------------------------Cross-calibration-------------------------------------------------------*/
+
+/**
+ * @brief   Sets target from ref, to be called right after a second
+ *          boundary of ref (the SQW edge for the DS1307) so the seconds of
+ *          both start together. Does not wait for the boundary.
+ * @param   *ref:    Source of the time.
+ * @param   *target: Backend to set.
+ * @return  status: RTC_ERROR_INVALID if ref has no sub-second time yet or
+ *          is more than RTC_SYNC_WINDOW_US into its second, else the status
+ *          of the read and of the set.
+ */
+rtc_status rtc_sync(const rtc_backend *ref, const rtc_backend *target)
+{
+  softclock_time now;
+  epoch_t t;
+  uint32_t usec;
+  rtc_status status;
+
+  /* Until the software clock runs the DS1307 only gives whole seconds, read over the bus. */
+  if ((&rtc_ds1307_backend == ref) && (SOFTCLOCK_OK != softclock_now(&now)))
+  {
+    return RTC_ERROR_INVALID;
+  }
+  status = ref->now(&t, &usec);
+  if (RTC_OK != status)
+  {
+    return status;
+  }
+  if (usec > RTC_SYNC_WINDOW_US)
+  {
+    return RTC_ERROR_INVALID;
+  }
+
+  return target->set(t);
+}
+
+/**
+ * @brief   Reads both sources: the target between two reads of the
+ *          reference, the reference taken as the mean of the two, so the
+ *          time spent in the reads cancels out.
+ * @param   *ref:       Reference.
+ * @param   *target:    Source compared with it.
+ * @param   *ref_us:    Receives the reference time in microseconds.
+ * @param   *target_us: Receives the target time in microseconds.
+ * @return  status: Status of the first failing read.
+ */
+static rtc_status rtc_sample(const rtc_backend *ref, const rtc_backend *target, uint64_t *ref_us, uint64_t *target_us)
+{
+  epoch_t t;
+  uint32_t usec;
+  uint64_t before;
+  rtc_status status;
+
+  status = ref->now(&t, &usec);
+  if (RTC_OK != status)
+  {
+    return status;
+  }
+  before = ((uint64_t)t * 1000000u) + usec;
+
+  status = target->now(&t, &usec);
+  if (RTC_OK != status)
+  {
+    return status;
+  }
+  *target_us = ((uint64_t)t * 1000000u) + usec;
+
+  status = ref->now(&t, &usec);
+  if (RTC_OK != status)
+  {
+    return status;
+  }
+  *ref_us = (before + ((uint64_t)t * 1000000u) + usec) / 2u;
+
+  return RTC_OK;
+}
+
+/**
+ * @brief   Starts a drift measurement of target against ref. Both must
+ *          keep running until rtc_calibrate_finish(); the longer the
+ *          interval, the finer the result.
+ * @param   *cal:    Measurement state.
+ * @param   *ref:    Reference.
+ * @param   *target: Source measured.
+ * @return  status: Status of the reads.
+ */
+rtc_status rtc_calibrate_start(rtc_calibration *cal, const rtc_backend *ref, const rtc_backend *target)
+{
+  cal->ref = ref;
+  cal->target = target;
+
+  return rtc_sample(ref, target, &cal->ref_us, &cal->target_us);
+}
+
+/**
+ * @brief   Ends a drift measurement started by rtc_calibrate_start().
+ * @param   *cal:       Measurement state, restarted from now on success.
+ * @param   *drift_ppb: Receives the drift, positive when target runs fast.
+ * @param   apply:      Non-zero to trim target by the drift.
+ * @return  status: RTC_ERROR if less than RTC_CAL_MIN_S passed or ref went
+ *          backwards, RTC_ERROR_SUPPORT if apply is set and the target
+ *          cannot be trimmed, else the status of the reads or of the trim.
+ */
+rtc_status rtc_calibrate_finish(rtc_calibration *cal, int32_t *drift_ppb, uint8_t apply)
+{
+  uint64_t ref_us;
+  uint64_t target_us;
+  int64_t d_ref;
+  int64_t d_target;
+  rtc_status status;
+
+  status = rtc_sample(cal->ref, cal->target, &ref_us, &target_us);
+  if (RTC_OK != status)
+  {
+    return status;
+  }
+  d_ref = (int64_t)(ref_us - cal->ref_us);
+  d_target = (int64_t)(target_us - cal->target_us);
+  if (d_ref < ((int64_t)RTC_CAL_MIN_S * 1000000))
+  {
+    return RTC_ERROR;
+  }
+  *drift_ppb = (int32_t)(((d_target - d_ref) * 1000000000) / d_ref);
+
+  cal->ref_us = ref_us;
+  cal->target_us = target_us;
+  if (0u != apply)
+  {
+    if (NULL == cal->target->trim)
+    {
+      return RTC_ERROR_SUPPORT;
+    }
+    status = cal->target->trim(*drift_ppb);
+  }
+
+  return status;
+}
+
+/*-----------------------------------------------Discipline-------------------------------------------------------*/
+
+/**
+ * @brief   Scheduler task, once a second and on each DS1307 SQW edge: sets
+ *          the selected backend from the reference on an edge, then
+ *          measures and trims its drift every period. It is set again if
+ *          it wandered off by more than RTC_RESYNC_US.
+ * @param   *evt: Scheduler event.
+ * @return  void
+ */
+static void rtc_discipline_task(const sched_event *evt)
+{
+  const rtc_backend *target = RTC_CURRENT;
+  int32_t drift;
+  rtc_status status;
+
+  if (target == discipline.ref)
+  {
+    return;
+  }
+
+  if (0u == discipline.synced)
+  {
+    if ((RTC_SIG_EDGE != evt->sig) && (&rtc_ds1307_backend == discipline.ref))
+    {
+      return;
+    }
+    if ((RTC_OK == rtc_sync(discipline.ref, target)) &&
+        (RTC_OK == rtc_calibrate_start(&discipline.cal, discipline.ref, target)))
+    {
+      discipline.synced = 1u;
+      discipline.elapsed_s = 0u;
+      discipline.syncs++;
+    }
+    return;
+  }
+
+  if (SCHED_SIG_TICK != evt->sig)
+  {
+    return;
+  }
+  if (++discipline.elapsed_s < discipline.period_s)
+  {
+    return;
+  }
+  discipline.elapsed_s = 0u;
+  status = rtc_calibrate_finish(&discipline.cal, &drift, (NULL != target->trim) ? 1u : 0u);
+  if ((RTC_OK != status) && (RTC_ERROR_SUPPORT != status))
+  {
+    /* Lost one of the sources, start over. */
+    discipline.synced = 0u;
+    return;
+  }
+  discipline.calibrations++;
+  discipline.last_drift_ppb = drift;
+  discipline.last_offset_us = (int32_t)((int64_t)(discipline.cal.target_us - discipline.cal.ref_us));
+  if ((discipline.last_offset_us > RTC_RESYNC_US) || (discipline.last_offset_us < -RTC_RESYNC_US))
+  {
+    discipline.synced = 0u;
+  }
+}
+
+/**
+ * @brief   Starts keeping the selected backend synced to ref and trimmed
+ *          by the drift measured against it. With the DS1307 as ref the
+ *          sync waits, without blocking, for an SQW edge once the software
+ *          clock is synced; other refs are tried once a second.
+ * @param   *ref:     Reference, typically rtc_ds1307_backend.
+ * @param   period_s: Seconds between two trims, at least RTC_CAL_MIN_S.
+ * @return  status: RTC_ERROR if already started or the task cannot run.
+ */
+rtc_status rtc_discipline_start(const rtc_backend *ref, uint32_t period_s)
+{
+  if ((0u != discipline.running) || (RTC_CAL_MIN_S > period_s))
+  {
+    return RTC_ERROR;
+  }
+  discipline.ref = ref;
+  discipline.period_s = period_s;
+  if ((SCHED_OK != sched_task_create("rtc", rtc_discipline_task, RTC_TASK_PRIO, &discipline.task)) ||
+      (SCHED_OK != sched_every(discipline.task, 1000u)))
+  {
+    return RTC_ERROR;
+  }
+  if (&rtc_ds1307_backend == ref)
+  {
+    softclock_notify(discipline.task, RTC_SIG_EDGE);
+  }
+  discipline.running = 1u;
+
+  return RTC_OK;
+}
+
+/**
+ * @brief   Prints the selected backend and the discipline state over the
+ *          console UART. offset is target minus reference at the last
+ *          calibration.
+ * @param   void
+ * @return  void
+ */
+void rtc_report(void)
+{
+  epoch_t t = 0u;
+  uint32_t usec = 0u;
+
+  (void)rtc_now(&t, &usec);
+  printf("rtc %s time %lu.%06lu syncs %lu calibrations %lu drift %ld ppb offset %ld us\n",
+         RTC_CURRENT->name, (unsigned long)t, (unsigned long)usec,
+         (unsigned long)discipline.syncs, (unsigned long)discipline.calibrations,
+         (long)discipline.last_drift_ppb, (long)discipline.last_offset_us);
+}
@@ -7,30 +7,27 @@
 
 #include "rtc_ds1307.h"
 #include "main.h"
+#include "prof.h"
 
-I2C_HandleTypeDef *_ds1307_ui2c;
+static i2c_device ds1307_dev;
+
+/* Last known CH bit, so a time write does not need to read it back first */
+static uint8_t ds1307_ch;
+/* Last known raw century byte, DS1307_CENT_UNKNOWN until read or written */
+#define DS1307_CENT_UNKNOWN 0xFF
+static uint8_t ds1307_cent = DS1307_CENT_UNKNOWN;
 
-typedef struct
-{
-	uint8_t seconds; // Seconds, from 00 to 59
-	uint8_t minutes; // Minutes, from 00 to 59
-	uint8_t hours;	 // Hours, 24Hour mode, 00 to 23
-	uint8_t dow;	 // Day in a week, from 1 to 7
-	uint8_t date;	 // Date in a month, 1 to 31
-	uint8_t month;	 // Month in a year, 1 to 12
-	uint16_t year;	 // Year, 00 to 99, 00 is 2000 and 99 is 2099
-} ds1307_time_t;
 ds1307_time_t ds1307;
 
 /*-----------------------------------------------Init-------------------------------------------------------*/
 
 /**
  * @brief Initializes the DS1307 module. Sets clock halt bit to 0 to start timing.
- * @param hi2c User I2C handle pointer.
+ * @param bus Bus manager the DS1307 is attached to.
  */
-void ds1307_init(I2C_HandleTypeDef *hi2c)
+void ds1307_init(i2c_bus *bus)
 {
-  _ds1307_ui2c = hi2c;
+  i2c_device_init(&ds1307_dev, bus, "ds1307", DS1307_I2C_ADDR);
   ds1307_set_clock_halt(0);
 
   //Check if device is connected
@@ -48,6 +45,7 @@ void ds1307_set_clock_halt(uint8_t halt)
 {
   uint8_t clock_halt = (halt ? 1 << 7 : 0);
   ds1307_set_reg_byte(DS1307_REG_SECOND, clock_halt | (ds1307_get_reg_byte(DS1307_REG_SECOND) & 0x7f));
+  ds1307_ch = halt ? 1 : 0;
 }
 
 /**
@@ -56,7 +54,8 @@ void ds1307_set_clock_halt(uint8_t halt)
  */
 uint8_t ds1307_get_clock_halt(void)
 {
-  return (ds1307_get_reg_byte(DS1307_REG_SECOND) & 0x80) >> 7;
+  ds1307_ch = (ds1307_get_reg_byte(DS1307_REG_SECOND) & 0x80) >> 7;
+  return ds1307_ch;
 }
 
 /*-----------------------------------------------Get - Set Register-------------------------------------------------------*/
@@ -69,7 +68,7 @@ uint8_t ds1307_get_clock_halt(void)
 void ds1307_set_reg_byte(uint8_t regAddr, uint8_t val)
 {
   uint8_t bytes[2] = {regAddr, val};
-  HAL_I2C_Master_Transmit(_ds1307_ui2c, DS1307_I2C_ADDR << 1, bytes, 2, DS1307_TIMEOUT);
+  i2c_dev_write(&ds1307_dev, bytes, 2);
 }
 
 /**
@@ -79,9 +78,8 @@ void ds1307_set_reg_byte(uint8_t regAddr, uint8_t val)
  */
 uint8_t ds1307_get_reg_byte(uint8_t regAddr)
 {
-  uint8_t val;
-  HAL_I2C_Master_Transmit(_ds1307_ui2c, DS1307_I2C_ADDR << 1, &regAddr, 1, DS1307_TIMEOUT);
-  HAL_I2C_Master_Receive(_ds1307_ui2c, DS1307_I2C_ADDR << 1, &val, 1, DS1307_TIMEOUT);
+  uint8_t val = 0;
+  i2c_dev_write_read(&ds1307_dev, &regAddr, 1, &val, 1);
   return val;
 }
 
@@ -118,8 +116,9 @@ void ds1307_enable_output_pin(ds1307_output_frequency_t frequency)
     {
         temp = 0;
     }
-    // Write to register
-    ds1307_set_reg_byte(DS1307_REG_CONTROL, temp);
+    // Write to register, posted: no caller needs the result
+    uint8_t bytes[2] = {DS1307_REG_CONTROL, temp};
+    (void)i2c_dev_post_write(&ds1307_dev, bytes, 2);
 }
 
 /** Disable SQW/OUT pin 
@@ -138,15 +137,59 @@ void ds1307_disable_output_pin(void)
 */
 void ds1307_get_date_time()
 {
-    uint16_t cen;
-    ds1307.seconds=ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_SECOND) & 0x7f);
-    ds1307.minutes=ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_MINUTE));
-    ds1307.hours=ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_HOUR) & 0x3f);
-    ds1307.dow=ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_DOW));
-    ds1307.date=ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_DATE));
-    ds1307.month=ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_MONTH));
-    cen = ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_CENT));
-    ds1307.year=ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_YEAR)) + (cen * 100);
+    PROF_SCOPE(ds1307_get_date_time);
+    ds1307_read_time(&ds1307);
+}
+
+/**
+ * @brief Reads seconds to century in one write-then-read transaction. The
+ *        DS1307 copies the time registers to its read buffer on START, so
+ *        the fields are consistent with each other, unlike per-register reads
+ *        that can straddle a rollover.
+ * @param time Receives the date and time.
+ * @return TM_DS1307_Result_Ok, or TM_DS1307_Result_Error if the transfer failed.
+ */
+ds1307_result_t ds1307_read_time(ds1307_time_t *time)
+{
+  uint8_t reg = DS1307_REG_SECOND;
+  uint8_t raw[DS1307_BURST_LEN];
+
+  if (I2C_BUS_OK != i2c_dev_write_read(&ds1307_dev, &reg, 1, raw, sizeof(raw)))
+  {
+    return TM_DS1307_Result_Error;
+  }
+
+  ds1307_decode_time(raw, time);
+  return TM_DS1307_Result_Ok;
+}
+
+/**
+ * @brief Decodes a burst read of the time registers, for callers that read
+ *        them with their own asynchronous request.
+ * @param raw  DS1307_BURST_LEN registers from DS1307_REG_SECOND on.
+ * @param time Receives the date and time.
+ * @return None
+ */
+void ds1307_decode_time(const uint8_t *raw, ds1307_time_t *time)
+{
+  time->seconds = ds1307_bcd_to_bin(raw[DS1307_REG_SECOND] & 0x7f);
+  time->minutes = ds1307_bcd_to_bin(raw[DS1307_REG_MINUTE]);
+  time->hours = ds1307_bcd_to_bin(raw[DS1307_REG_HOUR] & 0x3f);
+  time->dow = ds1307_bcd_to_bin(raw[DS1307_REG_DOW]);
+  time->date = ds1307_bcd_to_bin(raw[DS1307_REG_DATE]);
+  time->month = ds1307_bcd_to_bin(raw[DS1307_REG_MONTH]);
+  time->year = ds1307_bcd_to_bin(raw[DS1307_REG_YEAR]) + (ds1307_bcd_to_bin(raw[DS1307_REG_CENT]) * 100);
+  ds1307_ch = raw[DS1307_REG_SECOND] >> 7;
+  ds1307_cent = raw[DS1307_REG_CENT];
+}
+
+/**
+ * @brief Gives the bus device of the DS1307, for callers that queue their own requests.
+ * @return Device registered by ds1307_init().
+ */
+i2c_device *ds1307_get_device(void)
+{
+  return &ds1307_dev;
 }
 
 /**
@@ -155,7 +198,7 @@ void ds1307_get_date_time()
  */
 uint8_t ds1307_get_dayofweek(void)
 {
-  return ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_DOW));
+  return ds1307_bcd_to_bin(ds1307_get_reg_byte(DS1307_REG_DOW));
 }
 
 /**
@@ -164,7 +207,7 @@ uint8_t ds1307_get_dayofweek(void)
  */
 uint8_t ds1307_get_date(void)
 {
-  return ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_DATE));
+  return ds1307_bcd_to_bin(ds1307_get_reg_byte(DS1307_REG_DATE));
 }
 
 /**
@@ -173,7 +216,7 @@ uint8_t ds1307_get_date(void)
  */
 uint8_t ds1307_get_month(void)
 {
-  return ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_MONTH));
+  return ds1307_bcd_to_bin(ds1307_get_reg_byte(DS1307_REG_MONTH));
 }
 
 /**
@@ -182,8 +225,8 @@ uint8_t ds1307_get_month(void)
  */
 uint16_t ds1307_get_year(void)
 {
-  uint16_t cen = ds1307_get_reg_byte(DS1307_REG_CENT) * 100;
-  return ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_YEAR)) + cen;
+  uint16_t cen = ds1307_bcd_to_bin(ds1307_get_reg_byte(DS1307_REG_CENT)) * 100;
+  return ds1307_bcd_to_bin(ds1307_get_reg_byte(DS1307_REG_YEAR)) + cen;
 }
 
 /**
@@ -192,7 +235,7 @@ uint16_t ds1307_get_year(void)
  */
 uint8_t ds1307_get_hour(void)
 {
-  return ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_HOUR) & 0x3f);
+  return ds1307_bcd_to_bin(ds1307_get_reg_byte(DS1307_REG_HOUR) & 0x3f);
 }
 
 /**
@@ -201,7 +244,7 @@ uint8_t ds1307_get_hour(void)
  */
 uint8_t ds1307_get_minute(void)
 {
-  return ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_MINUTE));
+  return ds1307_bcd_to_bin(ds1307_get_reg_byte(DS1307_REG_MINUTE));
 }
 
 /**
@@ -210,7 +253,7 @@ uint8_t ds1307_get_minute(void)
  */
 uint8_t ds1307_get_second(void)
 {
-  return ds1307_bin_to_bcd(ds1307_get_reg_byte(DS1307_REG_SECOND) & 0x7f);
+  return ds1307_bcd_to_bin(ds1307_get_reg_byte(DS1307_REG_SECOND) & 0x7f);
 }
 
 /*----------------------------------------------Set Time-------------------------------------------------------*/
@@ -224,19 +267,74 @@ void ds1307_set_time_zone(int8_t hour, uint8_t min)
     ds1307_set_reg_byte(DS1307_REG_UTC_MIN, min);
 }
 
+/**
+ * @brief Reads the time zone stored by ds1307_set_time_zone(), in one transaction.
+ * @param hour Receives the hours east of UTC.
+ * @param min Receives the extra minutes.
+ * @return TM_DS1307_Result_Ok, or TM_DS1307_Result_Error if the transfer failed.
+ */
+ds1307_result_t ds1307_get_time_zone(int8_t *hour, uint8_t *min)
+{
+  uint8_t raw[2];
+
+  if (TM_DS1307_Result_Ok != ds1307_read_nvram(DS1307_REG_UTC_HR - DS1307_REG_NVRAM, raw, sizeof(raw)))
+  {
+    return TM_DS1307_Result_Error;
+  }
+  *hour = (int8_t)raw[0];
+  *min = raw[1];
+  return TM_DS1307_Result_Ok;
+}
+
 /**
  * Set full time
 */
 void ds1307_set_date_time(uint8_t second, uint8_t minute, uint8_t hour_24mode, uint8_t dayofweek, uint8_t date, uint8_t month, uint16_t year)
 {
-    ds1307_set_reg_byte(DS1307_REG_SECOND, ds1307_bcd_to_bin(second | ds1307_get_clock_halt())); //second Second, 0 to 59
-    ds1307_set_reg_byte(DS1307_REG_MINUTE, ds1307_bcd_to_bin(minute));  //minute Minute, 0 to 59
-    ds1307_set_reg_byte(DS1307_REG_HOUR, ds1307_bcd_to_bin(hour_24mode & 0x3f));//hour_24mode Hour in 24h format, 0 to 23.
-    ds1307_set_reg_byte(DS1307_REG_DOW, ds1307_bcd_to_bin(dayofweek));  //dayOfWeek - Days since last Sunday, 1 to 7.
-    ds1307_set_reg_byte(DS1307_REG_DATE, ds1307_bcd_to_bin(date));      //date - Day of month, 1 to 31.
-    ds1307_set_reg_byte(DS1307_REG_MONTH, ds1307_bcd_to_bin(month));    //month - Month, 1 to 12.
-    ds1307_set_reg_byte(DS1307_REG_CENT, ds1307_bcd_to_bin(year / 100));                   //year - Year, 2000 - 2099
-    ds1307_set_reg_byte(DS1307_REG_YEAR, ds1307_bcd_to_bin(year % 100));// ex: 2023 --> CENT=20 and YEAR=23
+    ds1307_time_t time = {second, minute, hour_24mode, dayofweek, date, month, year};
+    ds1307_write_time(&time);
+}
+
+/**
+ * @brief Writes seconds to year in one transaction. Writing the seconds
+ *        register resets the DS1307 countdown chain, so no rollover can land
+ *        between the fields. The CH bit is kept from the cached value. The
+ *        century sits apart in NVRAM and the chip never changes it, so it
+ *        takes a second transaction only when it differs from the last one
+ *        read or written.
+ * @param time Date and time to set, year 2000 to 2099.
+ * @return TM_DS1307_Result_Ok, or TM_DS1307_Result_Error if a transfer failed.
+ */
+ds1307_result_t ds1307_write_time(const ds1307_time_t *time)
+{
+  uint8_t cent = ds1307_bin_to_bcd(time->year / 100);
+  uint8_t bytes[1 + DS1307_REG_YEAR + 1] = {
+    DS1307_REG_SECOND,
+    ds1307_bin_to_bcd(time->seconds) | (ds1307_ch << 7),
+    ds1307_bin_to_bcd(time->minutes),
+    ds1307_bin_to_bcd(time->hours & 0x3f),
+    ds1307_bin_to_bcd(time->dow),
+    ds1307_bin_to_bcd(time->date),
+    ds1307_bin_to_bcd(time->month),
+    ds1307_bin_to_bcd(time->year % 100)
+  };
+
+  if (I2C_BUS_OK != i2c_dev_write(&ds1307_dev, bytes, sizeof(bytes)))
+  {
+    return TM_DS1307_Result_Error;
+  }
+  if (cent != ds1307_cent)
+  {
+    uint8_t cent_bytes[2] = {DS1307_REG_CENT, cent};
+
+    if (I2C_BUS_OK != i2c_dev_write(&ds1307_dev, cent_bytes, sizeof(cent_bytes)))
+    {
+      ds1307_cent = DS1307_CENT_UNKNOWN;
+      return TM_DS1307_Result_Error;
+    }
+    ds1307_cent = cent;
+  }
+  return TM_DS1307_Result_Ok;
 }
 
 /**
@@ -245,7 +343,7 @@ void ds1307_set_date_time(uint8_t second, uint8_t minute, uint8_t hour_24mode, u
  */
 void ds1307_set_dayofweek(uint8_t dayofweek)
 {
-  ds1307_set_reg_byte(DS1307_REG_DOW, ds1307_bcd_to_bin(dayofweek));
+  ds1307_set_reg_byte(DS1307_REG_DOW, ds1307_bin_to_bcd(dayofweek));
 }
 
 /**
@@ -254,7 +352,7 @@ void ds1307_set_dayofweek(uint8_t dayofweek)
  */
 void ds1307_set_date(uint8_t date)
 {
-  ds1307_set_reg_byte(DS1307_REG_DATE, ds1307_bcd_to_bin(date));
+  ds1307_set_reg_byte(DS1307_REG_DATE, ds1307_bin_to_bcd(date));
 }
 
 /**
@@ -263,7 +361,7 @@ void ds1307_set_date(uint8_t date)
  */
 void ds1307_set_month(uint8_t month)
 {
-  ds1307_set_reg_byte(DS1307_REG_MONTH, ds1307_bcd_to_bin(month));
+  ds1307_set_reg_byte(DS1307_REG_MONTH, ds1307_bin_to_bcd(month));
 }
 
 /**
@@ -272,8 +370,9 @@ void ds1307_set_month(uint8_t month)
  */
 void ds1307_set_year(uint16_t year)
 {
-  ds1307_set_reg_byte(DS1307_REG_CENT, year / 100);
-  ds1307_set_reg_byte(DS1307_REG_YEAR, ds1307_bcd_to_bin(year % 100));
+  ds1307_cent = ds1307_bin_to_bcd(year / 100);
+  ds1307_set_reg_byte(DS1307_REG_CENT, ds1307_cent);
+  ds1307_set_reg_byte(DS1307_REG_YEAR, ds1307_bin_to_bcd(year % 100));
 }
 
 /**
@@ -282,7 +381,7 @@ void ds1307_set_year(uint16_t year)
  */
 void ds1307_set_hour(uint8_t hour_24mode)
 {
-  ds1307_set_reg_byte(DS1307_REG_HOUR, ds1307_bcd_to_bin(hour_24mode & 0x3f));
+  ds1307_set_reg_byte(DS1307_REG_HOUR, ds1307_bin_to_bcd(hour_24mode & 0x3f));
 }
 
 /**
@@ -291,7 +390,7 @@ void ds1307_set_hour(uint8_t hour_24mode)
  */
 void ds1307_set_minute(uint8_t minute)
 {
-  ds1307_set_reg_byte(DS1307_REG_MINUTE, ds1307_bcd_to_bin(minute));
+  ds1307_set_reg_byte(DS1307_REG_MINUTE, ds1307_bin_to_bcd(minute));
 }
 
 /**
@@ -300,30 +399,119 @@ void ds1307_set_minute(uint8_t minute)
  */
 void ds1307_set_second(uint8_t second)
 {
-  uint8_t clock_halt = ds1307_get_clock_halt();
-  ds1307_set_reg_byte(DS1307_REG_SECOND, ds1307_bcd_to_bin(second | clock_halt));
+  ds1307_set_reg_byte(DS1307_REG_SECOND, ds1307_bin_to_bcd(second) | (ds1307_ch << 7));
+}
+
+/*-----------------------------------------------Epoch-------------------------------------------------------*/
+
+/**
+ * @brief Converts a date and time to Unix time.
+ * @param time Date and time, year 2000 to 2099; dow is ignored.
+ * @return Seconds since 1970-01-01 00:00:00.
+ */
+epoch_t ds1307_time_to_epoch(const ds1307_time_t *time)
+{
+  epoch_civil civil = {time->year, time->month, time->date, time->hours, time->minutes, time->seconds, 0};
+
+  return epoch_from_civil(&civil);
+}
+
+/**
+ * @brief Converts Unix time to a date and time.
+ * @param t Seconds since 1970-01-01 00:00:00.
+ * @param time Receives the date and time, dow 1 (Sunday) to 7.
+ */
+void ds1307_time_from_epoch(epoch_t t, ds1307_time_t *time)
+{
+  epoch_civil civil;
+
+  epoch_to_civil(t, &civil);
+  time->seconds = civil.seconds;
+  time->minutes = civil.minutes;
+  time->hours = civil.hours;
+  time->dow = civil.weekday + 1;
+  time->date = civil.date;
+  time->month = civil.month;
+  time->year = civil.year;
+}
+
+/*-----------------------------------------------NVRAM-------------------------------------------------------*/
+
+/**
+ * @brief Writes a block of battery-backed RAM in one transaction.
+ *        The driver itself keeps the time zone at offsets 0-1 and the
+ *        century at offset 8, see nvstore.h for the full map.
+ * @param offset First byte to write, 0 to DS1307_NVRAM_SIZE - 1.
+ * @param data Bytes to write.
+ * @param len Number of bytes, offset + len must not exceed DS1307_NVRAM_SIZE.
+ * @return TM_DS1307_Result_Ok, or TM_DS1307_Result_Error on a bad range or failed transfer.
+ */
+ds1307_result_t ds1307_write_nvram(uint8_t offset, const uint8_t *data, uint8_t len)
+{
+  uint8_t bytes[1 + DS1307_NVRAM_SIZE];
+
+  if ((len == 0) || (offset >= DS1307_NVRAM_SIZE) || (len > DS1307_NVRAM_SIZE - offset))
+  {
+    return TM_DS1307_Result_Error;
+  }
+  bytes[0] = DS1307_REG_NVRAM + offset;
+  for (uint8_t i = 0; i < len; i++)
+  {
+    bytes[1 + i] = data[i];
+  }
+  if (I2C_BUS_OK != i2c_dev_write(&ds1307_dev, bytes, 1 + len))
+  {
+    return TM_DS1307_Result_Error;
+  }
+  if ((offset <= DS1307_REG_CENT - DS1307_REG_NVRAM) && (offset + len > DS1307_REG_CENT - DS1307_REG_NVRAM))
+  {
+    ds1307_cent = data[DS1307_REG_CENT - DS1307_REG_NVRAM - offset];
+  }
+  return TM_DS1307_Result_Ok;
+}
+
+/**
+ * @brief Reads a block of battery-backed RAM in one transaction.
+ * @param offset First byte to read, 0 to DS1307_NVRAM_SIZE - 1.
+ * @param data Receives the bytes.
+ * @param len Number of bytes, offset + len must not exceed DS1307_NVRAM_SIZE.
+ * @return TM_DS1307_Result_Ok, or TM_DS1307_Result_Error on a bad range or failed transfer.
+ */
+ds1307_result_t ds1307_read_nvram(uint8_t offset, uint8_t *data, uint8_t len)
+{
+  uint8_t reg = DS1307_REG_NVRAM + offset;
+
+  if ((len == 0) || (offset >= DS1307_NVRAM_SIZE) || (len > DS1307_NVRAM_SIZE - offset))
+  {
+    return TM_DS1307_Result_Error;
+  }
+  if (I2C_BUS_OK != i2c_dev_write_read(&ds1307_dev, &reg, 1, data, len))
+  {
+    return TM_DS1307_Result_Error;
+  }
+  return TM_DS1307_Result_Ok;
 }
 
 /*-----------------------------------------------Convert BCD - BIN-------------------------------------------------------*/
 
 /**
  * @brief Decodes the raw binary value stored in registers to decimal format.
- * @param bin Binary-coded decimal value retrieved from register, 0 to 255.
+ * @param bcd Binary-coded decimal value retrieved from register, 0 to 255.
  * @return Decoded decimal value.
  */
-uint8_t ds1307_bin_to_bcd(uint8_t bin)
+uint8_t ds1307_bcd_to_bin(uint8_t bcd)
 {
-  return (((bin & 0xf0) >> 4) * 10) + (bin & 0x0f);
+  return (((bcd & 0xf0) >> 4) * 10) + (bcd & 0x0f);
 }
 
 /**
  * @brief Encodes a decimal number to binaty-coded decimal for storage in registers.
- * @param bcd BCD number to encode.
+ * @param bin Decimal number to encode, 0 to 99.
  * @return Encoded binary-coded decimal value.
  */
-uint8_t ds1307_bcd_to_bin(uint8_t bcd)
+uint8_t ds1307_bin_to_bcd(uint8_t bin)
 {
-  return (bcd % 10 + ((bcd / 10) << 4));
+  return (bin % 10 + ((bin / 10) << 4));
 }
 
 
@@ -0,0 +1,178 @@
+/*
+ * rtc_ds1307_bench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "rtc_ds1307.h"
+#include "cycles.h"
+#include <stdio.h>
+
+/* Timestamps read per path. */
+#define DS1307_BENCH_READS      32u
+/* Spins timed to calibrate the cost of one idle spin. */
+#define DS1307_BENCH_CALIBRATE  10000u
+
+/* Registers the per-register path reads, in the order ds1307_get_date_time() used to. */
+static const uint8_t legacy_regs[] = {
+  DS1307_REG_SECOND, DS1307_REG_MINUTE, DS1307_REG_HOUR, DS1307_REG_DOW,
+  DS1307_REG_DATE, DS1307_REG_MONTH, DS1307_REG_CENT, DS1307_REG_YEAR
+};
+
+typedef struct {
+  uint32_t wall_cycles;  /* submit of the first transfer to completion of the last */
+  uint32_t idle_cycles;  /* part of wall_cycles the CPU was free */
+  uint32_t transfers;
+  uint32_t errors;
+} ds1307_bench_result;
+
+/* Cycles taken by DS1307_BENCH_CALIBRATE spins with nothing else running. */
+static uint32_t calibrate_cycles;
+
+/**
+ * @brief   Spins while a request is pending. Interrupts steal cycles from
+ *          this loop, so the spins done tell how long the CPU was free.
+ *          Every spin polls the engine, which fails a stuck transfer after
+ *          its deadline and recovers the bus, as i2c_bus_wait() does.
+ * @param   *status: Status to watch.
+ * @param   limit:   Upper bound on the number of spins.
+ * @return  Number of spins.
+ */
+static uint32_t ds1307_bench_spin(const volatile uint8_t *status, uint32_t limit)
+{
+  uint32_t spins = 0u;
+
+  while ((I2C_BUS_PENDING == *status) && (spins < limit))
+  {
+    bsp_i2c_poll();
+    spins++;
+  }
+
+  return spins;
+}
+
+/**
+ * @brief   Runs one transfer on the DS1307 and accounts for it.
+ * @param   *res:   Accumulated result.
+ * @param   *tx:    Bytes to write.
+ * @param   tx_len: Number of bytes to write.
+ * @param   *rx:    Buffer for the bytes read, NULL if none.
+ * @param   rx_len: Number of bytes to read.
+ * @return  void
+ */
+static void ds1307_bench_xfer(ds1307_bench_result *res, uint8_t *tx, uint16_t tx_len,
+                              uint8_t *rx, uint16_t rx_len)
+{
+  i2c_request req;
+  uint32_t spins;
+
+  i2c_request_setup(&req, ds1307_get_device(), tx, tx_len, rx, rx_len);
+  res->transfers++;
+  if (I2C_BUS_OK != i2c_bus_submit(&req, 0u, I2C_BUS_NO_DEADLINE))
+  {
+    res->errors++;
+    return;
+  }
+  spins = ds1307_bench_spin(&req.status, UINT32_MAX);
+  res->idle_cycles += (uint32_t)(((uint64_t)spins * calibrate_cycles) / DS1307_BENCH_CALIBRATE);
+  if (I2C_BUS_OK != req.status)
+  {
+    res->errors++;
+  }
+}
+
+/**
+ * @brief   Reads the date and time as ds1307_get_date_time() did before the
+ *          burst read: for each field a write of the register address, then
+ *          a one-byte read.
+ * @param   *res:  Accumulated result.
+ * @param   *time: Receives the date and time.
+ * @return  void
+ */
+static void ds1307_bench_legacy(ds1307_bench_result *res, ds1307_time_t *time)
+{
+  uint8_t raw[DS1307_BURST_LEN];
+  uint32_t start = cycles_now();
+
+  for (uint32_t i = 0u; i < sizeof(legacy_regs); i++)
+  {
+    uint8_t reg = legacy_regs[i];
+
+    ds1307_bench_xfer(res, &reg, 1u, NULL, 0u);
+    ds1307_bench_xfer(res, NULL, 0u, &raw[reg], 1u);
+  }
+  ds1307_decode_time(raw, time);
+  res->wall_cycles += cycles_now() - start;
+}
+
+/**
+ * @brief   Reads the date and time with one write-then-read transaction, as
+ *          ds1307_read_time() does.
+ * @param   *res:  Accumulated result.
+ * @param   *time: Receives the date and time.
+ * @return  void
+ */
+static void ds1307_bench_burst(ds1307_bench_result *res, ds1307_time_t *time)
+{
+  uint8_t reg = DS1307_REG_SECOND;
+  uint8_t raw[DS1307_BURST_LEN];
+  uint32_t start = cycles_now();
+
+  ds1307_bench_xfer(res, &reg, 1u, raw, sizeof(raw));
+  ds1307_decode_time(raw, time);
+  res->wall_cycles += cycles_now() - start;
+}
+
+/**
+ * @brief   Prints one row of the report, times per timestamp.
+ * @param   *name: Label of the path.
+ * @param   *res:  Accumulated result.
+ * @return  void
+ */
+static void ds1307_bench_print(const char *name, const ds1307_bench_result *res)
+{
+  uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+  uint32_t busy = (res->wall_cycles > res->idle_cycles) ? (res->wall_cycles - res->idle_cycles) : 0u;
+
+  printf("%-6s %9lu %9lu %9lu %7lu\n", name,
+         (unsigned long)(res->transfers / DS1307_BENCH_READS),
+         (unsigned long)(res->wall_cycles / DS1307_BENCH_READS / cycles_per_us),
+         (unsigned long)(busy / DS1307_BENCH_READS / cycles_per_us),
+         (unsigned long)res->errors);
+}
+
+/**
+ * @brief   Compares reading a timestamp register by register with the burst
+ *          read. bus_us is the wall time from the first submit to the last
+ *          completion, cpu_us the part of it spent in the driver, the I2C
+ *          and DMA interrupts and the decoding, measured by counting how
+ *          long an idle loop could run meanwhile. Both paths go through the
+ *          bus manager; with the former polling HAL calls cpu_us equalled
+ *          bus_us.
+ * @param   void
+ * @return  void
+ */
+void ds1307_bench(void)
+{
+  ds1307_bench_result legacy = {0};
+  ds1307_bench_result burst = {0};
+  ds1307_time_t time;
+  volatile uint8_t stuck = I2C_BUS_PENDING;
+  uint32_t start;
+
+  cycles_init();
+  start = cycles_now();
+  (void)ds1307_bench_spin(&stuck, DS1307_BENCH_CALIBRATE);
+  calibrate_cycles = cycles_now() - start;
+
+  for (uint32_t i = 0u; i < DS1307_BENCH_READS; i++)
+  {
+    ds1307_bench_legacy(&legacy, &time);
+    ds1307_bench_burst(&burst, &time);
+  }
+
+  printf("path   transfers    bus_us    cpu_us  errors\n");
+  ds1307_bench_print("legacy", &legacy);
+  ds1307_bench_print("burst", &burst);
+}
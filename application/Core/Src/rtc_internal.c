@@ -0,0 +1,401 @@
+/*
+ * rtc_internal.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "rtc_internal.h"
+#include "stm32f4xx_hal.h"
+
+/* Asynchronous prescaler, the larger the lower the consumption. */
+#define RTC_INTERNAL_PREDIV_A    127u
+/* Synchronous prescalers giving 1 Hz, also the subsecond resolution. */
+#define RTC_INTERNAL_PREDIV_S_LSE  ((LSE_VALUE / (RTC_INTERNAL_PREDIV_A + 1u)) - 1u)
+#define RTC_INTERNAL_PREDIV_S_LSI  ((LSI_VALUE / (RTC_INTERNAL_PREDIV_A + 1u)) - 1u)
+/* Bound on the register handshakes, INITF and RSF come within a few RTCCLK periods. */
+#define RTC_INTERNAL_TIMEOUT_MS  10u
+/* Smooth calibration range in pulses per 2^20 RTCCLK periods. */
+#define RTC_INTERNAL_CAL_MIN     (-511)
+#define RTC_INTERNAL_CAL_MAX     512
+
+/* 2000-01-01, a Saturday, in DR layout. */
+#define RTC_INTERNAL_DR_RESET    ((6u << RTC_DR_WDU_Pos) | (1u << RTC_DR_MU_Pos) | (1u << RTC_DR_DU_Pos))
+
+static rtc_internal_clock clock_source;
+static uint32_t prediv_s;
+static uint32_t usec_mult;  /* microseconds per subsecond count, 20.12 fixed point */
+/* Last DR read and its day number, the date changes once a day. */
+static uint32_t cached_dr;
+static uint32_t cached_days;
+
+static uint8_t rtc_internal_bcd(uint32_t reg, uint32_t tens_pos, uint32_t tens_mask, uint32_t units_pos)
+{
+  return (uint8_t)((((reg >> tens_pos) & tens_mask) * 10u) + ((reg >> units_pos) & 0x0Fu));
+}
+
+static uint32_t rtc_internal_to_bcd(uint32_t bin)
+{
+  return ((bin / 10u) << 4) | (bin % 10u);
+}
+
+/**
+ * @brief   Records the synchronous prescaler and the subsecond scale.
+ * @param   s: PREDIV_S value.
+ * @return  void
+ */
+static void rtc_internal_set_prediv(uint32_t s)
+{
+  prediv_s = s;
+  usec_mult = (1000000u << 12) / (s + 1u);
+}
+
+/**
+ * @brief   Waits for bits of RTC->ISR to be set.
+ * @param   mask: Bits to wait for.
+ * @return  status: RTC_ERROR_HW if they did not come.
+ */
+static rtc_status rtc_internal_wait(uint32_t mask)
+{
+  uint32_t start = HAL_GetTick();
+
+  while (mask != (RTC->ISR & mask))
+  {
+    if ((HAL_GetTick() - start) > RTC_INTERNAL_TIMEOUT_MS)
+    {
+      return RTC_ERROR_HW;
+    }
+  }
+
+  return RTC_OK;
+}
+
+/**
+ * @brief   Unlocks the RTC registers and stops the calendar for an update.
+ * @param   void
+ * @return  status: RTC_ERROR_HW if init mode was not entered.
+ */
+static rtc_status rtc_internal_enter_init(void)
+{
+  RTC->WPR = 0xCAu;
+  RTC->WPR = 0x53u;
+  if (0u == (RTC->ISR & RTC_ISR_INITF))
+  {
+    /* Writing ones leaves the rc_w0 flags alone. */
+    RTC->ISR = 0xFFFFFFFFu;
+    if (RTC_OK != rtc_internal_wait(RTC_ISR_INITF))
+    {
+      RTC->WPR = 0xFFu;
+      return RTC_ERROR_HW;
+    }
+  }
+
+  return RTC_OK;
+}
+
+/**
+ * @brief   Restarts the calendar, locks the registers and waits for the
+ *          shadow registers to hold the new values.
+ * @param   void
+ * @return  status: RTC_ERROR_HW if the shadow registers did not update.
+ */
+static rtc_status rtc_internal_exit_init(void)
+{
+  RTC->ISR &= ~(RTC_ISR_INIT | RTC_ISR_RSF);
+  RTC->WPR = 0xFFu;
+  cached_dr = 0u;
+
+  return rtc_internal_wait(RTC_ISR_RSF);
+}
+
+/**
+ * @brief   Starts the LSE, or the LSI if the crystal does not oscillate.
+ * @param   void
+ * @return  RTCSEL value for the clock that runs, 0 if none.
+ */
+static uint32_t rtc_internal_start_clock(void)
+{
+  uint32_t start = HAL_GetTick();
+
+  RCC->BDCR |= RCC_BDCR_LSEON;
+  while (0u == (RCC->BDCR & RCC_BDCR_LSERDY))
+  {
+    if ((HAL_GetTick() - start) > LSE_STARTUP_TIMEOUT)
+    {
+      break;
+    }
+  }
+  if (0u != (RCC->BDCR & RCC_BDCR_LSERDY))
+  {
+    clock_source = RTC_INTERNAL_LSE;
+    rtc_internal_set_prediv(RTC_INTERNAL_PREDIV_S_LSE);
+    return RCC_BDCR_RTCSEL_0;
+  }
+
+  RCC->BDCR &= ~RCC_BDCR_LSEON;
+  RCC->CSR |= RCC_CSR_LSION;
+  start = HAL_GetTick();
+  while (0u == (RCC->CSR & RCC_CSR_LSIRDY))
+  {
+    if ((HAL_GetTick() - start) > RTC_INTERNAL_TIMEOUT_MS)
+    {
+      return 0u;
+    }
+  }
+  clock_source = RTC_INTERNAL_LSI;
+  rtc_internal_set_prediv(RTC_INTERNAL_PREDIV_S_LSI);
+
+  return RCC_BDCR_RTCSEL_1;
+}
+
+/**
+ * @brief   Brings the RTC up. A calendar already running in the backup
+ *          domain is kept; otherwise the clock is started (up to
+ *          LSE_STARTUP_TIMEOUT when there is no crystal) and the calendar
+ *          set to 2000-01-01.
+ * @param   void
+ * @return  status: RTC_ERROR_INVALID if the calendar had to be reset.
+ */
+static rtc_status rtc_internal_init(void)
+{
+  uint32_t rtcsel;
+
+  RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+  (void)RCC->APB1ENR;
+  PWR->CR |= PWR_CR_DBP;
+
+  if ((0u != (RCC->BDCR & RCC_BDCR_RTCEN)) && (0u != (RTC->ISR & RTC_ISR_INITS)))
+  {
+    if (RCC_BDCR_RTCSEL_1 == (RCC->BDCR & RCC_BDCR_RTCSEL))
+    {
+      /* The LSI stops with the core domain. */
+      RCC->CSR |= RCC_CSR_LSION;
+      clock_source = RTC_INTERNAL_LSI;
+    }
+    else
+    {
+      clock_source = RTC_INTERNAL_LSE;
+    }
+    rtc_internal_set_prediv((RTC->PRER & RTC_PRER_PREDIV_S_Msk) >> RTC_PRER_PREDIV_S_Pos);
+    RTC->ISR &= ~RTC_ISR_RSF;
+    return rtc_internal_wait(RTC_ISR_RSF);
+  }
+
+  /* RTCSEL can only be changed through a backup domain reset. */
+  if (0u != (RCC->BDCR & RCC_BDCR_RTCSEL))
+  {
+    RCC->BDCR |= RCC_BDCR_BDRST;
+    RCC->BDCR &= ~RCC_BDCR_BDRST;
+  }
+  rtcsel = rtc_internal_start_clock();
+  if (0u == rtcsel)
+  {
+    clock_source = RTC_INTERNAL_NONE;
+    return RTC_ERROR_HW;
+  }
+  RCC->BDCR |= rtcsel;
+  RCC->BDCR |= RCC_BDCR_RTCEN;
+
+  if (RTC_OK != rtc_internal_enter_init())
+  {
+    return RTC_ERROR_HW;
+  }
+  RTC->CR &= ~RTC_CR_FMT;
+  RTC->PRER = prediv_s << RTC_PRER_PREDIV_S_Pos;
+  RTC->PRER |= RTC_INTERNAL_PREDIV_A << RTC_PRER_PREDIV_A_Pos;
+  RTC->TR = 0u;
+  RTC->DR = RTC_INTERNAL_DR_RESET;
+  if (RTC_OK != rtc_internal_exit_init())
+  {
+    return RTC_ERROR_HW;
+  }
+
+  return RTC_ERROR_INVALID;
+}
+
+/**
+ * @brief   Reads the calendar. Reading SSR freezes TR and DR until DR is
+ *          read, so the three agree; interrupts are masked so nothing else
+ *          reads in between.
+ * @param   *t:    Receives the time.
+ * @param   *usec: Receives the microseconds into the second, may be NULL.
+ * @return  status: RTC_ERROR_INVALID if the RTC never started.
+ */
+static rtc_status rtc_internal_now(epoch_t *t, uint32_t *usec)
+{
+  uint32_t primask;
+  uint32_t ssr;
+  uint32_t tr;
+  uint32_t dr;
+
+  if (RTC_INTERNAL_NONE == clock_source)
+  {
+    return RTC_ERROR_INVALID;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  ssr = RTC->SSR;
+  tr = RTC->TR;
+  dr = RTC->DR;
+  __set_PRIMASK(primask);
+
+  if (dr != cached_dr)
+  {
+    cached_days = epoch_days_from_civil((uint16_t)(RTC_INTERNAL_BASE_YEAR + rtc_internal_bcd(dr, RTC_DR_YT_Pos, 0x0Fu, RTC_DR_YU_Pos)),
+                                        rtc_internal_bcd(dr, RTC_DR_MT_Pos, 0x01u, RTC_DR_MU_Pos),
+                                        rtc_internal_bcd(dr, RTC_DR_DT_Pos, 0x03u, RTC_DR_DU_Pos));
+    cached_dr = dr;
+  }
+  *t = (cached_days * EPOCH_SECS_PER_DAY)
+     + ((uint32_t)rtc_internal_bcd(tr, RTC_TR_HT_Pos, 0x03u, RTC_TR_HU_Pos) * 3600u)
+     + ((uint32_t)rtc_internal_bcd(tr, RTC_TR_MNT_Pos, 0x07u, RTC_TR_MNU_Pos) * 60u)
+     + rtc_internal_bcd(tr, RTC_TR_ST_Pos, 0x07u, RTC_TR_SU_Pos);
+
+  if (NULL != usec)
+  {
+    /* SSR counts down from prediv_s; a pending shift can take it above. */
+    ssr = (ssr > prediv_s) ? prediv_s : ssr;
+    *usec = ((prediv_s - ssr) * usec_mult) >> 12;
+  }
+
+  return RTC_OK;
+}
+
+/**
+ * @brief   Sets the calendar; the prescalers restart, so the new second
+ *          starts when this returns.
+ * @param   t: Time to set, in 2000 to 2099.
+ * @return  status: Report about the success of the update.
+ */
+static rtc_status rtc_internal_set(epoch_t t)
+{
+  epoch_civil c;
+  rtc_status status;
+
+  if (RTC_INTERNAL_NONE == clock_source)
+  {
+    return RTC_ERROR_INVALID;
+  }
+  epoch_to_civil(t, &c);
+  if ((RTC_INTERNAL_BASE_YEAR > c.year) || ((RTC_INTERNAL_BASE_YEAR + 99u) < c.year))
+  {
+    return RTC_ERROR;
+  }
+
+  status = rtc_internal_enter_init();
+  if (RTC_OK != status)
+  {
+    return status;
+  }
+  RTC->TR = (rtc_internal_to_bcd(c.hours) << RTC_TR_HU_Pos)
+          | (rtc_internal_to_bcd(c.minutes) << RTC_TR_MNU_Pos)
+          | (rtc_internal_to_bcd(c.seconds) << RTC_TR_SU_Pos);
+  /* WDU is 1 (Monday) to 7 (Sunday). */
+  RTC->DR = (rtc_internal_to_bcd((uint32_t)c.year - RTC_INTERNAL_BASE_YEAR) << RTC_DR_YU_Pos)
+          | ((uint32_t)((0u == c.weekday) ? 7u : c.weekday) << RTC_DR_WDU_Pos)
+          | (rtc_internal_to_bcd(c.month) << RTC_DR_MU_Pos)
+          | (rtc_internal_to_bcd(c.date) << RTC_DR_DU_Pos);
+
+  return rtc_internal_exit_init();
+}
+
+/**
+ * @brief   Gives the correction programmed in CALR.
+ * @param   void
+ * @return  Correction in pulses per 2^20 RTCCLK periods.
+ */
+static int32_t rtc_internal_get_pulses(void)
+{
+  uint32_t calr = RTC->CALR;
+  int32_t pulses = -(int32_t)((calr & RTC_CALR_CALM_Msk) >> RTC_CALR_CALM_Pos);
+
+  if (0u != (calr & RTC_CALR_CALP))
+  {
+    pulses += 512;
+  }
+
+  return pulses;
+}
+
+/**
+ * @brief   Corrects a measured drift on top of the correction already
+ *          programmed, with smooth calibration.
+ * @param   drift_ppb: Measured drift, positive when the RTC runs fast.
+ * @return  status: RTC_ERROR if the total leaves the calibration range,
+ *          the nearest correction is programmed anyway.
+ */
+static rtc_status rtc_internal_trim(int32_t drift_ppb)
+{
+  int64_t pulses;
+  uint32_t calr;
+  rtc_status status = RTC_OK;
+
+  if (RTC_INTERNAL_NONE == clock_source)
+  {
+    return RTC_ERROR_INVALID;
+  }
+
+  /* One pulse per 2^20 periods is 1e9 / 2^20 ppb, round to nearest. */
+  pulses = rtc_internal_get_pulses() - ((((int64_t)drift_ppb << 20) + ((drift_ppb < 0) ? -500000000 : 500000000)) / 1000000000);
+  if (RTC_INTERNAL_CAL_MIN > pulses)
+  {
+    pulses = RTC_INTERNAL_CAL_MIN;
+    status = RTC_ERROR;
+  }
+  else if (RTC_INTERNAL_CAL_MAX < pulses)
+  {
+    pulses = RTC_INTERNAL_CAL_MAX;
+    status = RTC_ERROR;
+  }
+  calr = (pulses > 0) ? (RTC_CALR_CALP | (uint32_t)(512 - pulses)) : (uint32_t)(-pulses);
+
+  /* A new value is only taken once the previous one is applied. */
+  if (0u != (RTC->ISR & RTC_ISR_RECALPF))
+  {
+    uint32_t start = HAL_GetTick();
+
+    while (0u != (RTC->ISR & RTC_ISR_RECALPF))
+    {
+      if ((HAL_GetTick() - start) > RTC_INTERNAL_TIMEOUT_MS)
+      {
+        return RTC_ERROR_HW;
+      }
+    }
+  }
+  RTC->WPR = 0xCAu;
+  RTC->WPR = 0x53u;
+  RTC->CALR = calr;
+  RTC->WPR = 0xFFu;
+
+  return status;
+}
+
+/**
+ * @brief   Tells which clock the RTC runs from.
+ * @param   void
+ * @return  clock: RTC_INTERNAL_NONE before a successful init.
+ */
+rtc_internal_clock rtc_internal_get_clock(void)
+{
+  return clock_source;
+}
+
+/**
+ * @brief   Gives the correction programmed by rtc_internal_trim(), kept in
+ *          the backup domain across resets.
+ * @param   void
+ * @return  Correction in ppb, positive speeds the RTC up.
+ */
+int32_t rtc_internal_get_trim(void)
+{
+  return (int32_t)(((int64_t)rtc_internal_get_pulses() * 1000000000) >> 20);
+}
+
+const rtc_backend rtc_internal_backend = {
+  .name = "internal",
+  .init = rtc_internal_init,
+  .now = rtc_internal_now,
+  .set = rtc_internal_set,
+  .trim = rtc_internal_trim,
+};
@@ -0,0 +1,373 @@
+/*
+ * scheduler.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "scheduler.h"
+#include "cycles.h"
+#include "swtimer.h"
+#include "lfqueue.h"
+#include "workq.h"
+#include "trace.h"
+#include <stdio.h>
+
+#define SCHED_QUEUE_MASK (SCHED_QUEUE_LEN - 1u)
+
+#if (SCHED_QUEUE_LEN & SCHED_QUEUE_MASK) != 0u
+#error "SCHED_QUEUE_LEN must be a power of two"
+#endif
+
+typedef struct {
+  const char *name;
+  sched_handler handler;
+  uint8_t prio;
+  sched_stats stats;
+} sched_task;
+
+/* Ring of events for one priority level, only touched from thread context. */
+typedef struct {
+  sched_event buf[SCHED_QUEUE_LEN];
+  uint32_t head;
+  uint32_t tail;
+} sched_queue;
+
+/* ISRs of any priority post here, the main loop drains it into the priority queues. */
+LFQ_MPSC_DEFINE(sched_isr_queue, sched_event, SCHED_QUEUE_LEN)
+
+static sched_task tasks[SCHED_MAX_TASKS];
+static uint8_t task_count = 0u;
+
+static sched_queue queues[SCHED_PRIO_LEVELS];
+
+static sched_isr_queue isr_queue;
+
+/* Timers armed by sched_every(), the task id rides in the callback argument. */
+static swtimer periodic[SCHED_MAX_PERIODIC];
+static uint8_t periodic_count = 0u;
+
+static volatile uint32_t dropped = 0u;
+static uint64_t idle_cycles = 0u;
+
+/**
+ * @brief   Pushes an event into the queue of its task's priority level.
+ * @param   evt: Event to copy.
+ * @return  status: SCHED_ERROR_FULL if the level has no room left.
+ */
+static sched_status sched_enqueue(const sched_event *evt)
+{
+  sched_queue *q = &queues[tasks[evt->task].prio];
+
+  if ((q->head - q->tail) >= SCHED_QUEUE_LEN)
+  {
+    (void)lfq_add(&dropped, 1u);
+    return SCHED_ERROR_FULL;
+  }
+  q->buf[q->head & SCHED_QUEUE_MASK] = *evt;
+  q->head++;
+
+  return SCHED_OK;
+}
+
+/**
+ * @brief   Moves everything the ISRs posted into the priority queues.
+ * @param   void
+ * @return  void
+ */
+static void sched_drain_isr(void)
+{
+  sched_event evt;
+
+  while (0u != sched_isr_queue_pop(&isr_queue, &evt))
+  {
+    (void)sched_enqueue(&evt);
+  }
+}
+
+/**
+ * @brief   Runs the oldest event of the highest non-empty priority level.
+ * @param   void
+ * @return  1 if an event was dispatched, 0 if all queues are empty.
+ */
+static uint8_t sched_dispatch_one(void)
+{
+  for (uint32_t prio = 0u; prio < SCHED_PRIO_LEVELS; prio++)
+  {
+    sched_queue *q = &queues[prio];
+
+    if (q->head != q->tail)
+    {
+      sched_event evt = q->buf[q->tail & SCHED_QUEUE_MASK];
+      sched_task *t = &tasks[evt.task];
+      q->tail++;
+
+      uint32_t start = cycles_now();
+      uint32_t latency = start - evt.stamp;
+      trace_event(TRACE_TASK_BEGIN, evt.task, (uint8_t)evt.sig);
+      t->handler(&evt);
+      trace_event(TRACE_TASK_END, evt.task, 0u);
+      uint32_t run = cycles_now() - start;
+
+      t->stats.runs++;
+      t->stats.busy_cycles += run;
+      if (run > t->stats.max_run_cycles)
+      {
+        t->stats.max_run_cycles = run;
+      }
+      if (latency > t->stats.max_latency_cycles)
+      {
+        t->stats.max_latency_cycles = latency;
+      }
+      return 1u;
+    }
+  }
+
+  return 0u;
+}
+
+/**
+ * @brief   Checks whether any event is waiting, ISR queue included.
+ * @param   void
+ * @return  1 if there is work to do, 0 otherwise.
+ */
+static uint8_t sched_pending(void)
+{
+  if (0u != swtimer_pending())
+  {
+    return 1u;
+  }
+#if !WORKQ_USE_PENDSV
+  if (0u != workq_pending())
+  {
+    return 1u;
+  }
+#endif
+  if (0u != sched_isr_queue_count(&isr_queue))
+  {
+    return 1u;
+  }
+  for (uint32_t prio = 0u; prio < SCHED_PRIO_LEVELS; prio++)
+  {
+    if (queues[prio].head != queues[prio].tail)
+    {
+      return 1u;
+    }
+  }
+
+  return 0u;
+}
+
+/**
+ * @brief   Posts SCHED_SIG_TICK to the task a sched_every() timer belongs to.
+ * @param   timer: Expired timer.
+ * @param   arg:   Task id.
+ * @return  void
+ */
+static void sched_periodic_expired(swtimer *timer, void *arg)
+{
+  (void)sched_post((sched_task_id)(uintptr_t)arg, SCHED_SIG_TICK, swtimer_now());
+}
+
+/**
+ * @brief   Initializes the scheduler, the timer wheel and the DWT cycle counter.
+ * @param   void
+ * @return  void
+ */
+void sched_init(void)
+{
+  cycles_init();
+  swtimer_init();
+
+  task_count = 0u;
+  periodic_count = 0u;
+  dropped = 0u;
+  idle_cycles = 0u;
+  sched_isr_queue_init(&isr_queue);
+  for (uint32_t prio = 0u; prio < SCHED_PRIO_LEVELS; prio++)
+  {
+    queues[prio].head = 0u;
+    queues[prio].tail = 0u;
+  }
+}
+
+/**
+ * @brief   Registers a run-to-completion task.
+ * @param   name:    Name used in the report.
+ * @param   handler: Function called for every event of the task.
+ * @param   prio:    Priority level, 0 is the highest.
+ * @param   *id:     Receives the id to post events to.
+ * @return  status: Report about the success of the registration.
+ */
+sched_status sched_task_create(const char *name, sched_handler handler, uint8_t prio, sched_task_id *id)
+{
+  if ((SCHED_MAX_TASKS <= task_count) || (SCHED_PRIO_LEVELS <= prio) || (NULL == handler))
+  {
+    return SCHED_ERROR;
+  }
+
+  sched_task *t = &tasks[task_count];
+  t->name = name;
+  t->handler = handler;
+  t->prio = prio;
+  t->stats = (sched_stats){0};
+  *id = task_count;
+  task_count++;
+
+  return SCHED_OK;
+}
+
+/**
+ * @brief   Posts an event to a task. Only call this from thread context.
+ * @param   task:  Destination task.
+ * @param   sig:   Signal, SCHED_SIG_USER and above for application events.
+ * @param   param: Free parameter handed to the task.
+ * @return  status: Report about the success of the posting.
+ */
+sched_status sched_post(sched_task_id task, uint16_t sig, uint32_t param)
+{
+  if (task_count <= task)
+  {
+    return SCHED_ERROR_TASK;
+  }
+
+  sched_event evt = {sig, task, param, cycles_now()};
+
+  return sched_enqueue(&evt);
+}
+
+/**
+ * @brief   Posts an event to a task from an interrupt. Lock-free, safe from nested ISRs.
+ * @param   task:  Destination task.
+ * @param   sig:   Signal, SCHED_SIG_USER and above for application events.
+ * @param   param: Free parameter handed to the task.
+ * @return  status: Report about the success of the posting.
+ */
+sched_status sched_post_isr(sched_task_id task, uint16_t sig, uint32_t param)
+{
+  if (task_count <= task)
+  {
+    return SCHED_ERROR_TASK;
+  }
+
+  sched_event evt = {sig, task, param, cycles_now()};
+
+  if (0u == sched_isr_queue_push(&isr_queue, &evt))
+  {
+    (void)lfq_add(&dropped, 1u);
+    return SCHED_ERROR_FULL;
+  }
+
+  return SCHED_OK;
+}
+
+/**
+ * @brief   Posts SCHED_SIG_TICK to a task every period_ms milliseconds.
+ * @param   task:      Destination task.
+ * @param   period_ms: Period in SysTick ticks, at least 1.
+ * @return  status: Report about the success of the arming.
+ */
+sched_status sched_every(sched_task_id task, uint32_t period_ms)
+{
+  if ((task_count <= task) || (0u == period_ms))
+  {
+    return SCHED_ERROR_TASK;
+  }
+  if (SCHED_MAX_PERIODIC <= periodic_count)
+  {
+    return SCHED_ERROR_FULL;
+  }
+
+  swtimer *timer = &periodic[periodic_count];
+  swtimer_setup(timer, sched_periodic_expired, (void *)(uintptr_t)task);
+  if (SWTIMER_OK != swtimer_start(timer, period_ms, period_ms))
+  {
+    return SCHED_ERROR;
+  }
+  periodic_count++;
+
+  return SCHED_OK;
+}
+
+/**
+ * @brief   Runs expired timers and dispatches every pending event, highest
+ *          priority first, then sleeps until the next interrupt if nothing
+ *          is left.
+ * @param   void
+ * @return  void
+ */
+void sched_run_once(void)
+{
+  do
+  {
+    if (0u != swtimer_pending())
+    {
+      swtimer_process();
+    }
+#if !WORKQ_USE_PENDSV
+    workq_run();
+#endif
+    sched_drain_isr();
+  } while (0u != sched_dispatch_one());
+
+  /* Check and sleep with interrupts masked so a post cannot slip in between. */
+  __disable_irq();
+  if (0u == sched_pending())
+  {
+    uint32_t start = cycles_now();
+    __WFI();
+    idle_cycles += cycles_now() - start;
+  }
+  __enable_irq();
+}
+
+/**
+ * @brief   Reads the run-time statistics of one task.
+ * @param   task:   Task to read.
+ * @param   *stats: Receives a copy of the statistics.
+ * @return  status: Report about the success of the read.
+ */
+sched_status sched_get_stats(sched_task_id task, sched_stats *stats)
+{
+  if (task_count <= task)
+  {
+    return SCHED_ERROR_TASK;
+  }
+  *stats = tasks[task].stats;
+
+  return SCHED_OK;
+}
+
+/**
+ * @brief   Name a task was created with.
+ * @param   task: Task id.
+ * @return  The name, NULL if the id is not valid.
+ */
+const char *sched_task_name(sched_task_id task)
+{
+  return (task_count > task) ? tasks[task].name : NULL;
+}
+
+/**
+ * @brief   Prints run count, busy time, longest run and worst dispatch
+ *          latency of every task over the console UART.
+ * @param   void
+ * @return  void
+ */
+void sched_report(void)
+{
+  uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+
+  printf("task        prio     runs   busy_us    max_us    lat_us\n");
+  for (uint32_t i = 0u; i < task_count; i++)
+  {
+    sched_task *t = &tasks[i];
+
+    printf("%-10s %5u %8lu %9lu %9lu %9lu\n", t->name, t->prio,
+           (unsigned long)t->stats.runs,
+           (unsigned long)(t->stats.busy_cycles / cycles_per_us),
+           (unsigned long)cycles_to_us(t->stats.max_run_cycles),
+           (unsigned long)cycles_to_us(t->stats.max_latency_cycles));
+  }
+  printf("idle_us %lu dropped %lu\n", (unsigned long)(idle_cycles / cycles_per_us), (unsigned long)dropped);
+}
@@ -0,0 +1,374 @@
+/*
+ * softclock.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "softclock.h"
+#include "scheduler.h"
+#include "workq.h"
+#include "cycles.h"
+#include "pt.h"
+#include <stdio.h>
+
+/* Posted to the resync task from the edge work. */
+#define SOFTCLOCK_SIG_RESYNC  SCHED_SIG_USER
+/* Posted to the resync task when the chip read completes. */
+#define SOFTCLOCK_SIG_READ    (SCHED_SIG_USER + 1u)
+
+/* One published time, valid from edge_cycles on. */
+typedef struct {
+  epoch_t epoch;
+  ds1307_time_t time;
+  uint32_t edge_cycles;
+  uint32_t usec_mult;  /* microseconds per cycle, 0.32 fixed point */
+} softclock_slot;
+
+/* Readers copy slots[seq & 1], the writer fills the other one then bumps seq. */
+static softclock_slot slots[2];
+static volatile uint32_t seq;
+static volatile uint8_t synced;
+static volatile uint8_t running;
+
+static sched_task_id task;
+static sched_task_id notify_task;
+static uint16_t notify_sig;
+static uint32_t last_edge;
+static uint8_t have_edge;
+static uint32_t since_resync;
+static uint32_t usec_mult;
+static uint64_t good_cycles;
+static uint32_t good_edges;
+static softclock_stats stats;
+
+/* Resync sequence, kept across its wait for the chip read. */
+static pt resync_pt;
+static i2c_request resync_req;
+static uint8_t resync_reg = DS1307_REG_SECOND;
+static uint8_t resync_raw[DS1307_BURST_LEN];
+static uint32_t resync_edges;
+static uint32_t resync_edge;
+
+/**
+ * @brief   Makes a time visible to the readers. Writers must not preempt
+ *          each other: the deferred edge work, or thread context with
+ *          interrupts masked.
+ * @param   t:           Time of the second that started at edge_cycles.
+ * @param   edge_cycles: Cycle counter at the edge.
+ * @return  void
+ */
+static void softclock_publish(epoch_t t, uint32_t edge_cycles)
+{
+  softclock_slot *slot = &slots[(seq + 1u) & 1u];
+
+  slot->epoch = t;
+  ds1307_time_from_epoch(t, &slot->time);
+  slot->edge_cycles = edge_cycles;
+  slot->usec_mult = usec_mult;
+  __DMB();
+  seq = seq + 1u;
+}
+
+/**
+ * @brief   I2C completion of the resync read, interrupt context: hands the
+ *          result back to the resync task.
+ * @param   *req: The finished request.
+ * @return  void
+ */
+static void softclock_read_done(i2c_request *req)
+{
+  (void)req;
+  (void)sched_post_isr(task, SOFTCLOCK_SIG_READ, 0u);
+}
+
+/**
+ * @brief   Resync sequence: right after an edge, reads the chip without
+ *          blocking and corrects the local copy if it is off. Resumed by
+ *          the resync task on every edge request and read completion.
+ * @param   *p: Protothread state.
+ * @return  Protothread state, see pt.h.
+ */
+static PT_THREAD(softclock_resync_pt(pt *p))
+{
+  ds1307_time_t chip;
+  uint32_t window = (SystemCoreClock / 1000u) * SOFTCLOCK_WINDOW_MS;
+  uint32_t primask;
+
+  PT_BEGIN(p);
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  resync_edges = stats.edges;
+  resync_edge = last_edge;
+  __set_PRIMASK(primask);
+  /* Too close to the next edge, the next edge posts again. */
+  if ((0u == have_edge) || ((cycles_now() - resync_edge) > window))
+  {
+    PT_EXIT(p);
+  }
+
+  i2c_request_setup(&resync_req, ds1307_get_device(), &resync_reg, 1u, resync_raw, sizeof(resync_raw));
+  resync_req.callback = softclock_read_done;
+  if (I2C_BUS_OK != i2c_bus_submit(&resync_req, I2C_BUS_PRIO_DEFAULT, SOFTCLOCK_WINDOW_MS))
+  {
+    PT_EXIT(p);
+  }
+  PT_WAIT_WHILE(p, I2C_BUS_PENDING == resync_req.status);
+  if (I2C_BUS_OK != resync_req.status)
+  {
+    PT_EXIT(p);
+  }
+  ds1307_decode_time(resync_raw, &chip);
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  /* The read must not straddle an edge, or the chip and the copy disagree by a second. */
+  if (resync_edges == stats.edges)
+  {
+    if (0u != synced)
+    {
+      int32_t offset = (int32_t)(ds1307_time_to_epoch(&chip) - slots[seq & 1u].epoch);
+
+      if (0 != offset)
+      {
+        stats.corrections++;
+        stats.last_offset_s = offset;
+      }
+    }
+    softclock_publish(ds1307_time_to_epoch(&chip), resync_edge);
+    synced = 1u;
+    since_resync = 0u;
+    stats.resyncs++;
+  }
+  __set_PRIMASK(primask);
+
+  PT_END(p);
+}
+
+/**
+ * @brief   Scheduler task: drives the resync sequence. A resync request
+ *          that comes while a read is on the bus just finds it waiting.
+ * @param   *evt: Scheduler event.
+ * @return  void
+ */
+static void softclock_task(const sched_event *evt)
+{
+  if ((SOFTCLOCK_SIG_RESYNC == evt->sig) || (SOFTCLOCK_SIG_READ == evt->sig))
+  {
+    (void)softclock_resync_pt(&resync_pt);
+  }
+}
+
+/**
+ * @brief   Starts the 1 Hz SQW output and the resync task. The first valid
+ *          time is available once an edge has been seen and the chip read.
+ * @param   void
+ * @return  status: Report about the success of the initialization.
+ */
+softclock_status softclock_init(void)
+{
+  cycles_init();
+
+  seq = 0u;
+  synced = 0u;
+  have_edge = 0u;
+  since_resync = 0u;
+  good_cycles = 0u;
+  good_edges = 0u;
+  PT_INIT(&resync_pt);
+  stats = (softclock_stats){0};
+  stats.period_cycles = SystemCoreClock;
+  usec_mult = (uint32_t)((1000000ull << 32) / stats.period_cycles);
+
+  if (SCHED_OK != sched_task_create("clock", softclock_task, SOFTCLOCK_TASK_PRIO, &task))
+  {
+    return SOFTCLOCK_ERROR;
+  }
+  running = 1u;
+  ds1307_enable_output_pin(DS1307_SQW_1HZ);
+
+  return SOFTCLOCK_OK;
+}
+
+/**
+ * @brief   Deferred part of an SQW edge, run by the work queue: measures
+ *          the period, advances the local copy by one second and asks for
+ *          a resync when due.
+ * @param   now: Cycle counter taken in the edge interrupt.
+ * @return  void
+ */
+static void softclock_edge_work(uint32_t now)
+{
+  if (0u != have_edge)
+  {
+    uint32_t period = stats.period_cycles;
+    uint32_t dt = now - last_edge;
+    uint32_t tol = (uint32_t)(((uint64_t)period * SOFTCLOCK_GLITCH_PPM) / 1000000u);
+
+    if (dt < (period - tol))
+    {
+      /* Noise on the line, not a second. */
+      stats.glitches++;
+      return;
+    }
+    if (dt > (period + tol))
+    {
+      /* Missed edges, the resync puts the seconds right. */
+      stats.glitches++;
+      since_resync = SOFTCLOCK_RESYNC_S;
+    }
+    else
+    {
+      stats.period_cycles = (uint32_t)((int32_t)period + (((int32_t)(dt - period)) / 8));
+      usec_mult = (uint32_t)((1000000ull << 32) / stats.period_cycles);
+      good_cycles += dt;
+      good_edges++;
+    }
+  }
+  stats.edges++;
+  last_edge = now;
+  have_edge = 1u;
+
+  if (0u != synced)
+  {
+    softclock_publish(slots[seq & 1u].epoch + 1u, now);
+    if (0u != notify_sig)
+    {
+      (void)sched_post_isr(notify_task, notify_sig, stats.edges);
+    }
+  }
+  if ((0u == synced) || (++since_resync >= SOFTCLOCK_RESYNC_S))
+  {
+    (void)sched_post_isr(task, SOFTCLOCK_SIG_RESYNC, stats.edges);
+  }
+}
+
+/**
+ * @brief   Handles a falling edge of SQW/OUT: stamps it and defers the rest
+ *          to the work queue. An edge dropped on a full queue shows up as a
+ *          missed edge at the next one, which forces a resync.
+ * @param   void
+ * @return  void
+ */
+void softclock_edge_isr(void)
+{
+  uint32_t now = cycles_now();
+
+  if (0u == running)
+  {
+    return;
+  }
+  (void)workq_submit(SOFTCLOCK_WORKQ_LEVEL, softclock_edge_work, now);
+}
+
+/**
+ * @brief   Gives the current date and time with microsecond resolution. A
+ *          few memory reads, no bus access, safe from any context.
+ * @param   *now: Receives the time.
+ * @return  status: SOFTCLOCK_ERROR_SYNC until the first resync is done.
+ */
+softclock_status softclock_now(softclock_time *now)
+{
+  softclock_slot slot;
+  uint32_t n;
+  uint32_t usec;
+
+  if (0u == synced)
+  {
+    return SOFTCLOCK_ERROR_SYNC;
+  }
+  do
+  {
+    n = seq;
+    __DMB();
+    slot = slots[n & 1u];
+    __DMB();
+  } while (n != seq);
+
+  usec = (uint32_t)(((uint64_t)(cycles_now() - slot.edge_cycles) * slot.usec_mult) >> 32);
+  now->epoch = slot.epoch;
+  now->time = slot.time;
+  now->usec = (usec > 999999u) ? 999999u : usec;
+
+  return SOFTCLOCK_OK;
+}
+
+/**
+ * @brief   Has every SQW edge posted to a task once the local copy is
+ *          valid, for work that must start right at a second boundary.
+ *          Replaces the previous subscriber.
+ * @param   task: Task to post to.
+ * @param   sig:  Signal to post, the parameter is the edge count; 0 stops.
+ * @return  void
+ */
+void softclock_notify(sched_task_id task, uint16_t sig)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  notify_task = task;
+  notify_sig = sig;
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Forgets the local copy after the chip time was changed. Until the
+ *          next edge has been followed by a read of the chip,
+ *          softclock_now() reports SOFTCLOCK_ERROR_SYNC.
+ * @param   void
+ * @return  void
+ */
+void softclock_resync(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  synced = 0u;
+  since_resync = 0u;
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Reads the synchronisation statistics.
+ * @param   *out: Receives a copy of the statistics.
+ * @return  void
+ */
+void softclock_get_stats(softclock_stats *out)
+{
+  uint32_t primask = __get_PRIMASK();
+  uint64_t cycles;
+  uint32_t edges;
+
+  __disable_irq();
+  *out = stats;
+  cycles = good_cycles;
+  edges = good_edges;
+  __set_PRIMASK(primask);
+
+  out->drift_ppm = 0;
+  if (0u != edges)
+  {
+    int64_t mean = (int64_t)(cycles / edges);
+    out->drift_ppm = (int32_t)(((mean - (int64_t)SystemCoreClock) * 1000000) / (int64_t)SystemCoreClock);
+  }
+}
+
+/**
+ * @brief   Prints the synchronisation statistics over the console UART.
+ *          drift_ppm compares the DS1307 crystal with the core clock, so
+ *          it includes the error of the core clock source; positive means
+ *          a DS1307 second lasts more than SystemCoreClock cycles.
+ * @param   void
+ * @return  void
+ */
+void softclock_report(void)
+{
+  softclock_stats s;
+
+  softclock_get_stats(&s);
+  printf("clock edges %lu glitches %lu resyncs %lu corrections %lu last_offset %ld s period %lu drift %ld ppm\n",
+         (unsigned long)s.edges, (unsigned long)s.glitches, (unsigned long)s.resyncs,
+         (unsigned long)s.corrections, (long)s.last_offset_s, (unsigned long)s.period_cycles,
+         (long)s.drift_ppm);
+}
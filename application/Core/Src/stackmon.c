@@ -0,0 +1,65 @@
+/*
+ * stackmon.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "stackmon.h"
+#include <stdio.h>
+
+extern uint32_t _estack;         /* Symbol defined in the linker script */
+extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
+
+/**
+ * @brief   Measures the MSP stack. Reset_Handler paints the reservation
+ *          before anything runs, the deepest use is where the paint
+ *          starts to be overwritten. A word the program happened to write
+ *          with the paint value hides at most that word.
+ * @param   *stats: Receives the measurement.
+ * @return  void
+ */
+void stackmon_get(stackmon_stats *stats)
+{
+  uint32_t top = (uint32_t)&_estack;
+  uint32_t size = (uint32_t)&_Min_Stack_Size;
+  const volatile uint32_t *word = (const volatile uint32_t *)(top - size);
+  const volatile uint32_t *end = (const volatile uint32_t *)top;
+
+  while ((word < end) && (STACKMON_PAINT == *word))
+  {
+    word++;
+  }
+
+  stats->size = size;
+  stats->used = top - __get_MSP();
+  stats->high_water = top - (uint32_t)word;
+  stats->overflowed = (stats->high_water >= size) ? 1u : 0u;
+}
+
+/**
+ * @brief   Tells the deepest stack use since reset.
+ * @param   void
+ * @return  Bytes, the full reservation if it overflowed.
+ */
+uint32_t stackmon_high_water(void)
+{
+  stackmon_stats s;
+
+  stackmon_get(&s);
+  return s.high_water;
+}
+
+/**
+ * @brief   Prints the stack use.
+ * @param   void
+ * @return  void
+ */
+void stackmon_report(void)
+{
+  stackmon_stats s;
+
+  stackmon_get(&s);
+  printf("stack %lu of %lu bytes, now %lu%s\n", (unsigned long)s.high_water, (unsigned long)s.size,
+         (unsigned long)s.used, (0u != s.overflowed) ? ", OVERFLOW" : "");
+}
@@ -0,0 +1,322 @@
+/*
+ * swtimer.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "swtimer.h"
+
+#define SWTIMER_SLOT_MASK (SWTIMER_SLOTS - 1u)
+
+/* Slot of a given level that an absolute tick falls in. */
+#define SWTIMER_INDEX(tick, level) (((tick) >> ((level) * SWTIMER_SLOT_BITS)) & SWTIMER_SLOT_MASK)
+
+/* Every slot is the sentinel of a circular doubly linked list. */
+static swtimer_link wheel[SWTIMER_LEVELS][SWTIMER_SLOTS];
+
+/* Level 0 slots that may hold timers, read by SysTick to decide whether to wake the thread. */
+static volatile uint32_t occupied[SWTIMER_SLOTS / 32u];
+
+/* Ticks counted by SysTick. */
+static volatile uint32_t ticks = 0u;
+/* Next tick the wheel has to process, trails ticks until swtimer_process() catches up. */
+static uint32_t wheel_time = 0u;
+/* Set by SysTick when a slot may have expired or a cascade is due. */
+static volatile uint8_t due = 0u;
+
+/**
+ * @brief   Empties a list, leaving only its sentinel.
+ * @param   head: Sentinel of the list.
+ * @return  void
+ */
+static void swtimer_list_init(swtimer_link *head)
+{
+  head->next = head;
+  head->prev = head;
+}
+
+/**
+ * @brief   Unlinks an entry from the list it is in. O(1).
+ * @param   link: Entry to unlink.
+ * @return  void
+ */
+static void swtimer_list_del(swtimer_link *link)
+{
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+  link->next = NULL;
+  link->prev = NULL;
+}
+
+/**
+ * @brief   Appends an entry at the tail of a list. O(1).
+ * @param   head: Sentinel of the list.
+ * @param   link: Entry to append.
+ * @return  void
+ */
+static void swtimer_list_add(swtimer_link *head, swtimer_link *link)
+{
+  link->next = head;
+  link->prev = head->prev;
+  head->prev->next = link;
+  head->prev = link;
+}
+
+/**
+ * @brief   Moves all entries of src to dst, leaving src empty. O(1).
+ * @param   src: Sentinel of the list to take the entries from.
+ * @param   dst: Sentinel of an empty list.
+ * @return  void
+ */
+static void swtimer_list_splice(swtimer_link *src, swtimer_link *dst)
+{
+  if (src->next == src)
+  {
+    swtimer_list_init(dst);
+    return;
+  }
+  dst->next = src->next;
+  dst->prev = src->prev;
+  dst->next->prev = dst;
+  dst->prev->next = dst;
+  swtimer_list_init(src);
+}
+
+/**
+ * @brief   Links a timer into the slot matching its expiry. O(1), no sorting.
+ * @param   timer: Timer with expires already set.
+ * @return  void
+ */
+static void swtimer_insert(swtimer *timer)
+{
+  uint32_t expires = timer->expires;
+  uint32_t delta = expires - wheel_time;
+  swtimer_link *slot;
+
+  if ((int32_t)delta < 0)
+  {
+    /* Already late: run it on the next processed tick. */
+    uint32_t index = SWTIMER_INDEX(wheel_time, 0u);
+    slot = &wheel[0][index];
+    occupied[index >> 5] |= 1u << (index & 31u);
+  }
+  else if (delta < SWTIMER_SLOTS)
+  {
+    uint32_t index = SWTIMER_INDEX(expires, 0u);
+    slot = &wheel[0][index];
+    occupied[index >> 5] |= 1u << (index & 31u);
+  }
+  else
+  {
+    /* Pick the lowest level whose span covers the delay. */
+    uint32_t level = 1u;
+    while ((level < (SWTIMER_LEVELS - 1u)) && (delta >= (1u << ((level + 1u) * SWTIMER_SLOT_BITS))))
+    {
+      level++;
+    }
+    slot = &wheel[level][SWTIMER_INDEX(expires, level)];
+  }
+
+  swtimer_list_add(slot, &timer->link);
+}
+
+/**
+ * @brief   Re-files the timers of one upper level slot into lower levels.
+ * @param   level: Level to cascade from, 1 or above.
+ * @param   index: Slot to cascade.
+ * @return  index: The slot index, 0 means the next level has to cascade too.
+ */
+static uint32_t swtimer_cascade(uint32_t level, uint32_t index)
+{
+  swtimer_link work;
+
+  swtimer_list_splice(&wheel[level][index], &work);
+  while (work.next != &work)
+  {
+    swtimer *timer = (swtimer *)work.next;
+    swtimer_list_del(&timer->link);
+    swtimer_insert(timer);
+  }
+
+  return index;
+}
+
+/**
+ * @brief   Initializes the timer wheel. Timers armed before are forgotten.
+ * @param   void
+ * @return  void
+ */
+void swtimer_init(void)
+{
+  for (uint32_t level = 0u; level < SWTIMER_LEVELS; level++)
+  {
+    for (uint32_t index = 0u; index < SWTIMER_SLOTS; index++)
+    {
+      swtimer_list_init(&wheel[level][index]);
+    }
+  }
+  for (uint32_t i = 0u; i < (SWTIMER_SLOTS / 32u); i++)
+  {
+    occupied[i] = 0u;
+  }
+  wheel_time = ticks;
+  due = 0u;
+}
+
+/**
+ * @brief   Binds a callback to a timer. The timer starts stopped.
+ * @param   timer:    Timer to set up.
+ * @param   callback: Function called from thread context on expiry.
+ * @param   arg:      Argument handed to the callback.
+ * @return  void
+ */
+void swtimer_setup(swtimer *timer, swtimer_callback callback, void *arg)
+{
+  timer->link.next = NULL;
+  timer->link.prev = NULL;
+  timer->expires = 0u;
+  timer->period = 0u;
+  timer->callback = callback;
+  timer->arg = arg;
+}
+
+/**
+ * @brief   Arms a timer, restarting it if it is already running. Thread context only.
+ * @param   timer:  Timer set up with swtimer_setup().
+ * @param   delay:  Ticks until the first expiry, 0 expires on the next tick.
+ * @param   period: Ticks between later expiries, 0 for a one-shot timer.
+ * @return  status: Report about the success of the arming.
+ */
+swtimer_status swtimer_start(swtimer *timer, uint32_t delay, uint32_t period)
+{
+  if ((SWTIMER_MAX_DELAY < delay) || (SWTIMER_MAX_DELAY < period))
+  {
+    return SWTIMER_ERROR_RANGE;
+  }
+  if (NULL != timer->link.next)
+  {
+    swtimer_list_del(&timer->link);
+  }
+
+  /* Count from the SysTick time so a lagging wheel does not stretch the delay. */
+  timer->expires = ticks + delay;
+  timer->period = period;
+  swtimer_insert(timer);
+
+  /* SysTick may have passed the slot while it was being linked. */
+  if ((int32_t)(timer->expires - ticks) <= 0)
+  {
+    due = 1u;
+  }
+
+  return SWTIMER_OK;
+}
+
+/**
+ * @brief   Disarms a timer. O(1), does nothing if it is not running. Thread context only.
+ * @param   timer: Timer to stop.
+ * @return  void
+ */
+void swtimer_stop(swtimer *timer)
+{
+  if (NULL != timer->link.next)
+  {
+    swtimer_list_del(&timer->link);
+  }
+}
+
+/**
+ * @brief   Tells whether a timer is armed.
+ * @param   timer: Timer to check.
+ * @return  1 if the timer will expire, 0 otherwise.
+ */
+uint8_t swtimer_is_active(const swtimer *timer)
+{
+  return (NULL != timer->link.next) ? 1u : 0u;
+}
+
+/**
+ * @brief   Reads the tick counter driving the wheel.
+ * @param   void
+ * @return  Ticks since start, wraps every 2^32 ticks.
+ */
+uint32_t swtimer_now(void)
+{
+  return ticks;
+}
+
+/**
+ * @brief   Advances time by one tick. Only flags work for the thread when
+ *          the level 0 slot of the new tick is in use or a cascade is due.
+ * @param   void
+ * @return  void
+ */
+void swtimer_tick_isr(void)
+{
+  uint32_t now = ticks + 1u;
+  uint32_t index = SWTIMER_INDEX(now, 0u);
+
+  ticks = now;
+  if ((0u == index) || (0u != (occupied[index >> 5] & (1u << (index & 31u)))))
+  {
+    due = 1u;
+  }
+}
+
+/**
+ * @brief   Tells whether swtimer_process() has expiries or cascades to run.
+ * @param   void
+ * @return  1 if it has, 0 otherwise.
+ */
+uint8_t swtimer_pending(void)
+{
+  return due;
+}
+
+/**
+ * @brief   Runs the callbacks of every timer whose expiry has passed.
+ *          Each elapsed tick costs one slot plus, every SWTIMER_SLOTS
+ *          ticks, one cascade. Thread context only.
+ * @param   void
+ * @return  void
+ */
+void swtimer_process(void)
+{
+  due = 0u;
+
+  while ((int32_t)(ticks - wheel_time) >= 0)
+  {
+    uint32_t index = SWTIMER_INDEX(wheel_time, 0u);
+    swtimer_link work;
+
+    if (0u == index)
+    {
+      for (uint32_t level = 1u; level < SWTIMER_LEVELS; level++)
+      {
+        if (0u != swtimer_cascade(level, SWTIMER_INDEX(wheel_time, level)))
+        {
+          break;
+        }
+      }
+    }
+
+    /* Detach the slot first so callbacks re-arming timers cannot land in it. */
+    swtimer_list_splice(&wheel[0][index], &work);
+    occupied[index >> 5] &= ~(1u << (index & 31u));
+    wheel_time++;
+
+    while (work.next != &work)
+    {
+      swtimer *timer = (swtimer *)work.next;
+      swtimer_list_del(&timer->link);
+      if (0u != timer->period)
+      {
+        /* Reload from the previous expiry so periodic timers do not drift. */
+        timer->expires += timer->period;
+        swtimer_insert(timer);
+      }
+      timer->callback(timer, timer->arg);
+    }
+  }
+}
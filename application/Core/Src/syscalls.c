@@ -29,6 +29,7 @@
 #include <time.h>
 #include <sys/time.h>
 #include <sys/times.h>
+#include "trace.h"
 
 
 /* Variables */
@@ -82,10 +83,12 @@ __attribute__((weak)) int _write(int file, char *ptr, int len)
   (void)file;
   int DataIdx;
 
+  trace_event(TRACE_UART_BEGIN, (uint16_t)len, 0u);
   for (DataIdx = 0; DataIdx < len; DataIdx++)
   {
     __io_putchar(*ptr++);
   }
+  trace_event(TRACE_UART_END, (uint16_t)len, 0u);
   return len;
 }
 
@@ -23,6 +23,7 @@
 /* Includes */
 #include <errno.h>
 #include <stdint.h>
+#include "mpu_guard.h"
 
 /**
  * Pointer to the current high watermark of the heap usage
@@ -35,8 +36,8 @@ static uint8_t *__sbrk_heap_end = NULL;
  *
  * @verbatim
  * ############################################################################
- * #  .data  #  .bss  #       newlib heap       #          MSP stack          #
- * #         #        #                         # Reserved by _Min_Stack_Size #
+ * #  .data  #  .bss  #   newlib heap   # guard #          MSP stack          #
+ * #         #        #                 #       # Reserved by _Min_Stack_Size #
  * ############################################################################
  * ^-- RAM start      ^-- _end                             _estack, RAM end --^
  * @endverbatim
@@ -56,7 +57,8 @@ void *_sbrk(ptrdiff_t incr)
   extern uint8_t _estack; /* Symbol defined in the linker script */
   extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
   const uint32_t stack_limit = (uint32_t)&_estack - (uint32_t)&_Min_Stack_Size;
-  const uint8_t *max_heap = (uint8_t *)stack_limit;
+  /* The MPU guard below the stack is not heap either */
+  const uint8_t *max_heap = (uint8_t *)MPU_GUARD_BELOW(stack_limit);
   uint8_t *prev_heap_end;
 
   /* Initialize heap end at first call */
@@ -0,0 +1,124 @@
+/*
+ * trace.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "trace.h"
+#include "cycles.h"
+#include "scheduler.h"
+#include <stdio.h>
+
+#if TRACE_ENABLE
+
+trace_record trace_ring[TRACE_DEPTH];
+volatile uint32_t trace_head = 0u;
+volatile uint8_t trace_on = 0u;
+
+/* Dump in progress: records [next, end) of the frozen ring are left. */
+static uint8_t dumping = 0u;
+static uint32_t next = 0u;
+static uint32_t end = 0u;
+
+/**
+ * @brief   Starts the cycle counter, empties the ring and starts recording.
+ * @param   void
+ * @return  void
+ */
+void trace_init(void)
+{
+  cycles_init();
+  trace_head = 0u;
+  dumping = 0u;
+  trace_on = 1u;
+}
+
+/**
+ * @brief   Freezes the ring and prints the header and the task names. The
+ *          records follow from trace_poll(), so the dump does not hold up
+ *          the other tasks and does not trace itself.
+ * @param   void
+ * @return  1 if the dump started, 0 if one is already running.
+ */
+uint8_t trace_dump_start(void)
+{
+  const char *name;
+
+  if (0u != dumping)
+  {
+    return 0u;
+  }
+  trace_on = 0u;
+  __DMB();
+
+  end = trace_head;
+  next = (TRACE_DEPTH < end) ? (end - TRACE_DEPTH) : 0u;
+  dumping = 1u;
+
+  printf("trace begin %lu %lu\n", (unsigned long)SystemCoreClock, (unsigned long)(end - next));
+  for (sched_task_id id = 0u; NULL != (name = sched_task_name(id)); id++)
+  {
+    printf("trace task %u %s\n", id, name);
+  }
+  return 1u;
+}
+
+/**
+ * @brief   Prints up to TRACE_LINES_PER_POLL lines of a dump, oldest record
+ *          first. After the last one the ring is emptied and recording
+ *          restarts.
+ * @param   void
+ * @return  void
+ */
+void trace_poll(void)
+{
+  char line[2u + (TRACE_PER_LINE * 16u)];
+
+  if (0u == dumping)
+  {
+    return;
+  }
+
+  for (uint32_t lines = 0u; (next != end) && (TRACE_LINES_PER_POLL > lines); lines++)
+  {
+    uint32_t len = 0u;
+
+    line[len++] = '#';
+    for (uint32_t i = 0u; (next != end) && (TRACE_PER_LINE > i); i++)
+    {
+      const trace_record *r = &trace_ring[next & (TRACE_DEPTH - 1u)];
+
+      len += (uint32_t)snprintf(&line[len], sizeof(line) - len, "%08lx%04x%02x%02x",
+                                (unsigned long)r->cycles, r->arg, r->type, r->aux);
+      next++;
+    }
+    printf("%s\n", line);
+  }
+
+  if (next == end)
+  {
+    printf("trace end\n");
+    dumping = 0u;
+    trace_head = 0u;
+    __DMB();
+    trace_on = 1u;
+  }
+}
+
+#else
+
+void trace_init(void)
+{
+}
+
+uint8_t trace_dump_start(void)
+{
+  return 0u;
+}
+
+void trace_poll(void)
+{
+}
+
+#endif /* TRACE_ENABLE */
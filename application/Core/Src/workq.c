@@ -0,0 +1,184 @@
+/*
+ * workq.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ */
+
+#include "workq.h"
+#include "cycles.h"
+#include "lfqueue.h"
+#include <stdio.h>
+
+typedef struct {
+  workq_fn fn;
+  uint32_t arg;
+  uint32_t stamp;
+} workq_item;
+
+/* One queue per level, any ISR may produce, the dispatcher consumes. */
+LFQ_MPSC_DEFINE(workq_queue, workq_item, WORKQ_DEPTH)
+
+static workq_queue queues[WORKQ_LEVELS];
+static workq_stats stats[WORKQ_LEVELS];
+
+/**
+ * @brief   Initializes the work queues and their statistics.
+ * @param   void
+ * @return  void
+ */
+void workq_init(void)
+{
+  cycles_init();
+
+  for (uint32_t level = 0u; level < WORKQ_LEVELS; level++)
+  {
+    workq_queue_init(&queues[level]);
+    stats[level] = (workq_stats){0};
+  }
+}
+
+/**
+ * @brief   Defers fn(arg) to the dispatcher. Lock-free, callable from any ISR
+ *          and from thread context.
+ * @param   level: Priority level, 0 is the most urgent.
+ * @param   fn:    Work to run.
+ * @param   arg:   Argument handed to fn.
+ * @return  status: Report about the success of the submission.
+ */
+workq_status workq_submit(uint8_t level, workq_fn fn, uint32_t arg)
+{
+  if (WORKQ_LEVELS <= level)
+  {
+    return WORKQ_ERROR_LEVEL;
+  }
+
+  workq_item item = {fn, arg, cycles_now()};
+
+  if (0u == workq_queue_push(&queues[level], &item))
+  {
+    /* Producers at different priorities may drop at the same time. */
+    (void)lfq_add(&stats[level].dropped, 1u);
+    return WORKQ_ERROR_FULL;
+  }
+#if WORKQ_USE_PENDSV
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+#endif
+
+  return WORKQ_OK;
+}
+
+/**
+ * @brief   Tells whether items are waiting on any level.
+ * @param   void
+ * @return  1 if there is work to run, 0 otherwise.
+ */
+uint8_t workq_pending(void)
+{
+  for (uint32_t level = 0u; level < WORKQ_LEVELS; level++)
+  {
+    if (0u != workq_queue_count(&queues[level]))
+    {
+      return 1u;
+    }
+  }
+
+  return 0u;
+}
+
+/**
+ * @brief   Runs every waiting item. After each item the most urgent level
+ *          is checked again, so a burst on a low level cannot hold back an
+ *          urgent one by more than one item.
+ * @param   void
+ * @return  void
+ */
+void workq_run(void)
+{
+  uint32_t level = 0u;
+
+  while (level < WORKQ_LEVELS)
+  {
+    workq_item item;
+
+    if (0u == workq_queue_pop(&queues[level], &item))
+    {
+      level++;
+      continue;
+    }
+
+    uint32_t latency = cycles_now() - item.stamp;
+    workq_stats *s = &stats[level];
+    s->runs++;
+    s->total_latency_cycles += latency;
+    if (latency > s->max_latency_cycles)
+    {
+      s->max_latency_cycles = latency;
+    }
+
+    item.fn(item.arg);
+    level = 0u;
+  }
+}
+
+/**
+ * @brief   Reads the statistics of one level.
+ * @param   level:  Level to read.
+ * @param   *out:   Receives a copy of the statistics.
+ * @return  status: Report about the success of the read.
+ */
+workq_status workq_get_stats(uint8_t level, workq_stats *out)
+{
+  uint32_t primask;
+
+  if (WORKQ_LEVELS <= level)
+  {
+    return WORKQ_ERROR_LEVEL;
+  }
+  /* The dispatcher updates the 64-bit total in two stores. */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *out = stats[level];
+  __set_PRIMASK(primask);
+
+  return WORKQ_OK;
+}
+
+/**
+ * @brief   Prints runs, drops and mean and worst enqueue to execution
+ *          latency of every level over the console UART.
+ * @param   void
+ * @return  void
+ */
+void workq_report(void)
+{
+  uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+
+  printf("level     runs  dropped   mean_us    max_us\n");
+  for (uint32_t level = 0u; level < WORKQ_LEVELS; level++)
+  {
+    workq_stats s;
+    uint32_t mean = 0u;
+
+    (void)workq_get_stats((uint8_t)level, &s);
+    if (0u != s.runs)
+    {
+      mean = (uint32_t)(s.total_latency_cycles / s.runs);
+    }
+    printf("%5lu %8lu %8lu %9lu %9lu\n", (unsigned long)level, (unsigned long)s.runs,
+           (unsigned long)s.dropped, (unsigned long)(mean / cycles_per_us),
+           (unsigned long)(s.max_latency_cycles / cycles_per_us));
+  }
+}
+
+#if WORKQ_USE_PENDSV
+/**
+ * @brief   Runs the deferred work from PendSV, before any thread switch.
+ * @param   void
+ * @return  void
+ */
+void kernel_pendsv_hook(void)
+{
+  workq_run();
+}
+#endif
@@ -60,6 +60,22 @@ defined in linker script */
 Reset_Handler:  
   ldr   sp, =_estack    		 /* set stack pointer */
 
+/* Paint the MSP stack reservation, stackmon.c finds the deepest use by
+   looking for the first overwritten word. Nothing is on the stack yet. */
+  ldr r0, =_estack
+  ldr r1, =_Min_Stack_Size
+  subs r1, r0, r1
+  ldr r2, =0xC5C5C5C5            /* STACKMON_PAINT */
+  b LoopPaintStack
+
+PaintStack:
+  str r2, [r1]
+  adds r1, r1, #4
+
+LoopPaintStack:
+  cmp r1, r0
+  bcc PaintStack
+
 /* Copy the data segment initializers from flash to SRAM */  
   ldr r0, =_sdata
   ldr r1, =_edata
@@ -77,7 +93,24 @@ LoopCopyDataInit:
   cmp r4, r1
   bcc CopyDataInit
   
-/* Zero fill the bss segment. */
+/* Copy the code run from RAM, see RAMFUNC in sections.h */
+  ldr r0, =_sramfunc
+  ldr r1, =_eramfunc
+  ldr r2, =_siramfunc
+  movs r3, #0
+  b LoopCopyRamfunc
+
+CopyRamfunc:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyRamfunc:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyRamfunc
+
+/* Zero fill the bss segment, .noinit is left alone. */
   ldr r2, =_sbss
   ldr r4, =_ebss
   movs r3, #0
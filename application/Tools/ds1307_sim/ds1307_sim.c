@@ -0,0 +1,714 @@
+/*
+ * ds1307_sim.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ *
+ * Host tests of the DS1307 driver, the I2C bus manager and the I2C engine
+ * on a simulated bus and chip. Not part of the firmware build.
+ *
+ *   gcc -O2 -Wall -I. -I../../Core/Inc ds1307_sim.c ../../Core/Src/i2c_bsp.c \
+ *       ../../Core/Src/i2c_bus.c ../../Core/Src/rtc_ds1307.c ../../Core/Src/epoch.c -o ds1307_sim
+ *   ./ds1307_sim
+ *
+ * The HAL I2C calls of i2c_bsp.c land here (see stm32f4xx_hal.h in this
+ * directory). The simulated DS1307 has the 64 byte register file, the
+ * register pointer with auto-increment and wrap at 0x3F, the time
+ * registers latched on START, the countdown chain reset by a seconds write
+ * and the clock halt bit. It can also hang in the middle of a transfer
+ * holding SDA low, which keeps the bus busy until nine SCL pulses are
+ * clocked on the recovery pins. The bus runs at DS1307_I2C_CLOCK: every byte
+ * costs 9 bit times, START, repeated START and STOP one each, and the
+ * simulated time, HAL_GetTick() and the DWT cycle counter only move with
+ * the bus or with sim_advance(). Runs are fully deterministic.
+ *
+ * Every driver call is measured in STOP-terminated transactions and bus
+ * time and checked against a budget, so a change that adds traffic fails
+ * here. Exit status is the number of failures.
+ */
+
+#include "rtc_ds1307.h"
+#include "pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_NS_PER_S     1000000000ull
+#define SIM_BIT_NS       (SIM_NS_PER_S / DS1307_I2C_CLOCK)
+#define SIM_REGS         64u
+#define SIM_TIME_REGS    8u
+#define SIM_CH           0x80u
+/* Simulated time per access to the cycle counter. */
+#define SIM_DWT_ACCESS_NS  100u
+/* The HAL polls a busy bus this long before it gives up on a start. */
+#define SIM_HAL_BUSY_NS    25000000ull
+/* Recovery pins of the simulated bus. */
+#define SIM_SCL_PIN      0x0040u
+#define SIM_SDA_PIN      0x0200u
+
+uint32_t SystemCoreClock = 16000000u;
+sim_core_debug sim_core_debug_regs;
+static sim_dwt sim_dwt_regs;
+static GPIO_TypeDef sim_gpio;
+
+/* Simulated DS1307. */
+static struct {
+  uint8_t regs[SIM_REGS];
+  uint8_t latch[SIM_TIME_REGS];  /* time registers as copied on the last START */
+  uint8_t ptr;                   /* register pointer */
+  uint64_t phase_ns;             /* time into the current second */
+  uint8_t nak_next;              /* fault injection: NAK the next address */
+  uint8_t hang_next;             /* fault injection: hang in the next transfer */
+  uint8_t hold_sda;              /* SDA held low, the bus stays busy */
+  uint8_t scl_level;
+  uint8_t scl_pulses;            /* rising SCL edges clocked while SDA is held */
+} chip;
+
+/* Transfer started by an _IT or _DMA call, run by the next sim_wfi(). */
+static struct {
+  uint8_t active;
+  I2C_HandleTypeDef *hi2c;
+  uint8_t read;
+  uint8_t stop;
+  uint16_t address;
+  uint8_t *data;
+  uint16_t size;
+  uint8_t hung;                  /* started but will never complete */
+} pending;
+
+/* Bus counters, see sim_begin(). */
+static struct {
+  uint32_t transactions;
+  uint32_t starts;
+  uint32_t bytes;
+  uint32_t naks;
+  uint64_t bus_ns;
+} counters;
+
+/* Filled by ds1307_get_date_time(), not exported by the header. */
+extern ds1307_time_t ds1307;
+
+static uint64_t sim_ns;
+static uint8_t in_transaction;
+static int failures;
+/* Blocks handed out by the pool stand-in and not given back. */
+static uint32_t pool_blocks;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) \
+    { \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+/*-----------------------------------------------Chip model-------------------------------------------------------*/
+
+static uint8_t bcd_dec(uint8_t v)
+{
+  return (uint8_t)(((v >> 4) * 10u) + (v & 0x0Fu));
+}
+
+static uint8_t bcd_enc(uint8_t v)
+{
+  return (uint8_t)(((v / 10u) << 4) | (v % 10u));
+}
+
+/**
+ * @brief   Adds one to a BCD register.
+ * @param   reg:   Register index.
+ * @param   mask:  Bits holding the value, the others are kept.
+ * @param   first: Value after a wrap.
+ * @param   last:  Last valid value.
+ * @return  1 if the register wrapped.
+ */
+static uint8_t chip_increment(uint8_t reg, uint8_t mask, uint8_t first, uint8_t last)
+{
+  uint8_t v = bcd_dec(chip.regs[reg] & mask);
+  uint8_t wrapped = (v >= last) ? 1u : 0u;
+
+  v = (0u != wrapped) ? first : (uint8_t)(v + 1u);
+  chip.regs[reg] = (uint8_t)((chip.regs[reg] & (uint8_t)~mask) | bcd_enc(v));
+
+  return wrapped;
+}
+
+/**
+ * @brief   One second of the DS1307 calendar, 24 hour mode, leap years as
+ *          the chip counts them (every fourth).
+ * @param   void
+ * @return  void
+ */
+static void chip_tick(void)
+{
+  static const uint8_t month_days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  uint8_t month;
+  uint8_t last;
+
+  if (0u == chip_increment(DS1307_REG_SECOND, 0x7Fu, 0u, 59u) ||
+      0u == chip_increment(DS1307_REG_MINUTE, 0x7Fu, 0u, 59u) ||
+      0u == chip_increment(DS1307_REG_HOUR, 0x3Fu, 0u, 23u))
+  {
+    return;
+  }
+  (void)chip_increment(DS1307_REG_DOW, 0x07u, 1u, 7u);
+  month = bcd_dec(chip.regs[DS1307_REG_MONTH]);
+  last = ((1u <= month) && (12u >= month)) ? month_days[month - 1u] : 31u;
+  if ((2u == month) && (0u == (bcd_dec(chip.regs[DS1307_REG_YEAR]) % 4u)))
+  {
+    last = 29u;
+  }
+  if (0u == chip_increment(DS1307_REG_DATE, 0x3Fu, 1u, last) ||
+      0u == chip_increment(DS1307_REG_MONTH, 0x1Fu, 1u, 12u))
+  {
+    return;
+  }
+  (void)chip_increment(DS1307_REG_YEAR, 0xFFu, 0u, 99u);
+}
+
+/**
+ * @brief   Lets simulated time pass. The oscillator is stopped while CH is set.
+ * @param   ns: Nanoseconds.
+ * @return  void
+ */
+static void sim_advance(uint64_t ns)
+{
+  while (0u != ns)
+  {
+    uint64_t step = SIM_NS_PER_S - chip.phase_ns;
+
+    step = (step < ns) ? step : ns;
+    sim_ns += step;
+    ns -= step;
+    if (0u != (chip.regs[DS1307_REG_SECOND] & SIM_CH))
+    {
+      continue;
+    }
+    chip.phase_ns += step;
+    if (SIM_NS_PER_S == chip.phase_ns)
+    {
+      chip.phase_ns = 0u;
+      chip_tick();
+    }
+  }
+  sim_dwt_regs.CYCCNT = (uint32_t)((sim_ns / 1000u) * (SystemCoreClock / 1000000u));
+}
+
+/**
+ * @brief   One segment on the bus: (repeated) START, address, data and an
+ *          optional STOP, applied to the chip.
+ * @param   read:    Non-zero for a read.
+ * @param   address: HAL address, 7-bit address << 1.
+ * @param   *data:   Bytes to send or receive.
+ * @param   size:    Number of bytes.
+ * @param   stop:    Non-zero to end the transaction.
+ * @return  1 if the chip acknowledged its address.
+ */
+static uint8_t sim_segment(uint8_t read, uint16_t address, uint8_t *data, uint16_t size, uint8_t stop)
+{
+  uint8_t ack = ((DS1307_I2C_ADDR << 1) == (address & 0xFEu)) && (0u == chip.nak_next);
+  uint64_t bits = 1u + 9u;
+
+  if (0u == in_transaction)
+  {
+    counters.transactions++;
+  }
+  in_transaction = 1u;
+  counters.starts++;
+  counters.bytes++;
+  memcpy(chip.latch, chip.regs, sizeof(chip.latch));
+
+  if (0u != ack)
+  {
+    for (uint16_t i = 0u; i < size; i++)
+    {
+      if (0u != read)
+      {
+        data[i] = (chip.ptr < SIM_TIME_REGS) ? chip.latch[chip.ptr] : chip.regs[chip.ptr];
+      }
+      else if (0u == i)
+      {
+        /* The first byte written is the register pointer. */
+        chip.ptr = data[i] & (SIM_REGS - 1u);
+        continue;
+      }
+      else
+      {
+        chip.regs[chip.ptr] = data[i];
+        if (DS1307_REG_SECOND == chip.ptr)
+        {
+          /* Writing the seconds resets the countdown chain. */
+          chip.phase_ns = 0u;
+        }
+      }
+      chip.ptr = (uint8_t)((chip.ptr + 1u) & (SIM_REGS - 1u));
+    }
+    bits += 9u * size;
+    counters.bytes += size;
+  }
+  else
+  {
+    chip.nak_next = 0u;
+    counters.naks++;
+    stop = 1u;
+  }
+  if (0u != stop)
+  {
+    bits++;
+    in_transaction = 0u;
+  }
+  counters.bus_ns += bits * SIM_BIT_NS;
+  sim_advance(bits * SIM_BIT_NS);
+
+  return ack;
+}
+
+/*-----------------------------------------------HAL-------------------------------------------------------*/
+
+uint32_t HAL_GetTick(void)
+{
+  return (uint32_t)(sim_ns / 1000000u);
+}
+
+sim_dwt *sim_dwt_access(void)
+{
+  sim_advance(SIM_DWT_ACCESS_NS);
+  return &sim_dwt_regs;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+  (void)hi2c;
+  return HAL_OK;
+}
+
+/* Stops whatever the peripheral was doing, a hung transfer included. */
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c)
+{
+  (void)hi2c;
+  pending.active = 0u;
+  pending.hung = 0u;
+  in_transaction = 0u;
+  return HAL_OK;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+  (void)GPIOx;
+  (void)GPIO_Init;
+}
+
+/* Rising edges on SCL let the hung slave finish its byte and release SDA. */
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+  if ((&sim_gpio != GPIOx) || (SIM_SCL_PIN != GPIO_Pin))
+  {
+    return;
+  }
+  if ((GPIO_PIN_SET == PinState) && (0u == chip.scl_level) && (0u != chip.hold_sda))
+  {
+    if (++chip.scl_pulses >= 9u)
+    {
+      chip.hold_sda = 0u;
+      chip.scl_pulses = 0u;
+    }
+  }
+  chip.scl_level = (GPIO_PIN_SET == PinState) ? 1u : 0u;
+}
+
+static HAL_StatusTypeDef sim_start(I2C_HandleTypeDef *hi2c, uint8_t read, uint16_t address, uint8_t *data, uint16_t size, uint8_t stop)
+{
+  if (0u != chip.hold_sda)
+  {
+    sim_advance(SIM_HAL_BUSY_NS);
+    return HAL_BUSY;
+  }
+  if (0u != pending.active)
+  {
+    return HAL_BUSY;
+  }
+  pending.active = 1u;
+  pending.hung = 0u;
+  pending.hi2c = hi2c;
+  pending.read = read;
+  pending.stop = stop;
+  pending.address = address;
+  pending.data = data;
+  pending.size = size;
+
+  return HAL_OK;
+}
+
+void sim_wfi(void)
+{
+  static uint32_t idle;
+  I2C_HandleTypeDef *hi2c = pending.hi2c;
+
+  if ((0u == pending.active) || (0u != pending.hung))
+  {
+    /* Nothing will complete, sleep until the next SysTick. */
+    if (++idle > 10000u)
+    {
+      printf("FAIL: waiting for a transfer that never ends\n");
+      exit(EXIT_FAILURE);
+    }
+    sim_advance(1000000u - (sim_ns % 1000000u));
+    return;
+  }
+  idle = 0u;
+  if (0u != chip.hang_next)
+  {
+    /* START and address go out, then the slave holds SDA low. */
+    chip.hang_next = 0u;
+    chip.hold_sda = 1u;
+    pending.hung = 1u;
+    counters.transactions++;
+    counters.starts++;
+    counters.bus_ns += 10u * SIM_BIT_NS;
+    sim_advance(10u * SIM_BIT_NS);
+    return;
+  }
+  pending.active = 0u;
+  if (0u == sim_segment(pending.read, pending.address, pending.data, pending.size, pending.stop))
+  {
+    hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+    HAL_I2C_ErrorCallback(hi2c);
+  }
+  else if (0u != pending.read)
+  {
+    HAL_I2C_MasterRxCpltCallback(hi2c);
+  }
+  else
+  {
+    HAL_I2C_MasterTxCpltCallback(hi2c);
+  }
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+  (void)hi2c;
+  (void)Timeout;
+  if (0u != chip.hold_sda)
+  {
+    sim_advance(SIM_HAL_BUSY_NS);
+    return HAL_BUSY;
+  }
+  return (0u != sim_segment(0u, DevAddress, pData, Size, 1u)) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+  (void)hi2c;
+  (void)Timeout;
+  if (0u != chip.hold_sda)
+  {
+    sim_advance(SIM_HAL_BUSY_NS);
+    return HAL_BUSY;
+  }
+  return (0u != sim_segment(1u, DevAddress, pData, Size, 1u)) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size)
+{
+  return sim_start(hi2c, 0u, DevAddress, pData, Size, 1u);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size)
+{
+  return sim_start(hi2c, 1u, DevAddress, pData, Size, 1u);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size)
+{
+  return sim_start(hi2c, 0u, DevAddress, pData, Size, 1u);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size)
+{
+  return sim_start(hi2c, 1u, DevAddress, pData, Size, 1u);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t XferOptions)
+{
+  return sim_start(hi2c, 0u, DevAddress, pData, Size, (I2C_FIRST_FRAME != XferOptions) ? 1u : 0u);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t XferOptions)
+{
+  return sim_start(hi2c, 1u, DevAddress, pData, Size, (I2C_FIRST_FRAME != XferOptions) ? 1u : 0u);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t XferOptions)
+{
+  return sim_start(hi2c, 0u, DevAddress, pData, Size, (I2C_FIRST_FRAME != XferOptions) ? 1u : 0u);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Receive_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t XferOptions)
+{
+  return sim_start(hi2c, 1u, DevAddress, pData, Size, (I2C_FIRST_FRAME != XferOptions) ? 1u : 0u);
+}
+
+/*-----------------------------------------------Measurement-------------------------------------------------------*/
+
+/* Bus counters at the start of the measured call. */
+static uint32_t begin_transactions;
+static uint64_t begin_bus_ns;
+
+static void sim_begin(void)
+{
+  begin_transactions = counters.transactions;
+  begin_bus_ns = counters.bus_ns;
+}
+
+/**
+ * @brief   Prints the cost of the call since sim_begin() and fails if it
+ *          is over budget.
+ * @param   *name:            Call measured.
+ * @param   max_transactions: Budget in transactions.
+ * @param   max_bus_us:       Budget in bus time.
+ * @return  void
+ */
+static void sim_end(const char *name, uint32_t max_transactions, uint32_t max_bus_us)
+{
+  uint32_t transactions = counters.transactions - begin_transactions;
+  uint32_t bus_us = (uint32_t)((counters.bus_ns - begin_bus_ns) / 1000u);
+  uint8_t over = (transactions > max_transactions) || (bus_us > max_bus_us);
+
+  printf("%-32s %5lu %8lu %8lu %8lu %s\n", name, (unsigned long)transactions, (unsigned long)bus_us,
+         (unsigned long)max_transactions, (unsigned long)max_bus_us, (0u != over) ? "OVER" : "ok");
+  if (0u != over)
+  {
+    failures++;
+  }
+}
+
+/* Runs call and checks its bus cost. */
+#define SIM_CALL(name, max_transactions, max_bus_us, call) \
+  do { \
+    sim_begin(); \
+    call; \
+    sim_end(name, max_transactions, max_bus_us); \
+  } while (0)
+
+static void chip_set(const uint8_t raw[SIM_TIME_REGS - 1u])
+{
+  memcpy(chip.regs, raw, SIM_TIME_REGS - 1u);
+  chip.phase_ns = 0u;
+}
+
+static uint8_t time_equals(const ds1307_time_t *t, uint16_t year, uint8_t month, uint8_t date, uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+  return (t->year == year) && (t->month == month) && (t->date == date) &&
+         (t->hours == hours) && (t->minutes == minutes) && (t->seconds == seconds);
+}
+
+/*-----------------------------------------------Pools-------------------------------------------------------*/
+
+/* Host stand-in for pool.c, which keeps block addresses in 32 bits. */
+void *pool_alloc_size(size_t size)
+{
+  void *block = malloc(size);
+
+  if (NULL != block)
+  {
+    pool_blocks++;
+  }
+  return block;
+}
+
+pool_status pool_free(void *block)
+{
+  free(block);
+  pool_blocks--;
+  return POOL_OK;
+}
+
+/*-----------------------------------------------Tests-------------------------------------------------------*/
+
+int main(void)
+{
+  static I2C_HandleTypeDef hi2c;
+  static DMA_HandleTypeDef dma_tx;
+  static DMA_HandleTypeDef dma_rx;
+  static i2c_bus bus;
+  static i2c_request reqs[3];
+  static uint8_t reg = DS1307_REG_SECOND;
+  static uint8_t rx[3][SIM_TIME_REGS - 1u];
+  ds1307_result_t result = TM_DS1307_Result_Error;
+  ds1307_time_t t = {0};
+  uint8_t block[16];
+  uint8_t back[16];
+  uint16_t year = 0u;
+  uint8_t seconds;
+  uint64_t start_ns;
+  uint32_t blocked_ms;
+  int8_t tz_hour = 0;
+  uint8_t tz_min = 0u;
+
+  hi2c.Init.ClockSpeed = DS1307_I2C_CLOCK;
+  hi2c.hdmatx = &dma_tx;
+  hi2c.hdmarx = &dma_rx;
+  /* Power-up contents are undefined; start halted with a century already stored. */
+  chip.regs[DS1307_REG_SECOND] = SIM_CH;
+  chip.regs[DS1307_REG_CENT] = 0x20u;
+  CHECK(I2C_BUS_OK == i2c_bus_init(&bus, &hi2c));
+
+  printf("%-32s %5s %8s %8s %8s\n", "call", "xfers", "bus_us", "budget", "bus_max");
+
+  /* Init starts the oscillator. */
+  SIM_CALL("ds1307_init", 2u, 680u, ds1307_init(&bus));
+  CHECK(0u == (chip.regs[DS1307_REG_SECOND] & SIM_CH));
+
+  /* Burst write, century in its own transaction the first time only. */
+  t = (ds1307_time_t){58u, 59u, 23u, 1u, 31u, 12u, 2023u};
+  SIM_CALL("ds1307_write_time (century)", 2u, 1120u, result = ds1307_write_time(&t));
+  CHECK(TM_DS1307_Result_Ok == result);
+  CHECK((0x58u == chip.regs[0]) && (0x59u == chip.regs[1]) && (0x23u == chip.regs[2]) && (0x01u == chip.regs[3]));
+  CHECK((0x31u == chip.regs[4]) && (0x12u == chip.regs[5]) && (0x23u == chip.regs[6]) && (0x20u == chip.regs[DS1307_REG_CENT]));
+  SIM_CALL("ds1307_write_time", 1u, 830u, result = ds1307_write_time(&t));
+  CHECK(TM_DS1307_Result_Ok == result);
+
+  /* Year rollover while running. */
+  sim_advance(2500000000ull);
+  SIM_CALL("ds1307_read_time", 1u, 1830u, result = ds1307_read_time(&t));
+  CHECK(TM_DS1307_Result_Ok == result);
+  CHECK(time_equals(&t, 2024u, 1u, 1u, 0u, 0u, 0u) && (2u == t.dow));
+  CHECK(1704067200u == ds1307_time_to_epoch(&t));
+  SIM_CALL("ds1307_get_date_time", 1u, 1830u, ds1307_get_date_time());
+  CHECK(time_equals(&ds1307, 2024u, 1u, 1u, 0u, 0u, 0u));
+
+  /* The per-register getters, for comparison with the burst. */
+  SIM_CALL("ds1307_get_second..get_year", 8u, 3120u,
+           (void)ds1307_get_second(); (void)ds1307_get_minute(); (void)ds1307_get_hour(); (void)ds1307_get_dayofweek();
+           (void)ds1307_get_date(); (void)ds1307_get_month(); year = ds1307_get_year());
+  CHECK(2024u == year);
+
+  /* Leap day. */
+  t = (ds1307_time_t){59u, 59u, 23u, 4u, 28u, 2u, 2024u};
+  CHECK(TM_DS1307_Result_Ok == ds1307_write_time(&t));
+  sim_advance(SIM_NS_PER_S);
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && time_equals(&t, 2024u, 2u, 29u, 0u, 0u, 0u));
+  sim_advance(86400u * SIM_NS_PER_S);
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && time_equals(&t, 2024u, 3u, 1u, 0u, 0u, 0u) && (6u == t.dow));
+
+  /* A seconds write restarts the second. */
+  sim_advance(900000000ull);
+  t = (ds1307_time_t){10u, 0u, 12u, 6u, 1u, 3u, 2024u};
+  CHECK(TM_DS1307_Result_Ok == ds1307_write_time(&t));
+  sim_advance(500000000ull);
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && (10u == t.seconds));
+  sim_advance(600000000ull);
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && (11u == t.seconds));
+
+  /* The burst is latched on START: a read crossing midnight stays consistent. */
+  chip_set((const uint8_t[]){0x59u, 0x59u, 0x23u, 0x06u, 0x31u, 0x12u, 0x24u});
+  sim_advance(SIM_NS_PER_S - 200000u);
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && time_equals(&t, 2024u, 12u, 31u, 23u, 59u, 59u));
+  CHECK((0x00u == chip.regs[DS1307_REG_SECOND]) && (0x25u == chip.regs[DS1307_REG_YEAR]));
+
+  /* Clock halt stops the calendar, time writes keep it halted. */
+  SIM_CALL("ds1307_set_clock_halt", 2u, 680u, ds1307_set_clock_halt(1u));
+  CHECK(TM_DS1307_Result_Ok == ds1307_read_time(&t));
+  seconds = t.seconds;
+  sim_advance(5u * SIM_NS_PER_S);
+  CHECK(1u == ds1307_get_clock_halt());
+  CHECK(TM_DS1307_Result_Ok == ds1307_write_time(&t));
+  CHECK(0u != (chip.regs[DS1307_REG_SECOND] & SIM_CH));
+  sim_advance(5u * SIM_NS_PER_S);
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && (seconds == t.seconds));
+  ds1307_set_clock_halt(0u);
+  sim_advance(SIM_NS_PER_S);
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && ((seconds + 1u) == t.seconds));
+
+  /* Single field setters agree with the burst paths. */
+  SIM_CALL("ds1307_set_year", 2u, 580u, ds1307_set_year(2042u));
+  CHECK((0x20u == chip.regs[DS1307_REG_CENT]) && (0x42u == chip.regs[DS1307_REG_YEAR]));
+  CHECK(2042u == ds1307_get_year());
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && (2042u == t.year));
+  SIM_CALL("ds1307_set_date_time", 1u, 830u, ds1307_set_date_time(0u, 30u, 8u, 3u, 15u, 7u, 2042u));
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && time_equals(&t, 2042u, 7u, 15u, 8u, 30u, 0u));
+
+  /* NVRAM: blocks, bounds, pointer wrap. */
+  for (uint8_t i = 0u; i < sizeof(block); i++)
+  {
+    block[i] = (uint8_t)(0xA0u + i);
+  }
+  SIM_CALL("ds1307_write_nvram 16", 1u, 1640u, result = ds1307_write_nvram(20u, block, sizeof(block)));
+  CHECK((TM_DS1307_Result_Ok == result) && (0 == memcmp(&chip.regs[DS1307_REG_NVRAM + 20u], block, sizeof(block))));
+  SIM_CALL("ds1307_read_nvram 16", 1u, 1740u, result = ds1307_read_nvram(20u, back, sizeof(back)));
+  CHECK((TM_DS1307_Result_Ok == result) && (0 == memcmp(back, block, sizeof(block))));
+  SIM_CALL("ds1307_read_nvram out of range", 0u, 0u, result = ds1307_read_nvram(50u, back, 7u));
+  CHECK(TM_DS1307_Result_Error == result);
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_nvram(DS1307_NVRAM_SIZE - 1u, back, 1u)) && (0u == chip.ptr));
+  /* A century written through the NVRAM is known to the time write. */
+  back[0] = 0x20u;
+  CHECK(TM_DS1307_Result_Ok == ds1307_write_nvram(DS1307_REG_CENT - DS1307_REG_NVRAM, back, 1u));
+  t.year = 2031u;
+  SIM_CALL("ds1307_write_time (same century)", 1u, 830u, result = ds1307_write_time(&t));
+
+  /* Time zone in the first two NVRAM bytes. */
+  SIM_CALL("ds1307_set_time_zone", 2u, 580u, ds1307_set_time_zone(-5, 30u));
+  SIM_CALL("ds1307_get_time_zone", 1u, 480u, result = ds1307_get_time_zone(&tz_hour, &tz_min));
+  CHECK((TM_DS1307_Result_Ok == result) && (-5 == tz_hour) && (30u == tz_min));
+
+  /* Square wave output. */
+  /* Posted: the call returns at once, the block comes back on completion. */
+  SIM_CALL("ds1307_enable_output_pin", 1u, 290u,
+           ds1307_enable_output_pin(DS1307_SQW_1HZ); CHECK(1u == pool_blocks);
+           while (0u != bsp_i2c_busy(&bus.engine)) { __WFI(); });
+  CHECK((0x90u == chip.regs[DS1307_REG_CONTROL]) && (0u == pool_blocks));
+
+  /* A NAK fails the call and leaves the bus usable. */
+  chip.nak_next = 1u;
+  SIM_CALL("ds1307_read_time (NAK)", 1u, 110u, result = ds1307_read_time(&t));
+  CHECK((TM_DS1307_Result_Error == result) && (1u == counters.naks));
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && (2031u == t.year));
+
+  /* A slave hanging mid-transfer: failed at its deadline, then clocked free. */
+  bsp_i2c_set_recovery_pins(&bus.engine, &sim_gpio, SIM_SCL_PIN, &sim_gpio, SIM_SDA_PIN);
+  chip.hang_next = 1u;
+  start_ns = sim_ns;
+  SIM_CALL("ds1307_read_time (hung slave)", 1u, 100u, result = ds1307_read_time(&t));
+  blocked_ms = (uint32_t)((sim_ns - start_ns) / 1000000u);
+  printf("  blocked %lu ms, bound %lu ms\n", (unsigned long)blocked_ms,
+         (unsigned long)(bsp_i2c_timeout_ms(&hi2c, 1u + DS1307_BURST_LEN) + 1u));
+  CHECK((TM_DS1307_Result_Error == result) && (1u == bus.engine.recoveries) && (0u == chip.hold_sda));
+  CHECK(blocked_ms <= (bsp_i2c_timeout_ms(&hi2c, 1u + DS1307_BURST_LEN) + 1u));
+  CHECK((TM_DS1307_Result_Ok == ds1307_read_time(&t)) && (2031u == t.year));
+
+  /* A bus already held at the start: the HAL gives up, the poll recovers. */
+  chip.hold_sda = 1u;
+  start_ns = sim_ns;
+  result = ds1307_read_time(&t);
+  blocked_ms = (uint32_t)((sim_ns - start_ns) / 1000000u);
+  printf("  blocked %lu ms on a busy bus\n", (unsigned long)blocked_ms);
+  CHECK((TM_DS1307_Result_Error == result) && (2u == bus.engine.recoveries) && (0u == chip.hold_sda));
+  CHECK(blocked_ms <= 27u);
+  CHECK(TM_DS1307_Result_Ok == ds1307_read_time(&t));
+
+  /* Requests submitted together: one on the bus, one queued in the engine behind it, the rest pending. */
+  for (uint8_t i = 0u; i < 3u; i++)
+  {
+    i2c_request_setup(&reqs[i], bus.devices, &reg, 1u, rx[i], sizeof(rx[i]));
+    CHECK(I2C_BUS_OK == i2c_bus_submit(&reqs[i], I2C_BUS_PRIO_DEFAULT, I2C_BUS_NO_DEADLINE));
+  }
+  CHECK((&reqs[0] == bus.active) && (&reqs[1] == bus.queued) && (&reqs[2] == bus.pending));
+  for (uint8_t i = 0u; i < 3u; i++)
+  {
+    CHECK(I2C_BUS_OK == i2c_bus_wait(&reqs[i]));
+  }
+  CHECK((NULL == bus.active) && (NULL == bus.queued) && (NULL == bus.pending));
+
+  /* bcd_to_bin decodes a register value, bin_to_bcd encodes one. */
+  CHECK(59u == ds1307_bcd_to_bin(0x59u));
+  CHECK(0x59u == ds1307_bin_to_bcd(59u));
+
+  printf("\n");
+  i2c_bus_report(&bus);
+  printf("\n%lu transactions, %lu bytes, %llu us on the bus, %d failure(s)\n",
+         (unsigned long)counters.transactions, (unsigned long)counters.bytes,
+         (unsigned long long)(counters.bus_ns / 1000u), failures);
+
+  return failures;
+}
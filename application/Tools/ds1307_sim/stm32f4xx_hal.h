@@ -0,0 +1,152 @@
+/*
+ * stm32f4xx_hal.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ *
+ * Host stand-in for the HAL header, for ds1307_sim.c only. Declares the
+ * part of the HAL and CMSIS the I2C engine, the bus manager and the DS1307
+ * driver use; ds1307_sim.c implements it on a simulated bus. Found before
+ * the real header because the build puts this directory first.
+ */
+
+#ifndef SIM_STM32F4XX_HAL_H_
+#define SIM_STM32F4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Profiling zones and trace events are compiled out on the host. */
+#define PROF_ENABLE  0
+#define TRACE_ENABLE 0
+
+typedef enum {
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY  0xFFFFFFFFU
+
+typedef struct {
+  uint32_t unused;
+} DMA_HandleTypeDef;
+
+typedef struct {
+  uint32_t ClockSpeed;
+} I2C_InitTypeDef;
+
+typedef struct {
+  void *Instance;
+  I2C_InitTypeDef Init;
+  DMA_HandleTypeDef *hdmatx;
+  DMA_HandleTypeDef *hdmarx;
+  uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+#define I2C_FIRST_FRAME            0x00000000U
+#define I2C_FIRST_AND_LAST_FRAME   0x00000008U
+#define I2C_LAST_FRAME             0x00000020U
+
+#define HAL_I2C_ERROR_NONE         0x00000000U
+#define HAL_I2C_ERROR_AF           0x00000004U
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t XferOptions);
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t XferOptions);
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t XferOptions);
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Receive_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t XferOptions);
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_AbortCpltCallback(I2C_HandleTypeDef *hi2c);
+
+uint32_t HAL_GetTick(void);
+
+typedef struct {
+  uint32_t unused;
+} GPIO_TypeDef;
+
+typedef struct {
+  uint32_t Pin;
+  uint32_t Mode;
+  uint32_t Pull;
+  uint32_t Speed;
+  uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+typedef enum {
+  GPIO_PIN_RESET = 0,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+#define GPIO_MODE_OUTPUT_OD     0x00000011U
+#define GPIO_PULLUP             0x00000001U
+#define GPIO_SPEED_FREQ_LOW     0x00000000U
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+
+/* Core clock of the simulated target, the cycle counter follows simulated time. */
+extern uint32_t SystemCoreClock;
+
+typedef struct {
+  volatile uint32_t DEMCR;
+} sim_core_debug;
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} sim_dwt;
+
+extern sim_core_debug sim_core_debug_regs;
+
+/* Every access to the cycle counter lets a little simulated time pass, so busy-wait loops end. */
+sim_dwt *sim_dwt_access(void);
+
+#define CoreDebug                    (&sim_core_debug_regs)
+#define DWT                          (sim_dwt_access())
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+
+/* Runs the next pending bus event, the simulated interrupt. */
+void sim_wfi(void);
+
+/* Single threaded: interrupts only happen inside __WFI(). */
+static inline uint32_t __get_PRIMASK(void)
+{
+  return 0u;
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+  (void)primask;
+}
+
+static inline void __disable_irq(void)
+{
+}
+
+static inline void __enable_irq(void)
+{
+}
+
+static inline void __DMB(void)
+{
+}
+
+static inline void __WFI(void)
+{
+  sim_wfi();
+}
+
+#endif /* SIM_STM32F4XX_HAL_H_ */
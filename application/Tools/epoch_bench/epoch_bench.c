@@ -0,0 +1,162 @@
+/*
+ * epoch_bench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ *
+ * Host check and benchmark of Core/Src/epoch.c against the C library
+ * gmtime_r()/timegm(). Not part of the firmware build.
+ *
+ *   gcc -O2 -I../../Core/Inc epoch_bench.c ../../Core/Src/epoch.c -o epoch_bench
+ *   ./epoch_bench
+ *
+ * Every day of the epoch_t range is converted both ways and compared with
+ * the C library first; the timings only run if that passes.
+ */
+
+#define _DEFAULT_SOURCE
+#include "epoch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_ITERATIONS  10000000u
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+/* xorshift32, the same sequence for every contender */
+static uint32_t next_random(uint32_t *state)
+{
+  uint32_t x = *state;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static int check(void)
+{
+  int errors = 0;
+
+  for (uint32_t days = 0u; days <= (UINT32_MAX / EPOCH_SECS_PER_DAY); days++)
+  {
+    time_t t = (time_t)days * EPOCH_SECS_PER_DAY + ((days * 7919u) % EPOCH_SECS_PER_DAY);
+    struct tm ref;
+    epoch_civil civil;
+
+    if (t > (time_t)UINT32_MAX)
+    {
+      t = UINT32_MAX;
+    }
+    gmtime_r(&t, &ref);
+    epoch_to_civil((epoch_t)t, &civil);
+    if ((civil.year != ref.tm_year + 1900) || (civil.month != ref.tm_mon + 1) ||
+        (civil.date != ref.tm_mday) || (civil.hours != ref.tm_hour) ||
+        (civil.minutes != ref.tm_min) || (civil.seconds != ref.tm_sec) ||
+        (civil.weekday != ref.tm_wday) || (epoch_from_civil(&civil) != (epoch_t)t) ||
+        (epoch_is_leap(civil.year) != (((civil.year % 4 == 0) && (civil.year % 100 != 0)) || (civil.year % 400 == 0))))
+    {
+      if (errors++ < 10)
+      {
+        printf("mismatch on day %u\n", days);
+      }
+    }
+  }
+
+  if ((epoch_tz_offset(7, 0) != 25200) || (epoch_tz_offset(-3, 30) != -12600) ||
+      (epoch_tz_offset(5, 45) != 20700))
+  {
+    printf("time zone offset mismatch\n");
+    errors++;
+  }
+
+  return errors;
+}
+
+int main(void)
+{
+  volatile uint32_t sink = 0u;
+  uint32_t state;
+  double start;
+  double lib_to;
+  double lib_from;
+  double ours_to;
+  double ours_from;
+
+  if (0 != check())
+  {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("all %u days match the C library\n", UINT32_MAX / EPOCH_SECS_PER_DAY + 1u);
+
+  state = 2463534242u;
+  start = now_ns();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++)
+  {
+    time_t t = next_random(&state);
+    struct tm tm;
+
+    gmtime_r(&t, &tm);
+    sink += (uint32_t)tm.tm_mday;
+  }
+  lib_to = (now_ns() - start) / BENCH_ITERATIONS;
+
+  state = 2463534242u;
+  start = now_ns();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++)
+  {
+    epoch_civil civil;
+
+    epoch_to_civil(next_random(&state), &civil);
+    sink += civil.date;
+  }
+  ours_to = (now_ns() - start) / BENCH_ITERATIONS;
+
+  state = 2463534242u;
+  start = now_ns();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++)
+  {
+    struct tm tm = {0};
+    uint32_t r = next_random(&state);
+
+    tm.tm_year = 70 + (int)(r % 136u);
+    tm.tm_mon = (int)((r >> 8) % 12u);
+    tm.tm_mday = 1 + (int)((r >> 12) % 28u);
+    tm.tm_hour = (int)((r >> 17) % 24u);
+    tm.tm_min = (int)((r >> 22) % 60u);
+    sink += (uint32_t)timegm(&tm);
+  }
+  lib_from = (now_ns() - start) / BENCH_ITERATIONS;
+
+  state = 2463534242u;
+  start = now_ns();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++)
+  {
+    epoch_civil civil = {0};
+    uint32_t r = next_random(&state);
+
+    civil.year = (uint16_t)(1970u + (r % 136u));
+    civil.month = (uint8_t)(1u + ((r >> 8) % 12u));
+    civil.date = (uint8_t)(1u + ((r >> 12) % 28u));
+    civil.hours = (uint8_t)((r >> 17) % 24u);
+    civil.minutes = (uint8_t)((r >> 22) % 60u);
+    sink += epoch_from_civil(&civil);
+  }
+  ours_from = (now_ns() - start) / BENCH_ITERATIONS;
+
+  printf("direction        libc ns    epoch ns   speedup\n");
+  printf("to fields     %10.1f %10.1f %8.1fx\n", lib_to, ours_to, lib_to / ours_to);
+  printf("from fields   %10.1f %10.1f %8.1fx\n", lib_from, ours_from, lib_from / ours_from);
+  (void)sink;
+
+  return 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * lfqueue_stress.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ *
+ * Host stress test of the lock-free queues in Core/Inc/lfqueue.h, run with
+ * real threads on the __atomic host path. Not part of the firmware build.
+ *
+ *   g++ -std=c++17 -O2 -Wall -pthread -I../../Core/Inc lfqueue_stress.cpp -o lfqueue_stress
+ *   ./lfqueue_stress [items per producer] [mpsc producers]
+ *
+ * Every element carries its producer and a per-producer sequence number.
+ * The consumer expects each producer's numbers in order with no gap, so a
+ * lost, duplicated or reordered element is caught where it happens. The
+ * queues are kept small so that they run full and empty all the time, and
+ * both sides yield when blocked, so it also runs on a single core.
+ *
+ * Exit status: number of failed runs, 2 on bad arguments.
+ */
+
+#include "lfqueue.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/* Small, so that the full and empty paths are hit constantly. */
+constexpr uint32_t QUEUE_SIZE = 16u;
+constexpr uint32_t SEQ_BITS = 24u;
+constexpr uint32_t SEQ_MASK = (1u << SEQ_BITS) - 1u;
+
+uint32_t element(uint32_t producer, uint32_t seq)
+{
+  return (producer << SEQ_BITS) | seq;
+}
+
+/* Checks the elements of every producer arrive once and in order. */
+class Checker
+{
+public:
+  Checker(uint32_t producers, uint32_t items) : next_(producers, 0u), items_(items) {}
+
+  void take(uint32_t value)
+  {
+    uint32_t producer = value >> SEQ_BITS;
+    uint32_t seq = value & SEQ_MASK;
+
+    if (producer >= next_.size())
+    {
+      errors_++;
+      return;
+    }
+    if (seq < next_[producer])
+    {
+      duplicated_++;
+    }
+    else
+    {
+      lost_ += seq - next_[producer];
+      next_[producer] = seq + 1u;
+    }
+  }
+
+  bool done() const
+  {
+    for (uint32_t next : next_)
+    {
+      if (next != items_)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* Prints the outcome, true if nothing went wrong. */
+  bool report(const char *name, double seconds) const
+  {
+    unsigned long long total = static_cast<unsigned long long>(items_) * next_.size();
+
+    std::printf("%-6s %2zu producer(s) %10llu elements %8.3f s: %llu lost, %llu duplicated, %llu corrupt\n", name,
+                next_.size(), total, seconds, lost_, duplicated_, errors_);
+    return (0u == lost_) && (0u == duplicated_) && (0u == errors_) && done();
+  }
+
+private:
+  std::vector<uint32_t> next_;
+  uint32_t items_;
+  unsigned long long lost_ = 0u;
+  unsigned long long duplicated_ = 0u;
+  unsigned long long errors_ = 0u;
+};
+
+double now_s()
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* One producer thread, one consumer thread. */
+bool stress_spsc(uint32_t items)
+{
+  static lfq::Spsc<uint32_t, QUEUE_SIZE> queue;
+  Checker checker(1u, items);
+  double start = now_s();
+
+  std::thread producer([items]() {
+    for (uint32_t seq = 0u; seq < items; seq++)
+    {
+      while (!queue.push(element(0u, seq)))
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (uint32_t taken = 0u; taken < items;)
+  {
+    uint32_t value;
+
+    if (queue.pop(value))
+    {
+      checker.take(value);
+      taken++;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  uint32_t extra;
+  bool ok = checker.report("spsc", now_s() - start);
+  if (queue.pop(extra))
+  {
+    std::printf("spsc: element left in the queue\n");
+    ok = false;
+  }
+  return ok;
+}
+
+/* Several producer threads racing on the claim, one consumer thread. */
+bool stress_mpsc(uint32_t items, uint32_t producers)
+{
+  static lfq::Mpsc<uint32_t, QUEUE_SIZE> queue;
+  Checker checker(producers, items);
+  std::vector<std::thread> threads;
+  double start = now_s();
+
+  for (uint32_t p = 0u; p < producers; p++)
+  {
+    threads.emplace_back([p, items]() {
+      for (uint32_t seq = 0u; seq < items; seq++)
+      {
+        while (!queue.push(element(p, seq)))
+        {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  unsigned long long total = static_cast<unsigned long long>(items) * producers;
+  for (unsigned long long taken = 0u; taken < total;)
+  {
+    uint32_t value;
+
+    if (queue.pop(value))
+    {
+      checker.take(value);
+      taken++;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  for (std::thread &t : threads)
+  {
+    t.join();
+  }
+
+  uint32_t extra;
+  bool ok = checker.report("mpsc", now_s() - start);
+  if (queue.pop(extra))
+  {
+    std::printf("mpsc: element left in the queue\n");
+    ok = false;
+  }
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  unsigned long items = 1000000u;
+  unsigned long producers = 4u;
+
+  if ((argc > 3) || ((argc > 1) && (0u == (items = std::strtoul(argv[1], nullptr, 0)))) ||
+      ((argc > 2) && (0u == (producers = std::strtoul(argv[2], nullptr, 0)))) || (items > SEQ_MASK) ||
+      (producers > 255u))
+  {
+    std::fprintf(stderr, "usage: %s [items per producer, up to %u] [mpsc producers, up to 255]\n", argv[0],
+                 SEQ_MASK);
+    return 2;
+  }
+
+  int failures = 0;
+  failures += stress_spsc(static_cast<uint32_t>(items)) ? 0 : 1;
+  failures += stress_mpsc(static_cast<uint32_t>(items), static_cast<uint32_t>(producers)) ? 0 : 1;
+  failures += stress_mpsc(static_cast<uint32_t>(items / 4u) + 1u, 2u * static_cast<uint32_t>(producers)) ? 0 : 1;
+  std::printf("%d failure(s)\n", failures);
+  return failures;
+}
@@ -0,0 +1,532 @@
+/*
+ * map_budget.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ *
+ * Host tool: attributes the flash and RAM of a build to modules from the
+ * GNU ld map file, compares two builds and enforces the budgets of a
+ * config file. Not part of the firmware build.
+ *
+ *   g++ -std=c++17 -O2 -Wall map_budget.cpp -o map_budget
+ *   ./map_budget -c budget.cfg ../../Debug/application_thao.map
+ *   ./map_budget -c budget.cfg -t 10 new.map old.map
+ *
+ * Every input section of the memory map is charged to the module of its
+ * object file: the first "module" rule of the config whose pattern occurs
+ * in the path, otherwise the object itself (Core/Src/main) or, for
+ * archive members, the archive (libc_nano.a). Sections loaded from flash
+ * and run from RAM (.data, .ramfunc) count for both. Padding goes to
+ * "(padding)", output sections without input sections such as the heap
+ * and stack reservation to "[section]".
+ *
+ * Exit status: 0 within budget, 1 a budget or growth limit is exceeded,
+ * 2 bad arguments or unreadable files.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/* Bytes of one module, or of one input section. */
+struct Usage
+{
+  uint64_t flash = 0u;
+  uint64_t ram = 0u;
+};
+
+struct Region
+{
+  std::string name;
+  uint64_t origin;
+  uint64_t length;
+};
+
+/* Absolute cap or growth limit of a module, -1 for none. */
+struct Limit
+{
+  int64_t flash = -1;
+  int64_t ram = -1;
+};
+
+struct Config
+{
+  std::vector<std::pair<std::string, std::vector<std::string>>> modules;
+  std::vector<std::string> noload = {".bss", ".noinit", "._user_heap_stack"};
+  std::map<std::string, Limit> budget;
+  std::map<std::string, Limit> growth;
+};
+
+struct Build
+{
+  std::vector<Region> regions;
+  std::map<std::string, Usage> modules;
+  std::map<std::string, Usage> sections; /* "module: input section" */
+  Usage total;
+};
+
+std::string normalize(std::string path)
+{
+  std::replace(path.begin(), path.end(), '\\', '/');
+  if (0 == path.compare(0, 2, "./"))
+  {
+    path.erase(0, 2);
+  }
+  return path;
+}
+
+/* Module of an object file, see the header. */
+std::string module_of(const Config &cfg, const std::string &path)
+{
+  for (const auto &rule : cfg.modules)
+  {
+    for (const auto &pattern : rule.second)
+    {
+      if (std::string::npos != path.find(pattern))
+      {
+        return rule.first;
+      }
+    }
+  }
+
+  std::string name = path;
+  size_t member = name.find(".a(");
+  if (std::string::npos != member)
+  {
+    name.erase(member + 2u);
+  }
+  else if ((name.size() > 2u) && (0 == name.compare(name.size() - 2u, 2u, ".o")))
+  {
+    name.erase(name.size() - 2u);
+  }
+  /* Toolchain files live deep in the install, keep the file name only. */
+  size_t slash = name.rfind('/');
+  if ((std::string::npos != slash) && (std::string::npos != path.find("arm-none-eabi")))
+  {
+    name.erase(0, slash + 1u);
+  }
+  return name;
+}
+
+int64_t parse_limit(const std::string &text)
+{
+  return ("-" == text) ? -1 : static_cast<int64_t>(std::stoll(text, nullptr, 0));
+}
+
+bool read_config(const std::string &file, Config &cfg)
+{
+  std::ifstream in(file);
+  std::string line;
+
+  if (!in)
+  {
+    std::fprintf(stderr, "cannot read %s\n", file.c_str());
+    return false;
+  }
+  while (std::getline(in, line))
+  {
+    line = line.substr(0, line.find('#'));
+    std::istringstream words(line);
+    std::string keyword;
+    std::string name;
+
+    if (!(words >> keyword))
+    {
+      continue;
+    }
+    if ("module" == keyword)
+    {
+      std::vector<std::string> patterns;
+      std::string pattern;
+
+      words >> name;
+      while (words >> pattern)
+      {
+        patterns.push_back(pattern);
+      }
+      cfg.modules.emplace_back(name, patterns);
+    }
+    else if ("noload" == keyword)
+    {
+      while (words >> name)
+      {
+        cfg.noload.push_back(name);
+      }
+    }
+    else if (("budget" == keyword) || ("growth" == keyword))
+    {
+      std::string flash;
+      std::string ram;
+
+      if (!(words >> name >> flash >> ram))
+      {
+        std::fprintf(stderr, "%s: %s needs a module, flash and RAM\n", file.c_str(), keyword.c_str());
+        return false;
+      }
+      Limit &limit = ("budget" == keyword) ? cfg.budget[name] : cfg.growth[name];
+      limit.flash = parse_limit(flash);
+      limit.ram = parse_limit(ram);
+    }
+    else
+    {
+      std::fprintf(stderr, "%s: unknown keyword %s\n", file.c_str(), keyword.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+const Region *region_of(const Build &build, uint64_t address)
+{
+  for (const auto &region : build.regions)
+  {
+    if ((address >= region.origin) && ((address - region.origin) < region.length))
+    {
+      return &region;
+    }
+  }
+  return nullptr;
+}
+
+bool is_flash(const Region *region)
+{
+  return (nullptr != region) && ("RAM" != region->name) && (std::string::npos == region->name.find("RAM"));
+}
+
+bool is_hex(const std::string &word)
+{
+  return (word.size() > 2u) && (0 == word.compare(0, 2, "0x"));
+}
+
+/* State of the output section being read. */
+struct Output
+{
+  std::string name;
+  bool in_flash = false;
+  bool in_ram = false;
+  bool has_input = false;
+  uint64_t fill = 0u;
+};
+
+void charge(Build &build, const Output &out, const std::string &module, const std::string &section, uint64_t size)
+{
+  Usage &m = build.modules[module];
+  Usage &s = build.sections[module + ": " + section];
+
+  if (out.in_flash)
+  {
+    m.flash += size;
+    s.flash += size;
+    build.total.flash += size;
+  }
+  if (out.in_ram)
+  {
+    m.ram += size;
+    s.ram += size;
+    build.total.ram += size;
+  }
+}
+
+void close_output(Build &build, Output &out)
+{
+  if (0u != out.fill)
+  {
+    charge(build, out, out.has_input ? "(padding)" : ("[" + out.name + "]"), out.name, out.fill);
+  }
+  out = Output();
+}
+
+bool read_map(const std::string &file, const Config &cfg, Build &build)
+{
+  std::ifstream in(file);
+  std::vector<std::string> lines;
+  std::string line;
+  size_t i = 0u;
+
+  if (!in)
+  {
+    std::fprintf(stderr, "cannot read %s\n", file.c_str());
+    return false;
+  }
+  while (std::getline(in, line))
+  {
+    if (!line.empty() && ('\r' == line.back()))
+    {
+      line.pop_back();
+    }
+    lines.push_back(line);
+  }
+
+  /* Memory Configuration: Name Origin Length Attributes */
+  while ((i < lines.size()) && ("Memory Configuration" != lines[i]))
+  {
+    i++;
+  }
+  for (i += 3u; (i < lines.size()) && !lines[i].empty(); i++)
+  {
+    std::istringstream words(lines[i]);
+    std::string name;
+    std::string origin;
+    std::string length;
+
+    if ((words >> name >> origin >> length) && ("*default*" != name))
+    {
+      build.regions.push_back({name, std::stoull(origin, nullptr, 16), std::stoull(length, nullptr, 16)});
+    }
+  }
+  while ((i < lines.size()) && ("Linker script and memory map" != lines[i]))
+  {
+    i++;
+  }
+  if (build.regions.empty() || (i >= lines.size()))
+  {
+    std::fprintf(stderr, "%s: not a GNU ld map file\n", file.c_str());
+    return false;
+  }
+
+  Output out;
+  for (; i < lines.size(); i++)
+  {
+    const std::string &text = lines[i];
+    std::istringstream words(text);
+    std::string name;
+    std::string address;
+    std::string size;
+
+    if (text.empty() || ((' ' != text[0]) && ('.' != text[0])))
+    {
+      continue;
+    }
+    if (!(words >> name))
+    {
+      continue;
+    }
+    /* A long name puts address and size on the next line. */
+    if (!(words >> address) && ((i + 1u) < lines.size()))
+    {
+      std::istringstream next(lines[i + 1u]);
+      std::string word;
+
+      if (!(next >> word) || !is_hex(word))
+      {
+        continue;
+      }
+      words.clear();
+      words.str(lines[++i]);
+      words >> address;
+    }
+    if (!is_hex(address) || !(words >> size) || !is_hex(size))
+    {
+      continue;
+    }
+
+    if ('.' == text[0])
+    {
+      std::string rest;
+      std::getline(words, rest);
+      const Region *vma = region_of(build, std::stoull(address, nullptr, 16));
+      bool noload = std::find(cfg.noload.begin(), cfg.noload.end(), name) != cfg.noload.end();
+
+      close_output(build, out);
+      out.name = name;
+      out.in_ram = (nullptr != vma) && !is_flash(vma);
+      out.in_flash = is_flash(vma) || (!noload && out.in_ram && (std::string::npos != rest.find("load address")));
+      continue;
+    }
+
+    uint64_t bytes = std::stoull(size, nullptr, 16);
+    if ((0u == bytes) || (!out.in_flash && !out.in_ram))
+    {
+      continue;
+    }
+    if ("*fill*" == name)
+    {
+      out.fill += bytes;
+      continue;
+    }
+
+    std::string object;
+    std::getline(words >> std::ws, object);
+    if (object.empty())
+    {
+      continue;
+    }
+    out.has_input = true;
+    charge(build, out, module_of(cfg, normalize(object)), name, bytes);
+  }
+  close_output(build, out);
+  return true;
+}
+
+/* Checks one figure, prints and counts a violation. */
+void check(const char *what, const std::string &module, const char *memory, int64_t value, int64_t limit, int &violations)
+{
+  if ((limit >= 0) && (value > limit))
+  {
+    std::printf("FAIL %s %s %s: %lld bytes, limit %lld\n", module.c_str(), memory, what,
+                static_cast<long long>(value), static_cast<long long>(limit));
+    violations++;
+  }
+}
+
+void usage(const char *self)
+{
+  std::fprintf(stderr, "usage: %s [-c budget.cfg] [-t top] new.map [baseline.map]\n", self);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Config cfg;
+  Build build;
+  Build base;
+  bool diff = false;
+  size_t top = 0u;
+  int violations = 0;
+  int arg = 1;
+
+  for (; (arg < argc) && ('-' == argv[arg][0]) && ((arg + 1) < argc); arg += 2)
+  {
+    std::string option = argv[arg];
+    if ("-c" == option)
+    {
+      if (!read_config(argv[arg + 1], cfg))
+      {
+        return 2;
+      }
+    }
+    else if ("-t" == option)
+    {
+      top = static_cast<size_t>(std::stoul(argv[arg + 1]));
+    }
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if ((arg >= argc) || ((argc - arg) > 2))
+  {
+    usage(argv[0]);
+    return 2;
+  }
+  if (!read_map(argv[arg], cfg, build))
+  {
+    return 2;
+  }
+  if ((arg + 1) < argc)
+  {
+    if (!read_map(argv[arg + 1], cfg, base))
+    {
+      return 2;
+    }
+    diff = true;
+  }
+
+  /* Every module of either build, largest flash first. */
+  std::vector<std::string> names;
+  for (const auto &m : build.modules)
+  {
+    names.push_back(m.first);
+  }
+  for (const auto &m : base.modules)
+  {
+    if (0u == build.modules.count(m.first))
+    {
+      names.push_back(m.first);
+    }
+  }
+  std::sort(names.begin(), names.end(), [&](const std::string &a, const std::string &b)
+  {
+    return build.modules[a].flash > build.modules[b].flash;
+  });
+
+  std::printf("%-52s %9s %9s", "module", "flash", "ram");
+  if (diff)
+  {
+    std::printf(" %9s %9s", "d.flash", "d.ram");
+  }
+  std::printf("\n");
+  for (const auto &name : names)
+  {
+    const Usage now = build.modules[name];
+    const Usage was = base.modules[name];
+
+    std::printf("%-52s %9llu %9llu", name.c_str(), static_cast<unsigned long long>(now.flash),
+                static_cast<unsigned long long>(now.ram));
+    if (diff)
+    {
+      std::printf(" %+9lld %+9lld", static_cast<long long>(now.flash - was.flash),
+                  static_cast<long long>(now.ram - was.ram));
+    }
+    std::printf("\n");
+  }
+  std::printf("%-52s %9llu %9llu", "total", static_cast<unsigned long long>(build.total.flash),
+              static_cast<unsigned long long>(build.total.ram));
+  if (diff)
+  {
+    std::printf(" %+9lld %+9lld", static_cast<long long>(build.total.flash - base.total.flash),
+                static_cast<long long>(build.total.ram - base.total.ram));
+  }
+  std::printf("\n");
+
+  /* Largest input sections, or the largest changes between the builds. */
+  if (0u != top)
+  {
+    std::vector<std::pair<int64_t, std::string>> rows;
+    for (const auto &s : build.sections)
+    {
+      const Usage was = base.sections.count(s.first) ? base.sections.at(s.first) : Usage();
+      rows.emplace_back(static_cast<int64_t>(s.second.flash + s.second.ram) -
+                        static_cast<int64_t>(was.flash + was.ram), s.first);
+    }
+    for (const auto &s : base.sections)
+    {
+      if (0u == build.sections.count(s.first))
+      {
+        rows.emplace_back(-static_cast<int64_t>(s.second.flash + s.second.ram), s.first);
+      }
+    }
+    std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b)
+    {
+      return std::llabs(a.first) > std::llabs(b.first);
+    });
+    std::printf("\n%s\n", diff ? "largest changes, flash + ram" : "largest input sections, flash + ram");
+    for (size_t r = 0u; (r < top) && (r < rows.size()); r++)
+    {
+      std::printf("%+9lld  %s\n", static_cast<long long>(rows[r].first), rows[r].second.c_str());
+    }
+  }
+
+  /* Budgets, "total" is the whole image. */
+  std::printf("\n");
+  for (const auto &b : cfg.budget)
+  {
+    const Usage now = ("total" == b.first) ? build.total : build.modules[b.first];
+    check("budget", b.first, "flash", static_cast<int64_t>(now.flash), b.second.flash, violations);
+    check("budget", b.first, "ram", static_cast<int64_t>(now.ram), b.second.ram, violations);
+  }
+  if (diff)
+  {
+    for (const auto &g : cfg.growth)
+    {
+      const Usage now = ("total" == g.first) ? build.total : build.modules[g.first];
+      const Usage was = ("total" == g.first) ? base.total : base.modules[g.first];
+      check("growth", g.first, "flash", static_cast<int64_t>(now.flash - was.flash), g.second.flash, violations);
+      check("growth", g.first, "ram", static_cast<int64_t>(now.ram - was.ram), g.second.ram, violations);
+    }
+  }
+  std::printf("%s: %d limit(s) exceeded\n", (0 == violations) ? "PASS" : "FAIL", violations);
+
+  return (0 == violations) ? 0 : 1;
+}
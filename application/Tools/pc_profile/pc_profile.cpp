@@ -0,0 +1,331 @@
+/*
+ * pc_profile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ *
+ * Host tool: symbolizes the PC samples the firmware prints after an 's'
+ * on the console (pcsamp.c) against the ELF of the same build and prints
+ * a flat profile, or folded stacks for flamegraph.pl. Not part of the
+ * firmware build.
+ *
+ *   g++ -std=c++17 -O2 -Wall pc_profile.cpp -o pc_profile
+ *   ./pc_profile ../../Debug/application_thao.elf console.log
+ *   ./pc_profile -t 20 -a application_thao.elf console.log
+ *   ./pc_profile -f application_thao.elf console.log | flamegraph.pl > pc.svg
+ *
+ * The log may hold other console output and several captures, lines that
+ * are not samples are skipped. -a adds the hottest addresses of each
+ * listed function as function+offset, enough to tell a polling loop from
+ * the rest of the function.
+ *
+ * Folded stacks are two frames deep: the caller is the function holding
+ * the sampled LR. That LR is the real caller in a leaf function or before
+ * the function makes its first call, later it may be stale; a sample
+ * whose LR lies in its own function or is an EXC_RETURN value is shown
+ * without a caller.
+ *
+ * Exit status: 0 done, 2 bad arguments or unreadable files.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Symbol
+{
+  uint32_t address;
+  uint32_t size;
+  std::string name;
+};
+
+/* Samples charged to one function. */
+struct Entry
+{
+  uint64_t samples = 0u;
+  std::map<uint32_t, uint64_t> offsets;
+};
+
+uint32_t read32(const std::vector<uint8_t> &elf, size_t at)
+{
+  return static_cast<uint32_t>(elf[at]) | (static_cast<uint32_t>(elf[at + 1u]) << 8) |
+         (static_cast<uint32_t>(elf[at + 2u]) << 16) | (static_cast<uint32_t>(elf[at + 3u]) << 24);
+}
+
+uint16_t read16(const std::vector<uint8_t> &elf, size_t at)
+{
+  return static_cast<uint16_t>(elf[at] | (elf[at + 1u] << 8));
+}
+
+/* Functions of the .symtab of a 32-bit little-endian ELF, sorted by address. */
+bool read_elf(const std::string &file, std::vector<Symbol> &symbols)
+{
+  std::ifstream in(file, std::ios::binary);
+
+  if (!in)
+  {
+    std::fprintf(stderr, "cannot read %s\n", file.c_str());
+    return false;
+  }
+  std::vector<uint8_t> elf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if ((elf.size() < 52u) || (0 != std::memcmp(elf.data(), "\x7f" "ELF", 4u)) || (1u != elf[4]) || (1u != elf[5]))
+  {
+    std::fprintf(stderr, "%s: not a 32-bit little-endian ELF\n", file.c_str());
+    return false;
+  }
+
+  uint32_t shoff = read32(elf, 32u);
+  uint16_t shentsize = read16(elf, 46u);
+  uint16_t shnum = read16(elf, 48u);
+  if ((shoff + static_cast<uint64_t>(shentsize) * shnum) > elf.size())
+  {
+    std::fprintf(stderr, "%s: truncated section table\n", file.c_str());
+    return false;
+  }
+
+  for (uint16_t i = 0u; i < shnum; i++)
+  {
+    size_t sh = shoff + static_cast<size_t>(i) * shentsize;
+    if (2u != read32(elf, sh + 4u)) /* SHT_SYMTAB */
+    {
+      continue;
+    }
+    uint32_t offset = read32(elf, sh + 16u);
+    uint32_t size = read32(elf, sh + 20u);
+    uint32_t link = read32(elf, sh + 24u);
+    uint32_t entsize = read32(elf, sh + 36u);
+    if ((link >= shnum) || (0u == entsize) || ((static_cast<uint64_t>(offset) + size) > elf.size()))
+    {
+      break;
+    }
+    size_t strsh = shoff + static_cast<size_t>(link) * shentsize;
+    uint32_t stroff = read32(elf, strsh + 16u);
+    uint32_t strsize = read32(elf, strsh + 20u);
+    if ((static_cast<uint64_t>(stroff) + strsize) > elf.size())
+    {
+      break;
+    }
+
+    for (uint32_t at = offset; (at + entsize) <= (offset + size); at += entsize)
+    {
+      uint32_t name = read32(elf, at);
+      uint8_t info = elf[at + 12u];
+      if ((2u != (info & 0xFu)) || (name >= strsize)) /* STT_FUNC */
+      {
+        continue;
+      }
+      const char *text = reinterpret_cast<const char *>(&elf[stroff + name]);
+      symbols.push_back({read32(elf, at + 4u) & ~1u, read32(elf, at + 8u),
+                         std::string(text, strnlen(text, strsize - name))});
+    }
+  }
+  if (symbols.empty())
+  {
+    std::fprintf(stderr, "%s: no function symbols, stripped?\n", file.c_str());
+    return false;
+  }
+
+  std::sort(symbols.begin(), symbols.end(),
+            [](const Symbol &a, const Symbol &b) { return a.address < b.address; });
+  /* Hand written assembly often has no size, let it run to the next symbol. */
+  for (size_t i = 0u; (i + 1u) < symbols.size(); i++)
+  {
+    if (0u == symbols[i].size)
+    {
+      symbols[i].size = symbols[i + 1u].address - symbols[i].address;
+    }
+  }
+  return true;
+}
+
+/* Function holding an address, nullptr outside of every one. */
+const Symbol *lookup(const std::vector<Symbol> &symbols, uint32_t address)
+{
+  auto next = std::upper_bound(symbols.begin(), symbols.end(), address,
+                               [](uint32_t a, const Symbol &s) { return a < s.address; });
+  if (symbols.begin() == next)
+  {
+    return nullptr;
+  }
+  const Symbol &s = *std::prev(next);
+  return ((address - s.address) < std::max<uint32_t>(s.size, 2u)) ? &s : nullptr;
+}
+
+std::string name_of(const Symbol *s, uint32_t address)
+{
+  char text[16];
+
+  if (nullptr != s)
+  {
+    return s->name;
+  }
+  std::snprintf(text, sizeof(text), "0x%08x", static_cast<unsigned>(address));
+  return text;
+}
+
+void usage(const char *self)
+{
+  std::fprintf(stderr, "usage: %s [-f] [-a] [-t top] application.elf capture.log\n", self);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::vector<Symbol> symbols;
+  std::map<std::string, Entry> flat;
+  std::map<std::string, uint64_t> folded;
+  bool fold = false;
+  bool addresses = false;
+  size_t top = 0u;
+  uint64_t total = 0u;
+  uint64_t captures = 0u;
+  uint32_t rate = 0u;
+  int arg = 1;
+
+  for (; (arg < argc) && ('-' == argv[arg][0]); arg++)
+  {
+    std::string option = argv[arg];
+    if ("-f" == option)
+    {
+      fold = true;
+    }
+    else if ("-a" == option)
+    {
+      addresses = true;
+    }
+    else if (("-t" == option) && ((arg + 1) < argc))
+    {
+      top = static_cast<size_t>(std::stoul(argv[++arg]));
+    }
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (2 != (argc - arg))
+  {
+    usage(argv[0]);
+    return 2;
+  }
+  if (!read_elf(argv[arg], symbols))
+  {
+    return 2;
+  }
+
+  std::ifstream log(argv[arg + 1]);
+  std::string line;
+  if (!log)
+  {
+    std::fprintf(stderr, "cannot read %s\n", argv[arg + 1]);
+    return 2;
+  }
+  while (std::getline(log, line))
+  {
+    unsigned pc = 0u;
+    unsigned lr = 0u;
+    unsigned long value = 0u;
+
+    if (1 == std::sscanf(line.c_str(), " pcsamp begin %lu", &value))
+    {
+      rate = static_cast<uint32_t>(value);
+      captures++;
+      continue;
+    }
+    if (2 != std::sscanf(line.c_str(), " $%x %x", &pc, &lr))
+    {
+      continue;
+    }
+
+    const Symbol *callee = lookup(symbols, pc & ~1u);
+    std::string name = name_of(callee, pc & ~1u);
+    Entry &entry = flat[name];
+    entry.samples++;
+    if (nullptr != callee)
+    {
+      entry.offsets[(pc & ~1u) - callee->address]++;
+    }
+    total++;
+
+    if (fold)
+    {
+      /* LR is the return address, the call itself sits just before it. */
+      const Symbol *caller = (0xF0000000u <= lr) ? nullptr : lookup(symbols, (lr & ~1u) - 2u);
+      if ((nullptr != caller) && (caller != callee))
+      {
+        folded[caller->name + ";" + name]++;
+      }
+      else
+      {
+        folded[name]++;
+      }
+    }
+  }
+  if (0u == total)
+  {
+    std::fprintf(stderr, "%s: no samples\n", argv[arg + 1]);
+    return 0;
+  }
+
+  if (fold)
+  {
+    for (const auto &f : folded)
+    {
+      std::printf("%s %llu\n", f.first.c_str(), static_cast<unsigned long long>(f.second));
+    }
+    return 0;
+  }
+
+  std::vector<std::pair<std::string, const Entry *>> rows;
+  for (const auto &f : flat)
+  {
+    rows.emplace_back(f.first, &f.second);
+  }
+  std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) {
+    return (a.second->samples != b.second->samples) ? (a.second->samples > b.second->samples) : (a.first < b.first);
+  });
+  if ((0u != top) && (rows.size() > top))
+  {
+    rows.resize(top);
+  }
+
+  std::printf("%llu samples in %llu captures", static_cast<unsigned long long>(total),
+              static_cast<unsigned long long>(captures));
+  if (0u != rate)
+  {
+    std::printf(" at %lu Hz", static_cast<unsigned long>(rate));
+  }
+  std::printf("\n\n  samples      %%    cum%%  function\n");
+
+  uint64_t cumulative = 0u;
+  for (const auto &row : rows)
+  {
+    const Entry &entry = *row.second;
+    cumulative += entry.samples;
+    std::printf("%9llu %6.2f %7.2f  %s\n", static_cast<unsigned long long>(entry.samples),
+                100.0 * entry.samples / total, 100.0 * cumulative / total, row.first.c_str());
+    if (!addresses)
+    {
+      continue;
+    }
+
+    std::vector<std::pair<uint32_t, uint64_t>> hot(entry.offsets.begin(), entry.offsets.end());
+    std::sort(hot.begin(), hot.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+    for (size_t i = 0u; (i < hot.size()) && (i < 4u); i++)
+    {
+      std::printf("%9llu %6.2f          +0x%x\n", static_cast<unsigned long long>(hot[i].second),
+                  100.0 * hot[i].second / total, static_cast<unsigned>(hot[i].first));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,498 @@
+/*
+ * stack_check.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ *
+ * Host tool: worst-case stack depth of every entry point, from the frame
+ * sizes gcc writes with -fstack-usage (.su files) and the call graph taken
+ * from the disassembly listing the build already makes (.list). Not part
+ * of the firmware build.
+ *
+ *   gcc -O2 -Wall stack_check.c -o stack_check
+ *   ./stack_check -m 412 ../../Debug/application_thao.list $(find ../../Debug -name '*.su')
+ *
+ * Options:
+ *   -e name   entry point, may repeat; default main and every *_Handler
+ *   -r bytes  stack reservation, default 1024 (_Min_Stack_Size)
+ *   -m bytes  measured high water, from the "stack" line of stackmon_report()
+ *   -n depth  interrupt nesting levels to add on top of main, default 1
+ *   -x file   extra facts, one per line:
+ *               frame <function> <bytes>     for code without a .su entry
+ *               call <caller> <callee>       for calls through pointers
+ *
+ * Flags in the result: D a frame is dynamic or only bounded, R recursion
+ * (cut at the repeat), I an indirect call nobody resolved with -x,
+ * U a function without frame size (library or assembly, counted as 0).
+ * Any flag means the number is a lower bound.
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_LEN       96u
+/* Cortex-M4F exception entry with a lazily stacked FPU context. */
+#define EXC_FRAME      104u
+
+#define FLAG_DYNAMIC   0x01u
+#define FLAG_RECURSION 0x02u
+#define FLAG_INDIRECT  0x04u
+#define FLAG_UNKNOWN   0x08u
+
+typedef struct {
+  uint32_t callee;
+  uint8_t tail; /* branch, not call: the caller's frame is gone */
+} edge;
+
+typedef struct {
+  char name[NAME_LEN];
+  uint32_t frame;
+  uint8_t has_frame;
+  uint8_t flags;     /* own flags */
+  edge *calls;
+  uint32_t ncalls;
+  uint32_t cap;
+  /* analysis */
+  uint8_t state;     /* 0 new, 1 on the path, 2 done */
+  uint32_t worst;
+  uint8_t worst_flags;
+  int32_t next;      /* callee on the worst path, -1 at a leaf */
+} func;
+
+static func *funcs;
+static uint32_t nfuncs;
+static uint32_t cap_funcs;
+
+static uint32_t hash_size;
+static int32_t *hash;
+
+static uint32_t name_hash(const char *s)
+{
+  uint32_t h = 2166136261u;
+
+  while ('\0' != *s)
+  {
+    h = (h ^ (uint8_t)*s++) * 16777619u;
+  }
+  return h;
+}
+
+static void rehash(void)
+{
+  free(hash);
+  hash_size = (0u == hash_size) ? 1024u : hash_size * 2u;
+  hash = malloc(hash_size * sizeof(*hash));
+  for (uint32_t i = 0u; i < hash_size; i++)
+  {
+    hash[i] = -1;
+  }
+  for (uint32_t f = 0u; f < nfuncs; f++)
+  {
+    uint32_t i = name_hash(funcs[f].name) & (hash_size - 1u);
+
+    while (-1 != hash[i])
+    {
+      i = (i + 1u) & (hash_size - 1u);
+    }
+    hash[i] = (int32_t)f;
+  }
+}
+
+/* Index of a function, created on first use. */
+static uint32_t lookup(const char *name)
+{
+  uint32_t i;
+
+  if ((nfuncs * 2u) >= hash_size)
+  {
+    rehash();
+  }
+  i = name_hash(name) & (hash_size - 1u);
+  while (-1 != hash[i])
+  {
+    if (0 == strcmp(funcs[hash[i]].name, name))
+    {
+      return (uint32_t)hash[i];
+    }
+    i = (i + 1u) & (hash_size - 1u);
+  }
+
+  if (nfuncs == cap_funcs)
+  {
+    cap_funcs = (0u == cap_funcs) ? 256u : cap_funcs * 2u;
+    funcs = realloc(funcs, cap_funcs * sizeof(*funcs));
+  }
+  memset(&funcs[nfuncs], 0, sizeof(func));
+  snprintf(funcs[nfuncs].name, NAME_LEN, "%s", name);
+  funcs[nfuncs].next = -1;
+  hash[i] = (int32_t)nfuncs;
+  return nfuncs++;
+}
+
+static void add_call(uint32_t caller, uint32_t callee, uint8_t tail)
+{
+  func *f = &funcs[caller];
+
+  for (uint32_t i = 0u; i < f->ncalls; i++)
+  {
+    if (f->calls[i].callee == callee)
+    {
+      f->calls[i].tail &= tail;
+      return;
+    }
+  }
+  if (f->ncalls == f->cap)
+  {
+    f->cap = (0u == f->cap) ? 4u : f->cap * 2u;
+    f->calls = realloc(f->calls, f->cap * sizeof(edge));
+  }
+  f->calls[f->ncalls].callee = callee;
+  f->calls[f->ncalls].tail = tail;
+  f->ncalls++;
+}
+
+static void set_frame(uint32_t f, uint32_t bytes, uint8_t flags)
+{
+  /* Static functions of the same name in several files: keep the largest. */
+  if ((0u == funcs[f].has_frame) || (bytes > funcs[f].frame))
+  {
+    funcs[f].frame = bytes;
+  }
+  funcs[f].has_frame = 1u;
+  funcs[f].flags |= flags;
+}
+
+/* ../Core/Src/main.c:114:6:SystemClock_Config	88	static */
+static void read_su(const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  char line[512];
+
+  if (NULL == fp)
+  {
+    perror(path);
+    exit(2);
+  }
+  while (NULL != fgets(line, sizeof(line), fp))
+  {
+    char *tab = strchr(line, '\t');
+    char *name;
+    char *qual;
+    unsigned long bytes;
+
+    if (NULL == tab)
+    {
+      continue;
+    }
+    *tab = '\0';
+    name = strrchr(line, ':');
+    name = (NULL == name) ? line : name + 1;
+    bytes = strtoul(tab + 1, &qual, 10);
+    set_frame(lookup(name), (uint32_t)bytes, (NULL != strstr(qual, "dynamic")) ? FLAG_DYNAMIC : 0u);
+  }
+  fclose(fp);
+}
+
+/* 0804057c <main>:  then lines like   8040580:	f000 fa7a 	bl	8040a78 <HAL_Init> */
+static void read_list(const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  char line[1024];
+  int32_t current = -1;
+
+  if (NULL == fp)
+  {
+    perror(path);
+    exit(2);
+  }
+  while (NULL != fgets(line, sizeof(line), fp))
+  {
+    char mnemonic[16];
+    char target[NAME_LEN];
+    char *field;
+    char *lt;
+    char *gt;
+    uint8_t tail;
+
+    if ((line[0] != ' ') && (NULL != (lt = strstr(line, " <"))) && (NULL != strstr(lt, ">:")))
+    {
+      gt = strstr(lt, ">:");
+      *gt = '\0';
+      current = (int32_t)lookup(lt + 2);
+      continue;
+    }
+    if ((-1 == current) || (line[0] != ' '))
+    {
+      continue;
+    }
+
+    /* address:	encoding	mnemonic	operands */
+    field = strchr(line, '\t');
+    if ((NULL == field) || (NULL == (field = strchr(field + 1, '\t'))))
+    {
+      continue;
+    }
+    if (1 != sscanf(field + 1, "%15s", mnemonic))
+    {
+      continue;
+    }
+
+    if ((0 == strcmp(mnemonic, "blx")) || (0 == strcmp(mnemonic, "bx")))
+    {
+      /* blx rN is a call through a pointer; bx lr is a return, bx rN a jump through one. */
+      if ((0 == strcmp(mnemonic, "blx")) || (NULL == strstr(field, "lr")))
+      {
+        funcs[current].flags |= FLAG_INDIRECT;
+      }
+      continue;
+    }
+    if ('b' != mnemonic[0])
+    {
+      continue;
+    }
+    /* bl is a call, anything else (b, b.w, beq, bls...) leaving the function a tail call. */
+    tail = (0 == strcmp(mnemonic, "bl")) ? 0u : 1u;
+
+    lt = strchr(field, '<');
+    gt = (NULL == lt) ? NULL : strchr(lt, '>');
+    if ((NULL == gt) || ((size_t)(gt - lt - 1) >= NAME_LEN))
+    {
+      continue;
+    }
+    memcpy(target, lt + 1, (size_t)(gt - lt - 1));
+    target[gt - lt - 1] = '\0';
+    /* <func+0x1c> is a branch inside a function, not to its entry. */
+    if (NULL != strchr(target, '+'))
+    {
+      continue;
+    }
+    if (0 == strcmp(target, funcs[current].name))
+    {
+      if (0u == tail)
+      {
+        funcs[current].flags |= FLAG_RECURSION;
+      }
+      continue;
+    }
+    add_call((uint32_t)current, lookup(target), tail);
+  }
+  fclose(fp);
+}
+
+static void read_extra(const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  char line[512];
+
+  if (NULL == fp)
+  {
+    perror(path);
+    exit(2);
+  }
+  while (NULL != fgets(line, sizeof(line), fp))
+  {
+    char a[NAME_LEN];
+    char b[NAME_LEN];
+    unsigned long bytes;
+
+    if (2 == sscanf(line, "frame %95s %lu", a, &bytes))
+    {
+      set_frame(lookup(a), (uint32_t)bytes, 0u);
+    }
+    else if (2 == sscanf(line, "call %95s %95s", a, b))
+    {
+      uint32_t caller = lookup(a);
+
+      add_call(caller, lookup(b), 0u);
+      /* A resolved pointer call clears the warning of that caller. */
+      funcs[caller].flags &= (uint8_t)~FLAG_INDIRECT;
+    }
+  }
+  fclose(fp);
+}
+
+/* Deepest stack below and including f, memoized. */
+static void analyse(uint32_t f)
+{
+  func *fn = &funcs[f];
+
+  if (2u == fn->state)
+  {
+    return;
+  }
+  fn->state = 1u;
+  fn->worst = fn->frame;
+  fn->worst_flags = fn->flags | ((0u == fn->has_frame) ? FLAG_UNKNOWN : 0u);
+  fn->next = -1;
+
+  for (uint32_t i = 0u; i < fn->ncalls; i++)
+  {
+    uint32_t c = fn->calls[i].callee;
+    uint32_t depth;
+
+    if (1u == funcs[c].state)
+    {
+      fn->worst_flags |= FLAG_RECURSION;
+      continue;
+    }
+    analyse(c);
+    fn->worst_flags |= funcs[c].worst_flags;
+    depth = funcs[c].worst + ((0u != fn->calls[i].tail) ? 0u : fn->frame);
+    if (depth > fn->worst)
+    {
+      fn->worst = depth;
+      fn->next = (int32_t)c;
+    }
+  }
+  fn->state = 2u;
+}
+
+static void flags_str(uint8_t flags, char *out)
+{
+  out[0] = (0u != (flags & FLAG_DYNAMIC)) ? 'D' : '-';
+  out[1] = (0u != (flags & FLAG_RECURSION)) ? 'R' : '-';
+  out[2] = (0u != (flags & FLAG_INDIRECT)) ? 'I' : '-';
+  out[3] = (0u != (flags & FLAG_UNKNOWN)) ? 'U' : '-';
+  out[4] = '\0';
+}
+
+static void print_entry(uint32_t f)
+{
+  char flags[5];
+
+  flags_str(funcs[f].worst_flags, flags);
+  printf("%-32s %6u  %s  ", funcs[f].name, funcs[f].worst, flags);
+  for (int32_t c = (int32_t)f; -1 != c; c = funcs[c].next)
+  {
+    printf("%s%s", (c == (int32_t)f) ? "" : " > ", funcs[c].name);
+  }
+  printf("\n");
+}
+
+static int is_handler(const char *name)
+{
+  size_t len = strlen(name);
+
+  /* Reset_Handler runs main, Error_Handler is an ordinary function despite its name. */
+  return (len > 8u) && (0 == strcmp(name + len - 8u, "_Handler")) &&
+         (0 != strcmp(name, "Reset_Handler")) && (0 != strcmp(name, "Error_Handler"));
+}
+
+static int by_worst(const void *a, const void *b)
+{
+  uint32_t wa = funcs[*(const uint32_t *)a].worst;
+  uint32_t wb = funcs[*(const uint32_t *)b].worst;
+
+  return (wa < wb) ? 1 : ((wa > wb) ? -1 : 0);
+}
+
+int main(int argc, char **argv)
+{
+  const char *entries[64];
+  uint32_t nentries = 0u;
+  uint32_t reserve = 1024u;
+  uint32_t measured = 0u;
+  uint32_t nesting = 1u;
+  const char *extra = NULL;
+  const char *list = NULL;
+  uint32_t *handlers;
+  uint32_t nhandlers = 0u;
+  uint32_t main_worst = 0u;
+  uint32_t estimate;
+  uint8_t all_flags = 0u;
+  int arg;
+
+  for (arg = 1; (arg < argc) && ('-' == argv[arg][0]); arg++)
+  {
+    if ((arg + 1) >= argc)
+    {
+      break;
+    }
+    switch (argv[arg][1])
+    {
+      case 'e': if (nentries < 64u) { entries[nentries++] = argv[++arg]; } break;
+      case 'r': reserve = (uint32_t)strtoul(argv[++arg], NULL, 0); break;
+      case 'm': measured = (uint32_t)strtoul(argv[++arg], NULL, 0); break;
+      case 'n': nesting = (uint32_t)strtoul(argv[++arg], NULL, 0); break;
+      case 'x': extra = argv[++arg]; break;
+      default: arg = argc; break;
+    }
+  }
+  if ((arg + 2) > argc)
+  {
+    fprintf(stderr, "usage: %s [-e entry]... [-r reserve] [-m measured] [-n nesting] [-x extra] file.list file.su...\n", argv[0]);
+    return 2;
+  }
+
+  list = argv[arg++];
+  for (; arg < argc; arg++)
+  {
+    read_su(argv[arg]);
+  }
+  read_list(list);
+  if (NULL != extra)
+  {
+    read_extra(extra);
+  }
+
+  printf("entry                             worst  flag  worst path\n");
+  if (0u == nentries)
+  {
+    entries[nentries++] = "main";
+  }
+  for (uint32_t i = 0u; i < nentries; i++)
+  {
+    uint32_t f = lookup(entries[i]);
+
+    analyse(f);
+    print_entry(f);
+    all_flags |= funcs[f].worst_flags;
+    if (0 == strcmp(entries[i], "main"))
+    {
+      main_worst = funcs[f].worst;
+    }
+  }
+
+  /* Handlers, deepest first, then stacked on top of main per nesting level. */
+  handlers = malloc((nfuncs + 1u) * sizeof(uint32_t));
+  for (uint32_t f = 0u; f < nfuncs; f++)
+  {
+    if (is_handler(funcs[f].name) && ((0u != funcs[f].has_frame) || (0u != funcs[f].ncalls)))
+    {
+      analyse(f);
+      handlers[nhandlers++] = f;
+    }
+  }
+  qsort(handlers, nhandlers, sizeof(uint32_t), by_worst);
+  for (uint32_t i = 0u; i < nhandlers; i++)
+  {
+    print_entry(handlers[i]);
+  }
+
+  estimate = main_worst;
+  for (uint32_t i = 0u; (i < nesting) && (i < nhandlers); i++)
+  {
+    estimate += funcs[handlers[i]].worst + EXC_FRAME;
+    all_flags |= funcs[handlers[i]].worst_flags;
+  }
+
+  printf("\nworst case  main %u + %u nested handler(s) with %u byte frames = %u bytes%s\n",
+         main_worst, (nesting < nhandlers) ? nesting : nhandlers, EXC_FRAME, estimate,
+         (0u != all_flags) ? " (lower bound, see flags)" : "");
+  printf("reservation %u bytes, margin %d\n", reserve, (int)reserve - (int)estimate);
+  if (0u != measured)
+  {
+    printf("measured    %u bytes, %u%% of the worst case\n", measured,
+           (0u != estimate) ? (measured * 100u) / estimate : 0u);
+    if (measured > estimate)
+    {
+      printf("measured use is deeper than the analysis: add the missing frames and calls with -x\n");
+      return 1;
+    }
+  }
+
+  return (estimate > reserve) ? 1 : 0;
+}
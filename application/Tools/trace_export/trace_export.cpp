@@ -0,0 +1,329 @@
+/*
+ * trace_export.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Admin
+ *
+ * Host tool: converts the event trace the firmware prints after a 'd' on
+ * the console (trace.c) into Chrome trace JSON, which chrome://tracing
+ * and ui.perfetto.dev open directly. Not part of the firmware build.
+ *
+ *   g++ -std=c++17 -O2 -Wall trace_export.cpp -o trace_export
+ *   ./trace_export console.log > trace.json
+ *
+ * The log may hold other console output, only the last complete dump is
+ * converted. Every event kind gets its own track: interrupts, scheduler
+ * tasks, I2C transactions, console writes and markers. Cycle stamps are
+ * unwrapped in record order and converted at the core clock of the dump
+ * header, time 0 is the oldest record. The ring overwrites its oldest
+ * records, so an end without its begin is dropped.
+ *
+ * Exit status: 0 done, 1 no complete dump in the log, 2 bad arguments or
+ * unreadable files.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/* Record types, as in trace.h. */
+enum : uint8_t
+{
+  ISR_ENTER = 0x01u,
+  ISR_EXIT = 0x02u,
+  TASK_BEGIN = 0x03u,
+  TASK_END = 0x04u,
+  USER_MARK = 0x05u,
+  I2C_BEGIN = 0x06u,
+  I2C_END = 0x07u,
+  UART_BEGIN = 0x08u,
+  UART_END = 0x09u
+};
+
+/* Tracks of the timeline. */
+enum Track
+{
+  TRACK_ISR = 1,
+  TRACK_TASK,
+  TRACK_I2C,
+  TRACK_UART,
+  TRACK_MARK
+};
+
+struct Record
+{
+  uint32_t cycles;
+  uint16_t arg;
+  uint8_t type;
+  uint8_t aux;
+};
+
+struct Dump
+{
+  uint64_t core_hz = 0u;
+  std::map<unsigned, std::string> tasks;
+  std::vector<Record> records;
+};
+
+/* Exception numbers of the handlers that trace, STM32F411. */
+std::string exception_name(unsigned number)
+{
+  static const std::map<unsigned, const char *> names = {
+    {2u, "NMI"},           {3u, "HardFault"},     {4u, "MemManage"},     {5u, "BusFault"},
+    {6u, "UsageFault"},    {11u, "SVCall"},       {14u, "PendSV"},       {15u, "SysTick"},
+    {22u, "EXTI0"},        {27u, "DMA1_Stream0"}, {33u, "DMA1_Stream6"}, {47u, "I2C1_EV"},
+    {48u, "I2C1_ER"},      {53u, "USART1"},       {66u, "TIM5"},
+  };
+  auto it = names.find(number);
+
+  if (names.end() != it)
+  {
+    return it->second;
+  }
+  return (16u <= number) ? ("IRQ " + std::to_string(number - 16u)) : ("exception " + std::to_string(number));
+}
+
+uint32_t hex(const std::string &text, size_t at, size_t digits)
+{
+  return static_cast<uint32_t>(std::stoul(text.substr(at, digits), nullptr, 16));
+}
+
+/* Last complete dump of the log. */
+bool read_log(const std::string &file, Dump &dump, bool &complete)
+{
+  std::ifstream in(file);
+  std::string line;
+  Dump current;
+  bool inside = false;
+
+  complete = false;
+  if (!in)
+  {
+    std::fprintf(stderr, "cannot read %s\n", file.c_str());
+    return false;
+  }
+  while (std::getline(in, line))
+  {
+    unsigned long long hz = 0u;
+    unsigned long count = 0u;
+    unsigned id = 0u;
+    char name[64];
+
+    if (!line.empty() && ('\r' == line.back()))
+    {
+      line.pop_back();
+    }
+    if (2 == std::sscanf(line.c_str(), "trace begin %llu %lu", &hz, &count))
+    {
+      current = Dump();
+      current.core_hz = hz;
+      current.records.reserve(count);
+      inside = true;
+    }
+    else if (!inside)
+    {
+      continue;
+    }
+    else if (2 == std::sscanf(line.c_str(), "trace task %u %63s", &id, name))
+    {
+      current.tasks[id] = name;
+    }
+    else if (0 == line.compare(0, 9, "trace end"))
+    {
+      dump = current;
+      complete = true;
+      inside = false;
+    }
+    else if ((!line.empty()) && ('#' == line[0]))
+    {
+      for (size_t at = 1u; (at + 16u) <= line.size(); at += 16u)
+      {
+        current.records.push_back({hex(line, at, 8u), static_cast<uint16_t>(hex(line, at + 8u, 4u)),
+                                   static_cast<uint8_t>(hex(line, at + 12u, 2u)),
+                                   static_cast<uint8_t>(hex(line, at + 14u, 2u))});
+      }
+    }
+  }
+  return true;
+}
+
+std::string quote(const std::string &text)
+{
+  std::string out = "\"";
+
+  for (char c : text)
+  {
+    if (('"' == c) || ('\\' == c))
+    {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+/* Writes the Chrome trace events of one dump. */
+class Writer
+{
+public:
+  explicit Writer(double us_per_cycle) : us_per_cycle_(us_per_cycle) {}
+
+  void meta(int track, const char *name)
+  {
+    open();
+    std::printf("{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}", track,
+                name);
+    std::printf(",\n");
+    std::printf("{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":%d}}",
+                track, track);
+  }
+
+  /* Begin of a slice, kept to match its end. */
+  void begin(int track, uint64_t t, const std::string &name, const std::string &args)
+  {
+    depth_[track]++;
+    event("B", track, t, name, args);
+  }
+
+  /* End of a slice, dropped when the begin fell out of the ring. */
+  void end(int track, uint64_t t, const std::string &args)
+  {
+    if (0 == depth_[track])
+    {
+      return;
+    }
+    depth_[track]--;
+    event("E", track, t, "", args);
+  }
+
+  void instant(int track, uint64_t t, const std::string &name)
+  {
+    event("i", track, t, name, "\"s\":\"t\"");
+  }
+
+  void finish()
+  {
+    std::printf("\n]}\n");
+  }
+
+private:
+  void open()
+  {
+    std::printf(first_ ? "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n" : ",\n");
+    first_ = false;
+  }
+
+  void event(const char *ph, int track, uint64_t t, const std::string &name, const std::string &extra)
+  {
+    open();
+    std::printf("{\"ph\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", ph, track, t * us_per_cycle_);
+    if (!name.empty())
+    {
+      std::printf(",\"name\":%s", quote(name).c_str());
+    }
+    if (!extra.empty())
+    {
+      std::printf(",%s", extra.c_str());
+    }
+    std::printf("}");
+  }
+
+  double us_per_cycle_;
+  bool first_ = true;
+  std::map<int, int> depth_;
+};
+
+void usage(const char *self)
+{
+  std::fprintf(stderr, "usage: %s console.log > trace.json\n", self);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Dump dump;
+  bool complete = false;
+
+  if (2 != argc)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+  if (!read_log(argv[1], dump, complete))
+  {
+    return 2;
+  }
+  if ((!complete) || (0u == dump.core_hz) || dump.records.empty())
+  {
+    std::fprintf(stderr, "%s: no complete trace dump\n", argv[1]);
+    return 1;
+  }
+
+  Writer out(1e6 / static_cast<double>(dump.core_hz));
+  out.meta(TRACK_ISR, "interrupts");
+  out.meta(TRACK_TASK, "tasks");
+  out.meta(TRACK_I2C, "i2c");
+  out.meta(TRACK_UART, "console");
+  out.meta(TRACK_MARK, "markers");
+
+  uint64_t t = 0u;
+  uint32_t last = dump.records.front().cycles;
+  for (const Record &r : dump.records)
+  {
+    t += static_cast<uint32_t>(r.cycles - last);
+    last = r.cycles;
+
+    switch (r.type)
+    {
+      case ISR_ENTER:
+        out.begin(TRACK_ISR, t, exception_name(r.arg), "");
+        break;
+      case ISR_EXIT:
+        out.end(TRACK_ISR, t, "");
+        break;
+      case TASK_BEGIN:
+      {
+        auto name = dump.tasks.find(r.arg);
+        out.begin(TRACK_TASK, t, (dump.tasks.end() != name) ? name->second : ("task " + std::to_string(r.arg)),
+                  "\"args\":{\"sig\":" + std::to_string(r.aux) + "}");
+        break;
+      }
+      case TASK_END:
+        out.end(TRACK_TASK, t, "");
+        break;
+      case USER_MARK:
+        out.instant(TRACK_MARK, t, "mark " + std::to_string(r.arg));
+        break;
+      case I2C_BEGIN:
+      {
+        char name[16];
+        std::snprintf(name, sizeof(name), "i2c 0x%02x", r.arg);
+        out.begin(TRACK_I2C, t, name, "");
+        break;
+      }
+      case I2C_END:
+        out.end(TRACK_I2C, t, "\"args\":{\"error\":" + std::to_string(r.aux) + "}");
+        break;
+      case UART_BEGIN:
+        out.begin(TRACK_UART, t, "write", "\"args\":{\"bytes\":" + std::to_string(r.arg) + "}");
+        break;
+      case UART_END:
+        out.end(TRACK_UART, t, "");
+        break;
+      default:
+        std::fprintf(stderr, "unknown record type 0x%02x\n", r.type);
+        break;
+    }
+  }
+  out.finish();
+
+  std::fprintf(stderr, "%zu records, %.3f ms\n", dump.records.size(), t * 1e3 / static_cast<double>(dump.core_hz));
+  return 0;
+}